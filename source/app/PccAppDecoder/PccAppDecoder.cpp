@@ -167,6 +167,10 @@ bool parseParameters( int                   argc,
     ( "computeChecksum", 
       metricsParams.computeChecksum_,
       metricsParams.computeChecksum_, "Compute checksum")
+    ( "fastChecksum", 
+      metricsParams.fastChecksum_,
+      metricsParams.fastChecksum_,
+      "Use a non-cryptographic digest in place of MD5 for the checksums, only comparable with the same mode")
     ( "computeMetrics", 
       metricsParams.computeMetrics_,
       metricsParams.computeMetrics_, "Compute metrics")
@@ -250,82 +254,67 @@ bool parseParameters( int                   argc,
 int decompressVideo( const PCCDecoderParameters& decoderParams,
                      const PCCMetricsParameters& metricsParams,
                      StopwatchUserTime&          clock ) {
-  PCCBitstream     bitstream;
-  PCCBitstreamStat bitstreamStat;
-  PCCLogger        logger;
+  PCCLogger logger;
   logger.initilalize( removeFileExtension( decoderParams.compressedStreamPath_ ), false );
-#ifdef BITSTREAM_TRACE
-  bitstream.setLogger( logger );
-  bitstream.setTrace( true );
-  size_t index = 0;
-#endif
-  if ( !bitstream.initialize( decoderParams.compressedStreamPath_ ) ) { return -1; }
-  // if ( !bitstream.readHeader() ) { return -1; }
-  bitstreamStat.setHeader( bitstream.size() );
+  std::ifstream stream( decoderParams.compressedStreamPath_, std::ios::binary );
+  if ( !stream.is_open() ) {
+    std::cerr << "Error: can't open compressed bitstream file: " << decoderParams.compressedStreamPath_ << '\n';
+    return -1;
+  }
   size_t      frameNumber = decoderParams.startFrameNumber_;
   PCCMetrics  metrics;
   PCCChecksum checksum;
   metrics.setParameters( metricsParams );
   checksum.setParameters( metricsParams );
-  std::vector<std::vector<uint8_t>> checksumsRec;
-  std::vector<std::vector<uint8_t>> checksumsDec;
   if ( metricsParams.computeChecksum_ ) { checksum.read( decoderParams.compressedStreamPath_ ); }
-  PCCDecoder decoder;
+  PCCStreamDecoder decoder;
   decoder.setLogger( logger );
   decoder.setParameters( decoderParams );
 
-  SampleStreamV3CUnit ssvu;
-  size_t              headerSize = pcc::PCCBitstreamReader::read( bitstream, ssvu );
-  bitstreamStat.incrHeader( headerSize );
-  bool bMoreData = true;
-  while ( bMoreData ) {
-    PCCGroupOfFrames reconstructs;
-    PCCContext       context;
-    context.setBitstreamStat( bitstreamStat );
+  // the bitstream is read by chunks and the frames are reconstructed, checked and written one by one.
+  const size_t         chunkSize = 1 << 20;
+  std::vector<uint8_t> chunk( chunkSize );
+  PCCGroupOfFrames     reconstructs;
+  reconstructs.setFrameCount( 1 );
+  bool endOfStream = false;
+  while ( true ) {
     clock.start();
-    PCCBitstreamReader bitstreamReader;
-#ifdef BITSTREAM_TRACE
-    bitstreamReader.setLogger( logger );
-#endif
-    if ( bitstreamReader.decode( ssvu, context ) == 0 ) { return 0; }
-
-    // allocate atlas structure
-    context.resizeAtlas( context.getVps().getAtlasCountMinus1() + 1 );
-    for ( uint32_t atlId = 0; atlId < context.getVps().getAtlasCountMinus1() + 1; atlId++ ) {
-      context.getAtlas( atlId ).allocateVideoFrames( context, 0 );
-      // first allocating the structures, frames will be added as the V3C
-      // units are being decoded ???
-      context.setAtlasIndex( atlId );
-      int retDecoding = decoder.decode( context, reconstructs, atlId );
-      clock.stop();
-      if ( retDecoding != 0 ) { return retDecoding; }
-      if ( metricsParams.computeChecksum_ ) { checksum.computeDecoded( reconstructs ); }
-      if ( metricsParams.computeMetrics_ ) {
-        PCCGroupOfFrames sources;
-        PCCGroupOfFrames normals;
-        if ( !sources.load( metricsParams.uncompressedDataPath_, frameNumber,
-                            frameNumber + reconstructs.getFrameCount(), decoderParams.colorTransform_ ) ) {
+    int ret = decoder.pull( reconstructs[0] );
+    clock.stop();
+    if ( ret < 0 ) { return ret; }
+    if ( ret == 0 ) {
+      if ( endOfStream ) { break; }
+      stream.read( reinterpret_cast<char*>( chunk.data() ), chunkSize );
+      decoder.push( chunk.data(), static_cast<size_t>( stream.gcount() ) );
+      if ( !stream ) {
+        decoder.flush();
+        endOfStream = true;
+      }
+      continue;
+    }
+    if ( metricsParams.computeChecksum_ ) { checksum.computeDecoded( reconstructs ); }
+    if ( metricsParams.computeMetrics_ ) {
+      PCCGroupOfFrames sources;
+      PCCGroupOfFrames normals;
+      if ( !sources.load( metricsParams.uncompressedDataPath_, frameNumber, frameNumber + 1,
+                          decoderParams.colorTransform_ ) ) {
+        return -1;
+      }
+      if ( !metricsParams.normalDataPath_.empty() ) {
+        if ( !normals.load( metricsParams.normalDataPath_, frameNumber, frameNumber + 1, COLOR_TRANSFORM_NONE,
+                            true ) ) {
           return -1;
         }
-        if ( !metricsParams.normalDataPath_.empty() ) {
-          if ( !normals.load( metricsParams.normalDataPath_, frameNumber, frameNumber + reconstructs.getFrameCount(),
-                              COLOR_TRANSFORM_NONE, true ) ) {
-            return -1;
-          }
-        }
-        metrics.compute( sources, reconstructs, normals );
-        sources.clear();
-        normals.clear();
       }
-      if ( !decoderParams.reconstructedDataPath_.empty() ) {
-        reconstructs.write( decoderParams.reconstructedDataPath_, frameNumber );
-      } else {
-        frameNumber += reconstructs.getFrameCount();
-      }
-      bMoreData = ( ssvu.getV3CUnitCount() > 0 );
+      metrics.compute( sources, reconstructs, normals );
+    }
+    if ( !decoderParams.reconstructedDataPath_.empty() ) {
+      reconstructs.write( decoderParams.reconstructedDataPath_, frameNumber );
+    } else {
+      frameNumber++;
     }
   }
-  bitstreamStat.trace();
+  decoder.getBitstreamStat().trace();
   if ( metricsParams.computeMetrics_ ) { metrics.display(); }
   if ( metricsParams.computeChecksum_ ) {
     if ( !checksum.compareRecDec() ) { return -1; }
@@ -40,6 +40,7 @@
 #include "PCCChrono.h"
 #include "PCCMemory.h"
 #include "PCCDecoder.h"
+#include "PCCStreamDecoder.h"
 #include "PCCMetrics.h"
 #include "PCCChecksum.h"
 #include "PCCContext.h"
@@ -158,6 +158,17 @@ bool parseParameters( int                   argc,
       encoderParams.groupOfFramesSize_,
       encoderParams.groupOfFramesSize_, 
       "Random access period" )
+    ( "groupOfFramesPipelineDepth",
+      encoderParams.groupOfFramesPipelineDepth_,
+      encoderParams.groupOfFramesPipelineDepth_,
+      "Number of groups of frames in flight: loading of GOF N+1, encoding of\n"
+      "GOF N and metrics of GOF N-1 are overlapped when greater than 1" )
+    ( "v3cUnitSizePrecisionBytes",
+      encoderParams.v3cUnitSizePrecisionBytes_,
+      encoderParams.v3cUnitSizePrecisionBytes_,
+      "Sample stream V3C unit size precision in bytes:\n"
+      "  0: computed on the whole sequence, bitstream written at the end\n"
+      "  1..8: V3C units of each GOF written as soon as they are encoded" )
 
     // colour space conversion
     ( "colorTransform",
@@ -840,6 +851,10 @@ bool parseParameters( int                   argc,
       metricsParams.computeChecksum_,
       metricsParams.computeChecksum_, 
       "Compute checksum" )
+    ( "fastChecksum", 
+      metricsParams.fastChecksum_,
+      metricsParams.fastChecksum_, 
+      "Use a non-cryptographic digest in place of MD5 for the checksums, only comparable with the same mode" )
     ( "computeMetrics", 
       metricsParams.computeMetrics_,
       metricsParams.computeMetrics_, 
@@ -915,6 +930,7 @@ bool parseParameters( int                   argc,
   metricsParams.print();
   if ( !metricsParams.check() ) { std::cerr << "Input metrics parameters not correct \n"; }
   metricsParams.startFrameNumber_ = encoderParams.startFrameNumber_;
+  metricsParams.nbThread_         = encoderParams.nbThread_;
 
   // report the current configuration (only in the absence of errors so
   // that errors/warnings are more obvious and in the same place).
@@ -929,6 +945,7 @@ int compressVideo( const PCCEncoderParameters& encoderParams,
   const size_t startFrameNumber0        = encoderParams.startFrameNumber_;
   size_t       endFrameNumber0          = encoderParams.startFrameNumber_ + encoderParams.frameCount_;
   const size_t groupOfFramesSize0       = ( std::max )( size_t( 1 ), encoderParams.groupOfFramesSize_ );
+  const size_t pipelineDepth            = ( std::max )( size_t( 1 ), encoderParams.groupOfFramesPipelineDepth_ );
   size_t       startFrameNumber         = startFrameNumber0;
   size_t       reconstructedFrameNumber = encoderParams.startFrameNumber_;
 
@@ -937,89 +954,190 @@ int compressVideo( const PCCEncoderParameters& encoderParams,
   std::unique_ptr<uint8_t> buffer;
   size_t                   contextIndex = 0;
   PCCEncoder               encoder;
+  PCCKdTreeCache           kdTreeCache;
   encoder.setLogger( logger );
   encoder.setParameters( encoderParams );
+  encoder.setKdTreeCache( &kdTreeCache );
   std::vector<std::vector<uint8_t>> reconstructedChecksums;
   std::vector<std::vector<uint8_t>> sourceReorderChecksums;
   std::vector<std::vector<uint8_t>> reconstructedReorderChecksums;
   PCCMetrics                        metrics;
   PCCChecksum                       checksum;
   metrics.setParameters( metricsParams );
+  metrics.setKdTreeCache( &kdTreeCache );
   checksum.setParameters( metricsParams );
 
   PCCBitstreamStat    bitstreamStat;
   SampleStreamV3CUnit ssvu;
-  // Place to get/set default values for gof metadata enabled flags (in sequence level).
-  while ( startFrameNumber < endFrameNumber0 ) {
-    size_t     endFrameNumber = min( startFrameNumber + groupOfFramesSize0, endFrameNumber0 );
-    PCCContext context;
-    context.setBitstreamStat( bitstreamStat );
-    context.addV3CParameterSet( contextIndex );
-    context.setActiveVpsId( contextIndex );
-    PCCGroupOfFrames sources;
-    PCCGroupOfFrames reconstructs;
-    clock.start();
-    if ( !sources.load( encoderParams.uncompressedDataPath_, startFrameNumber, endFrameNumber,
-                        encoderParams.colorTransform_, false, encoderParams.nbThread_ ) ) {
+
+  // With a fixed unit size precision, the sample stream header is written first and the V3C units of each GOF are
+  // flushed to the output file as soon as they are produced, so only one GOF is kept in memory.
+  const bool    streamOutput = encoderParams.v3cUnitSizePrecisionBytes_ > 0;
+  std::ofstream streamFile;
+  size_t        streamSize = 0;
+  if ( streamOutput ) {
+    streamFile.open( encoderParams.compressedStreamPath_, std::ios::binary );
+    if ( !streamFile.is_open() ) {
+      std::cerr << "Error: can't open " << encoderParams.compressedStreamPath_ << std::endl;
       return -1;
     }
-    if ( sources.getFrameCount() < endFrameNumber - startFrameNumber ) {
-      endFrameNumber  = startFrameNumber + sources.getFrameCount();
-      endFrameNumber0 = endFrameNumber;
-    }
-
-    std::cout << "Compressing " << contextIndex << " frames " << startFrameNumber << " -> " << endFrameNumber << "..."
-              << std::endl;
-    int                ret = encoder.encode( sources, context, reconstructs );
+    ssvu.setSsvhUnitSizePrecisionBytesMinus1( static_cast<uint32_t>( encoderParams.v3cUnitSizePrecisionBytes_ - 1 ) );
+    PCCBitstream       bitstream;
     PCCBitstreamWriter bitstreamWriter;
-#ifdef BITSTREAM_TRACE
-    bitstreamWriter.setLogger( logger );
-#endif
-    ret |= bitstreamWriter.encode( context, ssvu );
-
-    clock.stop();
-
-    PCCGroupOfFrames normals;
-    bool             bRunMetric = true;
-    if ( metricsParams.computeMetrics_ ) {
-      if ( !metricsParams.normalDataPath_.empty() ) {
-        if ( !normals.load( metricsParams.normalDataPath_, startFrameNumber, endFrameNumber, COLOR_TRANSFORM_NONE,
-                            true ) ) {
-          bRunMetric = false;
-        }
-      }
-      if ( bRunMetric ) { metrics.compute( sources, reconstructs, normals ); }
-    }
-    if ( metricsParams.computeChecksum_ ) {
-      if ( encoderParams.losslessGeo_ ) {
-        checksum.computeSource( sources );
-        checksum.computeReordered( reconstructs );
-      }
-      checksum.computeReconstructed( reconstructs );
-    }
-    if ( ret != 0 ) { return ret; }
-    if ( !encoderParams.reconstructedDataPath_.empty() ) {
-      reconstructs.write( encoderParams.reconstructedDataPath_, reconstructedFrameNumber );
-    }
-    normals.clear();
-    sources.clear();
-    reconstructs.clear();
-    startFrameNumber = endFrameNumber;
-    contextIndex++;
+    bitstreamStat.incrHeader( bitstreamWriter.writeHeader( ssvu, bitstream ) );
+    bitstream.write( streamFile );
+    streamSize += bitstream.size();
   }
 
-  PCCBitstream bitstream;
+  // The GOFs go through a three-stage pipeline: loading, encoding and
+  // metrics/checksum/writing. Each stage is serial and processes the GOFs in
+  // order, so the V3C units are appended to ssvu in the same order as in a
+  // sequential run. With a depth greater than 1, the stages of consecutive
+  // GOFs are overlapped. The user time can then only be measured on the
+  // whole pipeline.
+  struct GroupOfFramesToken {
+    size_t           contextIndex_;
+    size_t           startFrameNumber_;
+    size_t           endFrameNumber_;
+    int              ret_;
+    PCCGroupOfFrames sources_;
+    PCCGroupOfFrames reconstructs_;
+  };
+  std::atomic<int> status( 0 );
+  int              loadStatus = 0;
+  if ( pipelineDepth > 1 ) { clock.start(); }
+  // the stages run in the arena limited to nbThread, as the parallel loops of the codec
+  tbb::task_arena limited( encoderParams.nbThread_ > 0 ? static_cast<int>( encoderParams.nbThread_ )
+                                                       : static_cast<int>( tbb::task_arena::automatic ) );
+  limited.execute( [&] {
+    tbb::parallel_pipeline(
+        pipelineDepth,
+        tbb::make_filter<void, GroupOfFramesToken*>(
+            tbb::filter::serial_in_order,
+            [&]( tbb::flow_control& fc ) -> GroupOfFramesToken* {
+              if ( loadStatus != 0 || status != 0 || startFrameNumber >= endFrameNumber0 ) {
+                fc.stop();
+                return nullptr;
+              }
+              auto* gof              = new GroupOfFramesToken;
+              gof->contextIndex_     = contextIndex;
+              gof->startFrameNumber_ = startFrameNumber;
+              gof->endFrameNumber_   = min( startFrameNumber + groupOfFramesSize0, endFrameNumber0 );
+              gof->ret_              = 0;
+              if ( pipelineDepth == 1 ) { clock.start(); }
+              if ( !gof->sources_.load( encoderParams.uncompressedDataPath_, gof->startFrameNumber_,
+                                        gof->endFrameNumber_, encoderParams.colorTransform_, false,
+                                        encoderParams.nbThread_ ) ) {
+                loadStatus = -1;
+                delete gof;
+                fc.stop();
+                return nullptr;
+              }
+              if ( gof->sources_.getFrameCount() < gof->endFrameNumber_ - gof->startFrameNumber_ ) {
+                gof->endFrameNumber_ = gof->startFrameNumber_ + gof->sources_.getFrameCount();
+                endFrameNumber0      = gof->endFrameNumber_;
+              }
+              startFrameNumber = gof->endFrameNumber_;
+              contextIndex++;
+              // the files of the next GOF are read ahead by the system while this one is encoded
+              PCCGroupOfFrames::prefetch( encoderParams.uncompressedDataPath_, startFrameNumber,
+                                          min( startFrameNumber + groupOfFramesSize0, endFrameNumber0 ) );
+              return gof;
+            } ) &
+            tbb::make_filter<GroupOfFramesToken*, GroupOfFramesToken*>(
+                tbb::filter::serial_in_order,
+                [&]( GroupOfFramesToken* gof ) -> GroupOfFramesToken* {
+                  if ( status != 0 ) { return gof; }
+                  std::cout << "Compressing " << gof->contextIndex_ << " frames " << gof->startFrameNumber_
+                            << " -> " << gof->endFrameNumber_ << "..." << std::endl;
+                  PCCContext context;
+                  context.setBitstreamStat( bitstreamStat );
+                  context.addV3CParameterSet( gof->contextIndex_ );
+                  context.setActiveVpsId( gof->contextIndex_ );
+                  gof->ret_ = encoder.encode( gof->sources_, context, gof->reconstructs_ );
+                  PCCBitstreamWriter bitstreamWriter;
+  #ifdef BITSTREAM_TRACE
+                  bitstreamWriter.setLogger( logger );
+  #endif
+                  gof->ret_ |= bitstreamWriter.encode( context, ssvu );
+                  if ( streamOutput && gof->ret_ == 0 ) {
+                    PCCBitstream bitstream;
+  #ifdef BITSTREAM_TRACE
+                    bitstream.setLogger( logger );
+                    bitstream.setTrace( true );
+  #endif
+                    size_t headerSize = 0;
+                    gof->ret_         = bitstreamWriter.writeV3CUnits( ssvu, bitstream, headerSize );
+                    bitstreamStat.incrHeader( headerSize );
+                    if ( gof->ret_ == 0 && !bitstream.write( streamFile ) ) { gof->ret_ = -1; }
+                    streamSize += bitstream.size();
+                  }
+                  if ( pipelineDepth == 1 ) { clock.stop(); }
+                  if ( gof->ret_ != 0 ) { status = gof->ret_; }
+                  return gof;
+                } ) &
+            tbb::make_filter<GroupOfFramesToken*, void>(
+                tbb::filter::serial_in_order, [&]( GroupOfFramesToken* gof ) {
+                  std::unique_ptr<GroupOfFramesToken> release( gof );
+                  // the kd-trees of the source and reconstructed frames are shared by the encoder and the metrics
+                  auto releaseKdTrees = [&]() {
+                    for ( size_t i = 0; i < gof->sources_.getFrameCount(); i++ ) {
+                      kdTreeCache.release( gof->sources_[i] );
+                    }
+                    for ( size_t i = 0; i < gof->reconstructs_.getFrameCount(); i++ ) {
+                      kdTreeCache.release( gof->reconstructs_[i] );
+                    }
+                  };
+                  if ( status != 0 && gof->ret_ == 0 ) {
+                    releaseKdTrees();
+                    return;
+                  }
+                  PCCGroupOfFrames normals;
+                  bool             bRunMetric = true;
+                  if ( metricsParams.computeMetrics_ ) {
+                    if ( !metricsParams.normalDataPath_.empty() ) {
+                      if ( !normals.load( metricsParams.normalDataPath_, gof->startFrameNumber_,
+                                          gof->endFrameNumber_, COLOR_TRANSFORM_NONE, true ) ) {
+                        bRunMetric = false;
+                      }
+                    }
+                    if ( bRunMetric ) { metrics.compute( gof->sources_, gof->reconstructs_, normals ); }
+                  }
+                  releaseKdTrees();
+                  if ( metricsParams.computeChecksum_ ) {
+                    if ( encoderParams.losslessGeo_ ) {
+                      checksum.computeSource( gof->sources_ );
+                      checksum.computeReordered( gof->reconstructs_ );
+                    }
+                    checksum.computeReconstructed( gof->reconstructs_ );
+                  }
+                  if ( gof->ret_ != 0 ) { return; }
+                  if ( !encoderParams.reconstructedDataPath_.empty() ) {
+                    gof->reconstructs_.write( encoderParams.reconstructedDataPath_, reconstructedFrameNumber );
+                  }
+                } ) );
+  } );
+  if ( pipelineDepth > 1 ) { clock.stop(); }
+  if ( loadStatus != 0 ) { return loadStatus; }
+  if ( status != 0 ) { return status; }
+
+  if ( streamOutput ) {
+    streamFile.close();
+  } else {
+    PCCBitstream bitstream;
 #ifdef BITSTREAM_TRACE
-  bitstream.setLogger( logger );
-  bitstream.setTrace( true );
+    bitstream.setLogger( logger );
+    bitstream.setTrace( true );
 #endif
-  bitstreamStat.setHeader( bitstream.size() );
-  PCCBitstreamWriter bitstreamWriter;
-  size_t             headerSize = bitstreamWriter.write( ssvu, bitstream );
-  bitstreamStat.incrHeader( headerSize );
-  bitstream.write( encoderParams.compressedStreamPath_ );
+    bitstreamStat.setHeader( bitstream.size() );
+    PCCBitstreamWriter bitstreamWriter;
+    size_t             headerSize = bitstreamWriter.write( ssvu, bitstream );
+    bitstreamStat.incrHeader( headerSize );
+    bitstream.write( encoderParams.compressedStreamPath_ );
+    streamSize = bitstream.size();
+  }
   bitstreamStat.trace();
-  std::cout << "Total bitstream size " << bitstream.size() << " B" << std::endl;
+  std::cout << "Total bitstream size " << streamSize << " B" << std::endl;
 
   if ( metricsParams.computeMetrics_ ) { metrics.display(); }
   bool checksumEqual = true;
@@ -51,6 +51,7 @@
 #include "PCCMetricsParameters.h"
 #include <program_options_lite.h>
 #include <tbb/tbb.h>
+#include <atomic>
 
 bool parseParameters( int                        argc,
                       char*                      argv[],
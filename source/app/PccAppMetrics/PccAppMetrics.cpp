@@ -48,7 +48,8 @@ int main( int argc, char* argv[] ) {
   pcc::chrono::StopwatchUserTime                    clockUser;
 
   clockWall.start();
-  int ret = computeMetrics( metricsParams, clockUser );
+  int ret = metricsParams.reconstructedDataListPath_.empty() ? computeMetrics( metricsParams, clockUser )
+                                                             : computeMetricsBatch( metricsParams, clockUser );
   clockWall.stop();
 
   using namespace std::chrono;
@@ -94,6 +95,13 @@ bool parseParameters( int argc, char* argv[], PCCMetricsParameters& metricsParam
     ("normalDataPath", metricsParams.normalDataPath_,
     metricsParams.normalDataPath_,
     "Input pointcloud to encode. Multi-frame sequences may be represented by %04i") 
+    ("reconstructedDataListPath", metricsParams.reconstructedDataListPath_,
+    metricsParams.reconstructedDataListPath_,
+    "File listing the decoded pointclouds evaluated against the same source, one path per line. "
+    "Multi-frame sequences may be represented by %04i") 
+    ("resultPath", metricsParams.resultPath_, metricsParams.resultPath_,
+    "Output per frame metrics of the reconstructedDataListPath sequences, in JSON if the path ends with .json, "
+    "in CSV otherwise") 
     ("resolution", metricsParams.resolution_, metricsParams.resolution_,
     "Specify the intrinsic resolution") 
     ("dropdups", metricsParams.dropDuplicates_,
@@ -157,3 +165,163 @@ int computeMetrics( const PCCMetricsParameters& metricsParams, StopwatchUserTime
   metrics.display();
   return 0;
 }
+
+static std::vector<std::pair<const char*, float>> getValues( const QualityMetrics& quality ) {
+  return {{"c2cMse", quality.c2cMse_},
+          {"c2cPsnr", quality.c2cPsnr_},
+          {"c2pMse", quality.c2pMse_},
+          {"c2pPsnr", quality.c2pPsnr_},
+          {"c2cHausdorff", quality.c2cHausdorff_},
+          {"c2cHausdorffPsnr", quality.c2cHausdorffPsnr_},
+          {"c2pHausdorff", quality.c2pHausdorff_},
+          {"c2pHausdorffPsnr", quality.c2pHausdorffPsnr_},
+          {"c0Mse", quality.colorMse_[0]},
+          {"c1Mse", quality.colorMse_[1]},
+          {"c2Mse", quality.colorMse_[2]},
+          {"c0Psnr", quality.colorPsnr_[0]},
+          {"c1Psnr", quality.colorPsnr_[1]},
+          {"c2Psnr", quality.colorPsnr_[2]},
+          {"reflectanceMse", quality.reflectanceMse_},
+          {"reflectancePsnr", quality.reflectancePsnr_}};
+}
+
+static std::string getJsonString( const std::string& str ) {
+  std::string result = "\"";
+  for ( const auto c : str ) {
+    if ( c == '"' || c == '\\' ) { result += '\\'; }
+    result += c;
+  }
+  return result + "\"";
+}
+
+static bool writeResults( const std::string&              path,
+                          const std::vector<std::string>& reconstructedDataPaths,
+                          const std::vector<PCCMetrics>&  metrics,
+                          size_t                          startFrameNumber ) {
+  std::ofstream file( path );
+  if ( !file.is_open() ) {
+    printf( "Error: can't open result file %s \n", path.c_str() );
+    return false;
+  }
+  const char   codes[3] = {'1', '2', 'F'};
+  const bool   json     = path.size() >= 5 && path.compare( path.size() - 5, 5, ".json" ) == 0;
+  const size_t count    = reconstructedDataPaths.size();
+  file << std::setprecision( 9 );
+  if ( json ) {
+    file << "[";
+    for ( size_t i = 0; i < count; i++ ) {
+      for ( size_t f = 0; f < metrics[i].getFrameCount(); f++ ) {
+        file << ( i + f == 0 ? "\n" : ",\n" )
+             << "  {\"reconstructedDataPath\": " << getJsonString( reconstructedDataPaths[i] )
+             << ", \"frame\": " << startFrameNumber + f << ", \"sourcePoints\": " << metrics[i].getSourcePointCount( f )
+             << ", \"reconstructPoints\": " << metrics[i].getReconstructPointCount( f );
+        const QualityMetrics* qualities[3] = {&metrics[i].getQuality1()[f], &metrics[i].getQuality2()[f],
+                                              &metrics[i].getQualityF()[f]};
+        for ( size_t q = 0; q < 3; q++ ) {
+          file << ", \"" << codes[q] << "\": {";
+          const auto values = getValues( *qualities[q] );
+          for ( size_t v = 0; v < values.size(); v++ ) {
+            file << ( v == 0 ? "" : ", " ) << "\"" << values[v].first << "\": ";
+            // JSON has no representation of the infinite PSNR of identical point clouds
+            if ( std::isfinite( values[v].second ) ) {
+              file << values[v].second;
+            } else {
+              file << "null";
+            }
+          }
+          file << "}";
+        }
+        file << "}";
+      }
+    }
+    file << "\n]\n";
+  } else {
+    file << "reconstructedDataPath,frame,sourcePoints,reconstructPoints";
+    for ( const auto code : codes ) {
+      for ( const auto& value : getValues( QualityMetrics() ) ) { file << "," << value.first << code; }
+    }
+    file << "\n";
+    for ( size_t i = 0; i < count; i++ ) {
+      for ( size_t f = 0; f < metrics[i].getFrameCount(); f++ ) {
+        file << reconstructedDataPaths[i] << "," << startFrameNumber + f << "," << metrics[i].getSourcePointCount( f )
+             << "," << metrics[i].getReconstructPointCount( f );
+        const QualityMetrics* qualities[3] = {&metrics[i].getQuality1()[f], &metrics[i].getQuality2()[f],
+                                              &metrics[i].getQualityF()[f]};
+        for ( const auto* quality : qualities ) {
+          for ( const auto& value : getValues( *quality ) ) { file << "," << value.second; }
+        }
+        file << "\n";
+      }
+    }
+  }
+  return true;
+}
+
+// Evaluates several reconstructions of the same source sequence: each source frame and its normals are loaded,
+// cleaned and indexed once, then the reconstructed frames are evaluated concurrently against it.
+int computeMetricsBatch( const PCCMetricsParameters& metricsParams, StopwatchUserTime& clock ) {
+  std::vector<std::string> reconstructedDataPaths;
+  std::ifstream            list( metricsParams.reconstructedDataListPath_ );
+  if ( !list.is_open() ) {
+    printf( "Error: can't open reconstructed data list %s \n", metricsParams.reconstructedDataListPath_.c_str() );
+    return -1;
+  }
+  std::string line;
+  while ( std::getline( list, line ) ) {
+    line.erase( line.find_last_not_of( " \t\r" ) + 1 );
+    if ( !line.empty() ) { reconstructedDataPaths.push_back( line ); }
+  }
+  if ( reconstructedDataPaths.empty() ) {
+    printf( "Error: reconstructed data list %s is empty \n", metricsParams.reconstructedDataListPath_.c_str() );
+    return -1;
+  }
+  const size_t            count = reconstructedDataPaths.size();
+  PCCKdTreeCache          kdTreeCache;
+  std::vector<PCCMetrics> metrics( count );
+  for ( auto& metric : metrics ) {
+    metric.setParameters( metricsParams );
+    metric.setKdTreeCache( &kdTreeCache );
+  }
+  tbb::task_arena limited( metricsParams.nbThread_ > 0 ? static_cast<int>( metricsParams.nbThread_ )
+                                                       : static_cast<int>( tbb::task_arena::automatic ) );
+  for ( size_t frameIndex = metricsParams.startFrameNumber_;
+        frameIndex < metricsParams.startFrameNumber_ + metricsParams.frameCount_; frameIndex++ ) {
+    PCCGroupOfFrames sources;
+    PCCGroupOfFrames normals;
+    PCCPointSet3     normalEmpty;
+    PCCPointSet3     source;
+    if ( !sources.load( metricsParams.uncompressedDataPath_, frameIndex, frameIndex + 1, COLOR_TRANSFORM_NONE ) ) {
+      return -1;
+    }
+    if ( !metricsParams.normalDataPath_.empty() ) {
+      if ( !normals.load( metricsParams.normalDataPath_, frameIndex, frameIndex + 1, COLOR_TRANSFORM_NONE, true ) ) {
+        return -1;
+      }
+    }
+    const PCCPointSet3& normal = normals.getFrameCount() == 0 ? normalEmpty : normals[0];
+    metrics[0].prepareSource( sources[0], normal, source );
+    std::atomic<bool> error( false );
+    limited.execute( [&] {
+      tbb::parallel_for( size_t( 0 ), count, [&]( const size_t i ) {
+        PCCGroupOfFrames reconstructs;
+        if ( !reconstructs.load( reconstructedDataPaths[i], frameIndex, frameIndex + 1, COLOR_TRANSFORM_NONE ) ) {
+          error = true;
+          return;
+        }
+        metrics[i].compute( source, sources[0].getPointCount(), reconstructs[0], normal );
+      } );
+    } );
+    kdTreeCache.clear();
+    if ( error ) { return -1; }
+  }
+  if ( metricsParams.resultPath_.empty() ) {
+    for ( size_t i = 0; i < count; i++ ) {
+      std::cout << "Reconstructed data path: " << reconstructedDataPaths[i] << std::endl;
+      metrics[i].display();
+    }
+  } else if ( !writeResults( metricsParams.resultPath_, reconstructedDataPaths, metrics,
+                             metricsParams.startFrameNumber_ ) ) {
+    return -1;
+  }
+  return 0;
+}
@@ -39,13 +39,18 @@
 #include "PCCChrono.h"
 
 #include "PCCGroupOfFrames.h"
+#include "PCCKdTree.h"
 #include "PCCMetrics.h"
 #include "PCCMetricsParameters.h"
 #include <program_options_lite.h>
 #include <tbb/tbb.h>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
 
 bool parseParameters( int argc, char* argv[], pcc::PCCMetricsParameters& params );
 void usage();
 int  computeMetrics( const pcc::PCCMetricsParameters& params, pcc::chrono::StopwatchUserTime& );
+int  computeMetricsBatch( const pcc::PCCMetricsParameters& params, pcc::chrono::StopwatchUserTime& );
 
 #endif /* PCC_APP_ENCODER_H */
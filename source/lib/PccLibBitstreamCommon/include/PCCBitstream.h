@@ -172,6 +172,7 @@ class PCCBitstream {
     position_.bytes_ = 0;
   }
   bool                  write( const std::string& compressedStreamPath );
+  bool                  write( std::ostream& stream );
   uint8_t*              buffer() { return data_.data(); }
   std::vector<uint8_t>& vector() { return data_; }
   uint64_t&             size() { return position_.bytes_; }
@@ -261,43 +262,34 @@ class PCCBitstream {
 
   template <typename T>
   inline void writeUvlc( T value ) {
-    uint32_t code = static_cast<uint32_t>( value );
-#ifdef BITSTREAM_TRACE
-    uint32_t orgCode            = code;
-    bool     traceStartingValue = trace_;
-    trace_                      = false;
-#endif
-    uint32_t length = 1, temp = ++code;
-    while ( 1 != temp ) {
-      temp >>= 1;
-      length += 2;
+    // value + 1 written on 2 * length + 1 bits is preceded by the length leading zeros of the code
+    const uint32_t code   = static_cast<uint32_t>( value ) + 1;
+    const uint32_t length = floorLog2( code );
+    if ( 2 * length + 1 <= 32 ) {
+      write( code, 2 * length + 1, position_ );
+    } else {
+      write( 0, length, position_ );
+      write( code, length + 1, position_ );
     }
-    write( 0, length >> 1 );
-    write( code, ( length + 1 ) >> 1 );
 #ifdef BITSTREAM_TRACE
-    trace_ = traceStartingValue;
-    trace( "  CodeUvlc: %4zu \n", orgCode );
+    trace( "  CodeUvlc: %4zu \n", static_cast<uint32_t>( value ) );
 #endif
   }
 
   inline uint32_t readUvlc() {
-#ifdef BITSTREAM_TRACE
-    bool traceStartingValue = trace_;
-    trace_                  = false;
-#endif
-    uint32_t value = 0, code = 0, length = 0;
-    code = read( 1 );
-    if ( 0 == code ) {
-      length = 0;
-      while ( !( code & 1 ) ) {
-        code = read( 1 );
-        length++;
-      }
-      value = read( length );
-      value += ( 1 << length ) - 1;
+    uint32_t       value = 0;
+    const uint32_t top   = static_cast<uint32_t>( load( position_ ) >> 32 );
+    if ( top != 0 ) {
+      // the leading zeros are counted in the next 32 bits
+      const uint32_t length = 31 - floorLog2( top );
+      skip( length + 1, position_ );
+      value = read( length, position_ ) + ( 1U << length ) - 1;
+    } else {
+      uint32_t length = 0;
+      while ( read( 1, position_ ) == 0 ) { length++; }
+      value = read( length, position_ ) + ( 1U << length ) - 1;
     }
 #ifdef BITSTREAM_TRACE
-    trace_ = traceStartingValue;
     trace( "  CodeUvlc: %4zu \n", value );
 #endif
     return value;
@@ -333,31 +325,52 @@ class PCCBitstream {
 #endif
  private:
   inline void realloc( const size_t size = 4096 ) { data_.resize( data_.size() + ( ( ( size / 4096 ) + 1 ) * 4096 ) ); }
+
+  // Returns the 64 bits that follow the position, the first one in the most significant bit. At least 57 of
+  // them are valid and the bits past the end of the data are zero.
+  inline uint64_t load( const PCCBistreamPosition& pos ) const {
+    const uint8_t* data   = data_.data() + pos.bytes_;
+    uint64_t       window = 0;
+    if ( pos.bytes_ + 8 <= data_.size() ) {
+      window = ( uint64_t( data[0] ) << 56 ) | ( uint64_t( data[1] ) << 48 ) | ( uint64_t( data[2] ) << 40 ) |
+               ( uint64_t( data[3] ) << 32 ) | ( uint64_t( data[4] ) << 24 ) | ( uint64_t( data[5] ) << 16 ) |
+               ( uint64_t( data[6] ) << 8 ) | uint64_t( data[7] );
+    } else {
+      for ( uint64_t i = 0; pos.bytes_ + i < data_.size(); i++ ) { window |= uint64_t( data[i] ) << ( 56 - 8 * i ); }
+    }
+    return window << pos.bits_;
+  }
+
+  inline void skip( const uint32_t bits, PCCBistreamPosition& pos ) {
+    pos.bytes_ += ( pos.bits_ + bits ) >> 3;
+    pos.bits_ = ( pos.bits_ + bits ) & 7;
+  }
+
+  // The fields wider than 32 bits only keep their 32 least significant bits.
   inline uint32_t read( uint8_t bits, PCCBistreamPosition& pos ) {
-    uint32_t value = 0;
-    for ( size_t i = 0; i < bits; i++ ) {
-      value |= ( ( data_[pos.bytes_] >> ( 7 - pos.bits_ ) ) & 1 ) << ( bits - 1 - i );
-      if ( pos.bits_ == 7 ) {
-        pos.bytes_++;
-        pos.bits_ = 0;
-      } else {
-        pos.bits_++;
-      }
+    if ( bits > 32 ) {
+      skip( bits - 32, pos );
+      bits = 32;
     }
+    if ( bits == 0 ) { return 0; }
+    const uint32_t value = static_cast<uint32_t>( load( pos ) >> ( 64 - bits ) );
+    skip( bits, pos );
     return value;
   }
 
+  // The bits are or-ed in the bytes that follow the position, the data being zero past it.
   inline void write( uint32_t value, uint8_t bits, PCCBistreamPosition& pos ) {
     if ( pos.bytes_ + bits + 16 >= data_.size() ) { realloc(); }
-    for ( size_t i = 0; i < bits; i++ ) {
-      data_[pos.bytes_] |= ( ( value >> ( bits - 1 - i ) ) & 1 ) << ( 7 - pos.bits_ );
-      if ( pos.bits_ == 7 ) {
-        pos.bytes_++;
-        pos.bits_ = 0;
-      } else {
-        pos.bits_++;
-      }
+    if ( bits > 32 ) {
+      skip( bits - 32, pos );
+      bits = 32;
     }
+    if ( bits == 0 ) { return; }
+    const uint64_t code   = uint64_t( value ) & ( ( uint64_t( 1 ) << bits ) - 1 );
+    const uint64_t window = code << ( 64 - bits - pos.bits_ );
+    uint8_t*       data   = data_.data() + pos.bytes_;
+    for ( uint32_t i = 0; i < ( pos.bits_ + bits + 7U ) >> 3; i++ ) { data[i] |= uint8_t( window >> ( 56 - 8 * i ) ); }
+    skip( bits, pos );
   }
 
   std::vector<uint8_t> data_;
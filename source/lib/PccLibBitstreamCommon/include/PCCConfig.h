@@ -0,0 +1,7 @@
+#define TMC2_VERSION_MAJOR 12
+#define TMC2_VERSION_MINOR 0
+
+/* Define to 1 if getrusage(2) is present */
+#define HAVE_GETRUSAGE 1
+
+/* #undef ENABLE_PAPI_PROFILING */
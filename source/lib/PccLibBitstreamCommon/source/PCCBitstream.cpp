@@ -84,6 +84,12 @@ bool PCCBitstream::write( const std::string& compressedStreamPath ) {
   return true;
 }
 
+bool PCCBitstream::write( std::ostream& stream ) {
+  stream.write( reinterpret_cast<const char*>( data_.data() ), size() );
+  stream.flush();
+  return static_cast<bool>( stream );
+}
+
 void PCCBitstream::read( PCCVideoBitstream& videoBitstream ) {
 #ifdef BITSTREAM_TRACE
   trace( "Code: PCCVideoBitstream \n" );
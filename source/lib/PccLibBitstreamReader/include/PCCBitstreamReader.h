@@ -93,7 +93,15 @@ class PCCBitstreamReader {
   ~PCCBitstreamReader();
 
   static size_t read( PCCBitstream& bitstream, SampleStreamV3CUnit& ssvu );
-  int32_t       decode( SampleStreamV3CUnit& ssvu, PCCHighLevelSyntax& syntax );
+
+  // Decodes the V3C units of a group of frames: returns 1 on success and 0 if a unit can't be decoded (unknown
+  // type, missing V3C parameter set or payload truncated), the unit being removed from the ssvu.
+  int32_t decode( SampleStreamV3CUnit& ssvu, PCCHighLevelSyntax& syntax );
+
+  // Incremental sample stream reading: readHeader() reads the sample stream header, then each call to readV3CUnits()
+  // moves the complete V3C units available in the bitstream to the ssvu and stops at the first incomplete unit.
+  static size_t readHeader( PCCBitstream& bitstream, SampleStreamV3CUnit& ssvu );
+  static size_t readV3CUnits( PCCBitstream& bitstream, SampleStreamV3CUnit& ssvu );
 
 #ifdef BITSTREAM_TRACE
   void setLogger( PCCLogger& logger ) { logger_ = &logger; }
@@ -101,7 +109,7 @@ class PCCBitstreamReader {
  private:
   // 8.3.2 V3C unit syntax
   // 8.3.2.1 General V3C unit syntax
-  void v3cUnit( PCCHighLevelSyntax& syntax, V3CUnit& currV3CUnit, V3CUnitType& V3CUnitType );
+  bool v3cUnit( PCCHighLevelSyntax& syntax, V3CUnit& currV3CUnit, V3CUnitType& V3CUnitType );
 
   // 8.3.2.2 V3C unit header syntax
   static void v3cUnitHeader( PCCHighLevelSyntax& syntax, PCCBitstream& bitstream, V3CUnitType& V3CUnitType );
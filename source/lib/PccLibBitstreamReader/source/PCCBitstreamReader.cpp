@@ -68,6 +68,30 @@ size_t PCCBitstreamReader::read( PCCBitstream& bitstream, SampleStreamV3CUnit& s
   return headerSize;
 }
 
+size_t PCCBitstreamReader::readHeader( PCCBitstream& bitstream, SampleStreamV3CUnit& ssvu ) {
+  TRACE_BITSTREAM( "PCCBitstreamXXcoder: SampleStream Vpcc Header \n" );
+  sampleStreamV3CHeader( bitstream, ssvu );
+  return 1;
+}
+
+size_t PCCBitstreamReader::readV3CUnits( PCCBitstream& bitstream, SampleStreamV3CUnit& ssvu ) {
+  size_t       headerSize     = 0;
+  const size_t precisionBytes = ssvu.getSsvhUnitSizePrecisionBytesMinus1() + 1;
+  while ( bitstream.size() + precisionBytes <= bitstream.capacity() ) {
+    uint64_t unitSize = 0;
+    for ( size_t i = 0; i < precisionBytes; i++ ) {
+      unitSize = ( unitSize << 8 ) | bitstream.peekByteAt( bitstream.size() + i );
+    }
+    // compared with the remaining bytes so that a malformed size close to 2^64 can't wrap around
+    if ( unitSize > bitstream.capacity() - bitstream.size() - precisionBytes ) { break; }
+    auto& v3cUnit = ssvu.addV3CUnit();
+    sampleStreamV3CUnit( bitstream, ssvu, v3cUnit );
+    TRACE_BITSTREAM( "V3C Unit Size(%zu)  = %zu \n", ssvu.getV3CUnitCount(), v3cUnit.getSize() );
+    headerSize += precisionBytes;
+  }
+  return headerSize;
+}
+
 int32_t PCCBitstreamReader::decode( SampleStreamV3CUnit& ssvu, PCCHighLevelSyntax& syntax ) {
   bool endOfGop = false;
   int  numVPS   = 0;  // counter for the atlas information
@@ -75,7 +99,11 @@ int32_t PCCBitstreamReader::decode( SampleStreamV3CUnit& ssvu, PCCHighLevelSynta
   while ( !endOfGop && ssvu.getV3CUnitCount() > 0 ) {
     auto&       unit        = ssvu.front();
     V3CUnitType v3cUnitType = V3C_VPS;
-    v3cUnit( syntax, unit, v3cUnitType );
+    if ( !v3cUnit( syntax, unit, v3cUnitType ) ) {
+      printf( "ERROR: the V3C unit of type %s can't be decoded \n", toString( unit.getType() ).c_str() );
+      ssvu.popFront();  // remove element
+      return 0;
+    }
     if ( v3cUnitType == V3C_VPS ) {
       numVPS++;
       if ( numVPS > 1 ) {
@@ -152,7 +180,7 @@ void PCCBitstreamReader::videoSubStream( PCCHighLevelSyntax& syntax,
 
 // 8.3.2 V3C unit syntax
 // 8.3.2.1 General V3C unit syntax
-void PCCBitstreamReader::v3cUnit( PCCHighLevelSyntax& syntax, V3CUnit& currV3CUnit, V3CUnitType& v3cUnitType ) {
+bool PCCBitstreamReader::v3cUnit( PCCHighLevelSyntax& syntax, V3CUnit& currV3CUnit, V3CUnitType& v3cUnitType ) {
   PCCBitstream& bitstream = currV3CUnit.getBitstream();
 #ifdef BITSTREAM_TRACE
   bitstream.setTrace( true );
@@ -162,13 +190,25 @@ void PCCBitstreamReader::v3cUnit( PCCHighLevelSyntax& syntax, V3CUnit& currV3CUn
   TRACE_BITSTREAM( "%s \n", __func__ );
   auto position = static_cast<int32_t>( bitstream.size() );
   v3cUnitHeader( syntax, bitstream, v3cUnitType );
-  assert( v3cUnitType == currV3CUnit.getType() );
+  if ( v3cUnitType != currV3CUnit.getType() || v3cUnitType > V3C_AVD ) { return false; }
+  if ( v3cUnitType != V3C_VPS ) {
+    // the unit must refer to a V3C parameter set received before it
+    auto& vpsList = syntax.getVpsList();
+    auto  vpsId   = syntax.getV3CUnitHeader( static_cast<int>( v3cUnitType ) - 1 ).getV3CParameterSetId();
+    if ( std::none_of( vpsList.begin(), vpsList.end(),
+                       [&]( V3CParameterSet& vps ) { return vps.getV3CParameterSetId() == vpsId; } ) ) {
+      return false;
+    }
+  }
   v3cUnitPayload( syntax, bitstream, v3cUnitType );
+  // the payload must not be read past the end of the unit
+  if ( bitstream.size() > bitstream.capacity() ) { return false; }
   syntax.getBitstreamStat().setV3CUnitSize( v3cUnitType, static_cast<int32_t>( bitstream.size() ) - position );
   TRACE_BITSTREAM( "v3cUnit: V3CUnitType = %d(%s) \n", v3cUnitType, toString( v3cUnitType ).c_str() );
   TRACE_BITSTREAM( "v3cUnit: size [%d ~ %d] \n", position, bitstream.size() );
   TRACE_BITSTREAM( "%s done\n", __func__ );
   std::cout << "<----v3cUnit: V3CUnitType = " << toString( V3CUnitType( v3cUnitType ) ) << std::endl;
+  return true;
 }
 
 // 8.3.2.2 V3C unit header syntax
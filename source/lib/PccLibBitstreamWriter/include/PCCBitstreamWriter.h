@@ -98,6 +98,11 @@ class PCCBitstreamWriter {
   size_t  write( SampleStreamV3CUnit& ssvu, PCCBitstream& bitstream );
   int     encode( PCCHighLevelSyntax& syntax, SampleStreamV3CUnit& ssvu );
 
+  // Incremental sample stream writing: the header is written once with the unit size precision already set in the
+  // ssvu, then each call to writeV3CUnits() moves the pending V3C units to the bitstream and removes them from the ssvu.
+  size_t writeHeader( SampleStreamV3CUnit& ssvu, PCCBitstream& bitstream );
+  int    writeV3CUnits( SampleStreamV3CUnit& ssvu, PCCBitstream& bitstream, size_t& headerSize );
+
 #ifdef BITSTREAM_TRACE
   void setLogger( PCCLogger& logger ) { logger_ = &logger; }
 #endif
@@ -82,6 +82,32 @@ size_t PCCBitstreamWriter::write( SampleStreamV3CUnit& ssvu, PCCBitstream& bitst
   return headerSize;
 }
 
+size_t PCCBitstreamWriter::writeHeader( SampleStreamV3CUnit& ssvu, PCCBitstream& bitstream ) {
+  TRACE_BITSTREAM( "PCCBitstreamXXcoder: SampleStream Vpcc Header \n" );
+  TRACE_BITSTREAM( " => SsvhUnitSizePrecisionBytesMinus1 = %u \n", ssvu.getSsvhUnitSizePrecisionBytesMinus1() );
+  sampleStreamV3CHeader( bitstream, ssvu );
+  return 1;
+}
+
+int PCCBitstreamWriter::writeV3CUnits( SampleStreamV3CUnit& ssvu, PCCBitstream& bitstream, size_t& headerSize ) {
+  TRACE_BITSTREAM( "PCCBitstreamXXcoder: SampleStream Vpcc Units (%zu) \n", ssvu.getV3CUnitCount() );
+  const uint32_t precisionBits = 8 * ( ssvu.getSsvhUnitSizePrecisionBytesMinus1() + 1 );
+  for ( auto& v3cUnit : ssvu.getV3CUnit() ) {
+    if ( precisionBits < 64 && ( static_cast<uint64_t>( v3cUnit.getSize() ) >> precisionBits ) != 0 ) {
+      fprintf( stderr, "V3C unit size %zu can't be coded with ssvh_unit_size_precision_bytes_minus1 = %u \n",
+               v3cUnit.getSize(), ssvu.getSsvhUnitSizePrecisionBytesMinus1() );
+      return -1;
+    }
+  }
+  for ( auto& v3cUnit : ssvu.getV3CUnit() ) {
+    sampleStreamV3CUnit( bitstream, ssvu, v3cUnit );
+    TRACE_BITSTREAM( "V3C Unit Size(unit type:%zu)  = %zu \n", (size_t)v3cUnit.getType(), v3cUnit.getSize() );
+    headerSize += ssvu.getSsvhUnitSizePrecisionBytesMinus1() + 1;
+  }
+  ssvu.getV3CUnit().clear();
+  return 0;
+}
+
 int PCCBitstreamWriter::encode( PCCHighLevelSyntax& syntax, SampleStreamV3CUnit& ssvu ) {
   auto& vuhGVD = syntax.getV3CUnitHeaderGVD();
   auto& vuhAD  = syntax.getV3CUnitHeaderAD();
@@ -84,14 +84,14 @@ class PCCInternalColorConverter : public PCCVirtualColorConverter<T> {
   void convertYUV420ToYUV444( PCCVideo<T, 3>& videoSrc, PCCVideo<T, 3>& videoDst, size_t nbyte, size_t filter );
   void convertYUV420ToYUV444( PCCImage<T, 3>& imageSrc, PCCImage<T, 3>& imageDst, size_t nbyte, size_t filter );
 
-  void RGBtoFloatRGB( const std::vector<T>& src, std::vector<float>& dst, const size_t nbyte ) const;
-
-  void convertRGBToYUV( const std::vector<float>& R,
-                        const std::vector<float>& G,
-                        const std::vector<float>& B,
-                        std::vector<float>&       Y,
-                        std::vector<float>&       U,
-                        std::vector<float>&       V ) const;
+  void convertRGBToYUV( const T*     R,
+                        const T*     G,
+                        const T*     B,
+                        float*       Y,
+                        float*       U,
+                        float*       V,
+                        const size_t count,
+                        const size_t nbyte ) const;
 
   T                   clamp( T v, T a, T b ) const { return ( ( v < a ) ? a : ( ( v > b ) ? b : v ) ); }
   int                 clamp( int v, int a, int b ) const { return ( ( v < a ) ? a : ( ( v > b ) ? b : v ) ); }
@@ -102,13 +102,18 @@ class PCCInternalColorConverter : public PCCVirtualColorConverter<T> {
   static inline float fMax( float a, float b ) { return ( ( a ) > ( b ) ) ? ( a ) : ( b ); }
   static inline float fClip( float x, float low, float high ) { return fMin( fMax( x, low ), high ); }
 
+  // Same as fClip( std::round( x ), 0.f, high ) for a finite x below 2^23 in magnitude and an integer high. The value
+  // is rounded before it is clipped, as a float clip followed by a conversion prevents the vectorization of the loops.
+  static inline int roundClip( float x, int high ) {
+    const int i = (int)x;
+    const int r = i + (int)( x - (float)i >= 0.5f );
+    return r < 0 ? 0 : r > high ? high : r;
+  }
+
   // TODO: This currently can't handle 10-bit. A new parameter is needed.
-  void floatYUVToYUV( const std::vector<float>& src, std::vector<T>& dst, const bool chroma, const size_t nbyte ) const;
+  void floatYUVToYUV( const float* src, T* dst, const size_t count, const bool chroma, const size_t nbyte ) const;
 
-  void YUVtoFloatYUV( const std::vector<T>& src,
-                      std::vector<float>&   dst,
-                      const bool            chroma,
-                      const size_t          nbBytes ) const;
+  void YUVtoFloatYUV( const T* src, float* dst, const size_t count, const bool chroma, const size_t nbBytes ) const;
 
   void convertYUVToRGB( const std::vector<float>& Y,
                         const std::vector<float>& U,
@@ -119,123 +124,40 @@ class PCCInternalColorConverter : public PCCVirtualColorConverter<T> {
 
   void floatRGBToRGB( const std::vector<float>& src, std::vector<T>& dst, const size_t nbyte ) const;
 
-  void downsampling( const std::vector<float>& chroma_in,
-                     std::vector<float>&       chroma_out,
-                     const int                 widthIn,
-                     const int                 heightIn,
-                     const int                 maxValue,
-                     const size_t              filter ) const;
-
-  void upsampling( const std::vector<float>& chromaIn,
-                   std::vector<float>&       chromaOut,
-                   const int                 widthIn,
-                   const int                 heightIn,
-                   const int                 maxValue,
-                   const size_t              filter ) const;
+  void downsamplingHorizontal( const Filter&        filter,
+                               const float*         in,
+                               float*               out,
+                               const int            widthIn,
+                               std::vector<double>& sum ) const;
+
+  void downsamplingVertical( const Filter&        filter,
+                             const float*         in,
+                             float*               out,
+                             const int            width,
+                             const int            heightIn,
+                             const int            i0,
+                             std::vector<double>& sum ) const;
+
+  void upsamplingVertical( const Filter&       filter,
+                           const float*        in,
+                           float*              out,
+                           const int           width,
+                           const int           heightIn,
+                           const int           i0,
+                           std::vector<float>& sum ) const;
+
+  void upsamplingHorizontal( const Filter&       filter,
+                             const float*        in,
+                             float*              out,
+                             const int           widthIn,
+                             const int           j0,
+                             std::vector<float>& sum ) const;
 
   inline void copy( const std::vector<float>& src, std::vector<float>& dst ) const {
     size_t count = src.size();
     dst.resize( count );
     for ( size_t i = 0; i < count; i++ ) { dst[i] = src[i]; }
   }
-
-  inline float downsamplingHorizontal( const Filter444to420&     filter,
-                                       const std::vector<float>& im,
-                                       const int                 width,
-                                       const int                 height,
-                                       const int                 i0,
-                                       const int                 j0 ) const {
-    const float scale    = 1.0f / ( (float)( 1 << ( (int)filter.horizontal_.shift_ ) ) );
-    const float offset   = 0.00000000;
-    const int   position = int( filter.horizontal_.data_.size() - 1 ) >> 1;
-    double      value    = 0;
-    for ( int j = 0; j < (int)filter.horizontal_.data_.size(); j++ ) {
-      value +=
-          (double)filter.horizontal_.data_[j] * (double)( im[i0 * width + clamp( j0 + j - position, 0, width - 1 )] );
-    }
-    return (float)( ( value + (double)offset ) * (double)scale );
-  }
-
-  inline float downsamplingVertical( const Filter444to420&     filter,
-                                     const std::vector<float>& im,
-                                     const int                 width,
-                                     const int                 height,
-                                     const int                 i0,
-                                     const int                 j0 ) const {
-    const float offset   = 0;
-    const float scale    = 1.0f / ( (float)( 1 << ( (int)filter.vertical_.shift_ ) ) );
-    const int   position = int( filter.vertical_.data_.size() - 1 ) >> 1;
-    double      value    = 0;
-    for ( int i = 0; i < (int)filter.vertical_.data_.size(); i++ ) {
-      value +=
-          (double)filter.vertical_.data_[i] * (double)( im[clamp( i0 + i - position, 0, height - 1 ) * width + j0] );
-    }
-    return (float)( ( value + (double)offset ) * (double)scale );
-  }
-
-  inline float upsamplingVertical0( const Filter420to444&     filter,
-                                    const std::vector<float>& im,
-                                    const int                 width,
-                                    const int                 height,
-                                    const int                 i0,
-                                    const int                 j0 ) const {
-    const float scale    = 1.0f / ( (float)( 1 << ( (int)filter.vertical0_.shift_ ) ) );
-    const float offset   = 0.00000000;
-    const int   position = int( filter.vertical0_.data_.size() + 1 ) >> 1;
-    float       value    = 0;
-    for ( int i = 0; i < (int)filter.vertical0_.data_.size(); i++ ) {
-      value += filter.vertical0_.data_[i] * (float)( im[clamp( i0 + i - position, 0, height - 1 ) * width + j0] );
-    }
-    return (float)( ( value + (float)offset ) * (float)scale );
-  }
-
-  inline float upsamplingVertical1( const Filter420to444&     filter,
-                                    const std::vector<float>& im,
-                                    int                       width,
-                                    int                       height,
-                                    int                       i0,
-                                    int                       j0 ) const {
-    const float scale    = 1.0f / ( (float)( 1 << ( (int)filter.vertical1_.shift_ ) ) );
-    const float offset   = 0.00000000;
-    const int   position = int( filter.vertical1_.data_.size() + 1 ) >> 1;
-    float       value    = 0;
-    for ( int i = 0; i < (int)filter.vertical1_.data_.size(); i++ ) {
-      value += filter.vertical1_.data_[i] * (float)( im[clamp( i0 + i - position, 0, height - 1 ) * width + j0] );
-    }
-    return (float)( ( value + (float)offset ) * (float)scale );
-  }
-
-  inline float upsamplingHorizontal0( const Filter420to444&     filter,
-                                      const std::vector<float>& im,
-                                      int                       width,
-                                      int                       height,
-                                      int                       i0,
-                                      int                       j0 ) const {
-    const float scale    = 1.0f / ( (float)( 1 << ( (int)filter.horizontal0_.shift_ ) ) );
-    const float offset   = 0.00000000;
-    const int   position = int( filter.horizontal0_.data_.size() + 1 ) >> 1;
-    float       value    = 0;
-    for ( int j = 0; j < (int)filter.horizontal0_.data_.size(); j++ ) {
-      value += filter.horizontal0_.data_[j] * (float)( im[i0 * width + clamp( j0 + j - position, 0, width - 1 )] );
-    }
-    return (float)( ( value + (float)offset ) * (float)scale );
-  }
-
-  inline float upsamplingHorizontal1( const Filter420to444&     filter,
-                                      const std::vector<float>& im,
-                                      int                       width,
-                                      int                       height,
-                                      int                       i0,
-                                      int                       j0 ) const {
-    const float scale    = 1.0f / ( (float)( 1 << ( (int)filter.horizontal1_.shift_ ) ) );
-    const float offset   = 0.00000000;
-    const int   position = int( filter.horizontal1_.data_.size() + 1 ) >> 1;
-    float       value    = 0;
-    for ( int j = 0; j < (int)filter.horizontal1_.data_.size(); j++ ) {
-      value += filter.horizontal1_.data_[j] * (float)( im[i0 * width + clamp( j0 + j - position, 0, width - 1 )] );
-    }
-    return (float)( ( value + (float)offset ) * (float)scale );
-  }
 };
 
 };  // namespace pcc
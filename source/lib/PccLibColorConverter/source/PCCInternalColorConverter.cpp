@@ -402,19 +402,32 @@ void PCCInternalColorConverter<T>::convertRGB44ToYUV420( PCCImage<T, 3>& imageSr
                                                          PCCImage<T, 3>& imageDst,
                                                          size_t          nbyte,
                                                          size_t          filter ) {
-  int width  = (int)imageSrc.getWidth();
-  int height = (int)imageSrc.getHeight();
+  const int width     = (int)imageSrc.getWidth();
+  const int height    = (int)imageSrc.getHeight();
+  const int widthOut  = width / 2;
+  const int heightOut = height / 2;
+  auto&     filters   = g_filter444to420[filter];
   imageDst.resize( width, height, pcc::PCCCOLORFORMAT::YUV420 );
-  std::vector<float> RGB444[3], YUV444[3], YUV420[3];
-  RGBtoFloatRGB( imageSrc[0], RGB444[0], nbyte );
-  RGBtoFloatRGB( imageSrc[1], RGB444[1], nbyte );
-  RGBtoFloatRGB( imageSrc[2], RGB444[2], nbyte );
-  convertRGBToYUV( RGB444[0], RGB444[1], RGB444[2], YUV444[0], YUV444[1], YUV444[2] );
-  downsampling( YUV444[1], YUV420[1], width, height, nbyte == 1 ? 255 : 1023, filter );
-  downsampling( YUV444[2], YUV420[2], width, height, nbyte == 1 ? 255 : 1023, filter );
-  floatYUVToYUV( YUV444[0], imageDst[0], 0, nbyte );
-  floatYUVToYUV( YUV420[1], imageDst[1], 1, nbyte );
-  floatYUVToYUV( YUV420[2], imageDst[2], 1, nbyte );
+  imageDst[1].resize( widthOut * heightOut );
+  imageDst[2].resize( widthOut * heightOut );
+  // the rows are converted and horizontally downsampled one at a time, only the horizontally downsampled chroma
+  // planes are stored for the vertical downsampling
+  std::vector<float>  Y( width ), U( width ), V( width ), chroma( widthOut );
+  std::vector<float>  tempU( widthOut * height ), tempV( widthOut * height );
+  std::vector<double> sum( widthOut );
+  for ( int i = 0; i < height; i++ ) {
+    convertRGBToYUV( imageSrc[0].data() + i * width, imageSrc[1].data() + i * width, imageSrc[2].data() + i * width,
+                     Y.data(), U.data(), V.data(), width, nbyte );
+    floatYUVToYUV( Y.data(), imageDst[0].data() + i * width, width, 0, nbyte );
+    downsamplingHorizontal( filters.horizontal_, U.data(), tempU.data() + i * widthOut, width, sum );
+    downsamplingHorizontal( filters.horizontal_, V.data(), tempV.data() + i * widthOut, width, sum );
+  }
+  for ( int i = 0; i < heightOut; i++ ) {
+    downsamplingVertical( filters.vertical_, tempU.data(), chroma.data(), widthOut, height, 2 * i, sum );
+    floatYUVToYUV( chroma.data(), imageDst[1].data() + i * widthOut, widthOut, 1, nbyte );
+    downsamplingVertical( filters.vertical_, tempV.data(), chroma.data(), widthOut, height, 2 * i, sum );
+    floatYUVToYUV( chroma.data(), imageDst[2].data() + i * widthOut, widthOut, 1, nbyte );
+  }
 }
 
 template <typename T>
@@ -433,73 +446,83 @@ void PCCInternalColorConverter<T>::convertYUV420ToYUV444( PCCImage<T, 3>& imageS
                                                           PCCImage<T, 3>& imageDst,
                                                           size_t          nbyte,
                                                           size_t          filter ) {
-  int width  = (int)imageSrc.getWidth();
-  int height = (int)imageSrc.getHeight();
+  const int width        = (int)imageSrc.getWidth();
+  const int height       = (int)imageSrc.getHeight();
+  const int widthChroma  = width / 2;
+  const int heightChroma = height / 2;
+  auto&     filters      = g_filter420to444[filter];
   imageDst.resize( width, height, pcc::PCCCOLORFORMAT::YUV444 );
-  size_t             widthChroma  = width / 2;
-  size_t             heightChroma = height / 2;
-  std::vector<float> YUV444[3], YUV420[3];
-  YUVtoFloatYUV( imageSrc[0], YUV420[0], 0, nbyte );
-  YUVtoFloatYUV( imageSrc[1], YUV420[1], 1, nbyte );
-  YUVtoFloatYUV( imageSrc[2], YUV420[2], 1, nbyte );
-  upsampling( YUV420[1], YUV444[1], widthChroma, heightChroma, nbyte == 1 ? 255 : 1023, filter );
-  upsampling( YUV420[2], YUV444[2], widthChroma, heightChroma, nbyte == 1 ? 255 : 1023, filter );
-  floatYUVToYUV( YUV420[0], imageDst[0], 0, 2 );
-  floatYUVToYUV( YUV444[1], imageDst[1], 1, 2 );
-  floatYUVToYUV( YUV444[2], imageDst[2], 1, 2 );
-}
-
-template <typename T>
-void PCCInternalColorConverter<T>::RGBtoFloatRGB( const std::vector<T>& src,
-                                                  std::vector<float>&   dst,
-                                                  const size_t          nbyte ) const {
-  size_t count = src.size();
-  dst.resize( count );
-  float offset = nbyte == 1 ? 255.f : 1023.f;
-  for ( size_t i = 0; i < count; i++ ) { dst[i] = (float)src[i] / offset; }
+  imageDst[0].resize( imageSrc[0].size() );
+  imageDst[1].resize( 4 * widthChroma * heightChroma );
+  imageDst[2].resize( 4 * widthChroma * heightChroma );
+  // the luma is converted through a row buffer, the chroma planes are vertically upsampled and each of their rows is
+  // then horizontally upsampled and converted
+  std::vector<float> row( std::max( width, 2 * widthChroma ) ), chroma( widthChroma * heightChroma ),
+      temp( widthChroma * 2 * heightChroma ), sum( widthChroma );
+  for ( size_t i = 0; i < imageSrc[0].size(); i += row.size() ) {
+    const size_t count = std::min( row.size(), imageSrc[0].size() - i );
+    YUVtoFloatYUV( imageSrc[0].data() + i, row.data(), count, 0, nbyte );
+    floatYUVToYUV( row.data(), imageDst[0].data() + i, count, 0, 2 );
+  }
+  for ( size_t c = 1; c < 3; c++ ) {
+    YUVtoFloatYUV( imageSrc[c].data(), chroma.data(), chroma.size(), 1, nbyte );
+    for ( int i = 0; i < heightChroma; i++ ) {
+      upsamplingVertical( filters.vertical0_, chroma.data(), temp.data() + ( 2 * i ) * widthChroma, widthChroma,
+                          heightChroma, i + 0, sum );
+      upsamplingVertical( filters.vertical1_, chroma.data(), temp.data() + ( 2 * i + 1 ) * widthChroma, widthChroma,
+                          heightChroma, i + 1, sum );
+    }
+    for ( int i = 0; i < 2 * heightChroma; i++ ) {
+      upsamplingHorizontal( filters.horizontal0_, temp.data() + i * widthChroma, row.data() + 0, widthChroma, 0, sum );
+      upsamplingHorizontal( filters.horizontal1_, temp.data() + i * widthChroma, row.data() + 1, widthChroma, 1, sum );
+      floatYUVToYUV( row.data(), imageDst[c].data() + i * 2 * widthChroma, 2 * widthChroma, 1, 2 );
+    }
+  }
 }
 
 template <typename T>
-void PCCInternalColorConverter<T>::convertRGBToYUV( const std::vector<float>& R,
-                                                    const std::vector<float>& G,
-                                                    const std::vector<float>& B,
-                                                    std::vector<float>&       Y,
-                                                    std::vector<float>&       U,
-                                                    std::vector<float>&       V ) const {
-  size_t count = R.size();
-  Y.resize( count );
-  U.resize( count );
-  V.resize( count );
+void PCCInternalColorConverter<T>::convertRGBToYUV( const T*     R,
+                                                    const T*     G,
+                                                    const T*     B,
+                                                    float*       Y,
+                                                    float*       U,
+                                                    float*       V,
+                                                    const size_t count,
+                                                    const size_t nbyte ) const {
+  // the values are clamped after their conversion to float, which gives the same floats as the conversion of the
+  // clamped doubles as the bounds are exact floats
+  const float offset = nbyte == 1 ? 255.f : 1023.f;
   for ( size_t i = 0; i < count; i++ ) {
-    Y[i] = (float)( (double)clamp( 0.212600 * R[i] + 0.715200 * G[i] + 0.072200 * B[i], 0.0, 1.0 ) );
-    U[i] = (float)( (double)clamp( -0.114572 * R[i] - 0.385428 * G[i] + 0.500000 * B[i], -0.5, 0.5 ) );
-    V[i] = (float)( (double)clamp( 0.500000 * R[i] - 0.454153 * G[i] - 0.045847 * B[i], -0.5, 0.5 ) );
+    const float r = (float)R[i] / offset;
+    const float g = (float)G[i] / offset;
+    const float b = (float)B[i] / offset;
+    Y[i]          = clamp( (float)( 0.212600 * r + 0.715200 * g + 0.072200 * b ), 0.f, 1.f );
+    U[i]          = clamp( (float)( -0.114572 * r - 0.385428 * g + 0.500000 * b ), -0.5f, 0.5f );
+    V[i]          = clamp( (float)( 0.500000 * r - 0.454153 * g - 0.045847 * b ), -0.5f, 0.5f );
   }
 }
 
 template <typename T>
-void PCCInternalColorConverter<T>::floatYUVToYUV( const std::vector<float>& src,
-                                                  std::vector<T>&           dst,
-                                                  const bool                chroma,
-                                                  const size_t              nbyte ) const {
-  size_t count = src.size();
-  dst.resize( count );
+void PCCInternalColorConverter<T>::floatYUVToYUV( const float* src,
+                                                  T*           dst,
+                                                  const size_t count,
+                                                  const bool   chroma,
+                                                  const size_t nbyte ) const {
   // double offset = chroma ? nbyte == 1 ? 128. : 512. : 0;
   // double scale  = nbyte == 1 ? 255. : 1023.;
   double offset = chroma ? nbyte == 1 ? 128. : 32768. : 0;
   double scale  = nbyte == 1 ? 255. : 65535.;
   for ( size_t i = 0; i < count; i++ ) {
-    dst[i] = static_cast<T>( fClip( std::round( (float)( scale * (double)src[i] + offset ) ), 0.f, (float)scale ) );
+    dst[i] = static_cast<T>( roundClip( (float)( scale * (double)src[i] + offset ), (int)scale ) );
   }
 }
 
 template <typename T>
-void PCCInternalColorConverter<T>::YUVtoFloatYUV( const std::vector<T>& src,
-                                                  std::vector<float>&   dst,
-                                                  const bool            chroma,
-                                                  const size_t          nbBytes ) const {
-  size_t count = src.size();
-  dst.resize( count );
+void PCCInternalColorConverter<T>::YUVtoFloatYUV( const T*     src,
+                                                  float*       dst,
+                                                  const size_t count,
+                                                  const bool   chroma,
+                                                  const size_t nbBytes ) const {
   float    minV   = chroma ? -0.5f : 0.f;
   float    maxV   = chroma ? 0.5f : 1.f;
   uint16_t offset = chroma ? nbBytes == 1 ? 128 : 512 : 0;
@@ -540,59 +563,97 @@ void PCCInternalColorConverter<T>::floatRGBToRGB( const std::vector<float>& src,
   }
 }
 
+// The filters accumulate the taps one at a time over a whole row of outputs, so the loops over the outputs vectorize
+// while each output is summed in the order of the taps. The outputs whose taps fall outside of the row are summed
+// with clamped positions.
 template <typename T>
-void PCCInternalColorConverter<T>::downsampling( const std::vector<float>& chroma_in,
-                                                 std::vector<float>&       chroma_out,
-                                                 const int                 widthIn,
-                                                 const int                 heightIn,
-                                                 const int                 maxValue,
-                                                 const size_t              filter ) const {
-  int                widthOut  = widthIn / 2;
-  int                heightOut = heightIn / 2;
-  std::vector<float> temp;
-  chroma_out.resize( widthOut * heightOut );
-  temp.resize( widthOut * heightIn );
-  for ( int i = 0; i < heightIn; i++ ) {
-    for ( int j = 0; j < widthOut; j++ ) {
-      temp[i * widthOut + j] =
-          downsamplingHorizontal( g_filter444to420[filter], chroma_in, widthIn, heightIn, i, j * 2 );
+void PCCInternalColorConverter<T>::downsamplingHorizontal( const Filter&        filter,
+                                                           const float*         in,
+                                                           float*               out,
+                                                           const int            widthIn,
+                                                           std::vector<double>& sum ) const {
+  const int    widthOut = widthIn / 2;
+  const int    taps     = (int)filter.data_.size();
+  const int    position = ( taps - 1 ) >> 1;
+  const double scale    = 1.0f / ( (float)( 1 << ( (int)filter.shift_ ) ) );
+  const int    j0       = ( std::min )( ( position + 1 ) / 2, widthOut );
+  const int    j1       = ( std::max )( j0, ( std::min )( widthOut, ( widthIn - taps + position ) / 2 + 1 ) );
+  double*      s        = sum.data();
+  for ( int j = 0; j < widthOut; j++ ) { s[j] = 0; }
+  for ( int i = 0; i < taps; i++ ) {
+    const double coef = filter.data_[i];
+    for ( int j = 0; j < j0; j++ ) { s[j] += coef * (double)in[clamp( 2 * j + i - position, 0, widthIn - 1 )]; }
+    for ( int j = j0; j < j1; j++ ) { s[j] += coef * (double)in[2 * j + i - position]; }
+    for ( int j = j1; j < widthOut; j++ ) {
+      s[j] += coef * (double)in[clamp( 2 * j + i - position, 0, widthIn - 1 )];
     }
   }
-  for ( int i = 0; i < heightOut; i++ ) {
-    for ( int j = 0; j < widthOut; j++ ) {
-      chroma_out[i * widthOut + j] =
-          downsamplingVertical( g_filter444to420[filter], temp, widthOut, heightIn, 2 * i, j );
-    }
+  for ( int j = 0; j < widthOut; j++ ) { out[j] = (float)( ( s[j] + 0. ) * scale ); }
+}
+
+template <typename T>
+void PCCInternalColorConverter<T>::downsamplingVertical( const Filter&        filter,
+                                                         const float*         in,
+                                                         float*               out,
+                                                         const int            width,
+                                                         const int            heightIn,
+                                                         const int            i0,
+                                                         std::vector<double>& sum ) const {
+  const int    taps     = (int)filter.data_.size();
+  const int    position = ( taps - 1 ) >> 1;
+  const double scale    = 1.0f / ( (float)( 1 << ( (int)filter.shift_ ) ) );
+  double*      s        = sum.data();
+  for ( int j = 0; j < width; j++ ) { s[j] = 0; }
+  for ( int i = 0; i < taps; i++ ) {
+    const double coef = filter.data_[i];
+    const float* src  = in + clamp( i0 + i - position, 0, heightIn - 1 ) * width;
+    for ( int j = 0; j < width; j++ ) { s[j] += coef * (double)src[j]; }
   }
+  for ( int j = 0; j < width; j++ ) { out[j] = (float)( ( s[j] + 0. ) * scale ); }
 }
 
 template <typename T>
-void PCCInternalColorConverter<T>::upsampling( const std::vector<float>& chromaIn,
-                                               std::vector<float>&       chromaOut,
-                                               const int                 widthIn,
-                                               const int                 heightIn,
-                                               const int                 maxValue,
-                                               const size_t              filter ) const {
-  int                widthOut = widthIn * 2, heightOut = heightIn * 2;
-  std::vector<float> temp;
-  chromaOut.resize( widthOut * heightOut );
-  temp.resize( widthIn * heightOut );
-  for ( int i = 0; i < heightIn; i++ ) {
-    for ( int j = 0; j < widthIn; j++ ) {
-      temp[( 2 * i ) * widthIn + j] =
-          upsamplingVertical0( g_filter420to444[filter], chromaIn, widthIn, heightIn, i + 0, j );
-      temp[( 2 * i + 1 ) * widthIn + j] =
-          upsamplingVertical1( g_filter420to444[filter], chromaIn, widthIn, heightIn, i + 1, j );
-    }
+void PCCInternalColorConverter<T>::upsamplingVertical( const Filter&       filter,
+                                                       const float*        in,
+                                                       float*              out,
+                                                       const int           width,
+                                                       const int           heightIn,
+                                                       const int           i0,
+                                                       std::vector<float>& sum ) const {
+  const int   taps     = (int)filter.data_.size();
+  const int   position = ( taps + 1 ) >> 1;
+  const float scale    = 1.0f / ( (float)( 1 << ( (int)filter.shift_ ) ) );
+  float*      s        = sum.data();
+  for ( int j = 0; j < width; j++ ) { s[j] = 0; }
+  for ( int i = 0; i < taps; i++ ) {
+    const float  coef = filter.data_[i];
+    const float* src  = in + clamp( i0 + i - position, 0, heightIn - 1 ) * width;
+    for ( int j = 0; j < width; j++ ) { s[j] += coef * src[j]; }
   }
-  for ( int i = 0; i < heightOut; i++ ) {
-    for ( int j = 0; j < widthIn; j++ ) {
-      chromaOut[i * widthOut + j * 2] =
-          upsamplingHorizontal0( g_filter420to444[filter], temp, widthIn, heightOut, i, j + 0 );
-      chromaOut[i * widthOut + j * 2 + 1] =
-          upsamplingHorizontal1( g_filter420to444[filter], temp, widthIn, heightOut, i, j + 1 );
-    }
+  for ( int j = 0; j < width; j++ ) { out[j] = ( s[j] + 0.f ) * scale; }
+}
+
+template <typename T>
+void PCCInternalColorConverter<T>::upsamplingHorizontal( const Filter&       filter,
+                                                         const float*        in,
+                                                         float*              out,
+                                                         const int           widthIn,
+                                                         const int           j0,
+                                                         std::vector<float>& sum ) const {
+  const int   taps     = (int)filter.data_.size();
+  const int   position = ( taps + 1 ) >> 1;
+  const float scale    = 1.0f / ( (float)( 1 << ( (int)filter.shift_ ) ) );
+  const int   jBegin   = ( std::min )( ( std::max )( position - j0, 0 ), widthIn );
+  const int   jEnd     = ( std::max )( jBegin, ( std::min )( widthIn, widthIn - taps + 1 + position - j0 ) );
+  float*      s        = sum.data();
+  for ( int j = 0; j < widthIn; j++ ) { s[j] = 0; }
+  for ( int i = 0; i < taps; i++ ) {
+    const float coef = filter.data_[i];
+    for ( int j = 0; j < jBegin; j++ ) { s[j] += coef * in[clamp( j + j0 + i - position, 0, widthIn - 1 )]; }
+    for ( int j = jBegin; j < jEnd; j++ ) { s[j] += coef * in[j + j0 + i - position]; }
+    for ( int j = jEnd; j < widthIn; j++ ) { s[j] += coef * in[clamp( j + j0 + i - position, 0, widthIn - 1 )]; }
   }
+  for ( int j = 0; j < widthIn; j++ ) { out[2 * j] = ( s[j] + 0.f ) * scale; }
 }
 
 template class pcc::PCCInternalColorConverter<uint8_t>;
@@ -0,0 +1,74 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PCCBitboardCanvas_h
+#define PCCBitboardCanvas_h
+
+#include "PCCCommon.h"
+
+namespace pcc {
+
+// Block occupancy of the canvas used by the patch packing, stored as rows of 64-bit words so that the collisions
+// of a patch are tested 64 blocks at a time. The same type holds the dilated masks of the patches. The occupied span
+// of each row is kept to skip the rows that a mask can not hit.
+class PCCBitboardCanvas {
+ public:
+  PCCBitboardCanvas() : width_( 0 ), height_( 0 ), stride_( 0 ) {}
+  ~PCCBitboardCanvas() = default;
+
+  // the content is kept as by std::vector<bool>::resize( width * height )
+  void   resize( const size_t width, const size_t height );
+  size_t getWidth() const { return width_; }
+  size_t getHeight() const { return height_; }
+  bool   get( const size_t x, const size_t y ) const {
+    return ( ( words_[y * stride_ + ( x >> 6 )] >> ( x & 63 ) ) & 1 ) != 0;
+  }
+  bool   operator[]( const size_t pos ) const { return get( pos % width_, pos / width_ ); }
+  void   set( const size_t pos ) { set( pos % width_, pos / width_ ); }
+  void   set( const size_t x, const size_t y ) { setRange( x, x, y ); }
+  void   setRange( const size_t x0, const size_t x1, const size_t y );
+
+  // tests if the mask placed at ( x, y ) overlaps an occupied block, the mask must fit in the canvas
+  bool intersects( const PCCBitboardCanvas& mask, const size_t x, const size_t y ) const;
+
+ private:
+  size_t                width_;
+  size_t                height_;
+  size_t                stride_;
+  std::vector<uint64_t> words_;
+  std::vector<uint32_t> rowMin_;
+  std::vector<uint32_t> rowMax_;
+};
+
+}  // namespace pcc
+
+#endif /* PCCBitboardCanvas_h */
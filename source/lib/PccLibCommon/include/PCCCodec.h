@@ -196,6 +196,7 @@ class PCCCodec {
 
   void generateRawPointsTexturefromVideo( PCCContext& context, PCCFrameContext& tile, size_t frameIndex );
 
+  // The raw points videos must hold the frames of the context: the frames can then be processed concurrently.
   void generateRawPointsGeometryfromVideo( PCCContext& context, size_t frameIndex );
   void generateRawPointsTexturefromVideo( PCCContext& context, size_t frameIndex );
 
@@ -348,7 +349,10 @@ class PCCCodec {
                              const std::vector<uint32_t>&        partition,
                              const GeneratePointCloudParameters& params,
                              uint16_t                            gridWidth,
-                             std::vector<int>&                   cellIndex );
+                             std::vector<int>&                   cellIndex,
+                             std::vector<uint16_t>&              gridCount,
+                             std::vector<PCCVector3<float>>&     center,
+                             std::vector<bool>&                  doSmooth );
 
   void addGridCentroid( PCCPoint3D&                     point,
                         uint32_t                        patchIdx,
@@ -378,6 +382,7 @@ class PCCCodec {
                            std::vector<uint16_t>&              colorGridCount,
                            std::vector<PCCVector3<float>>&     colorCenterGrid,
                            std::vector<bool>&                  colorDoSmooth,
+                           std::vector<std::vector<uint16_t>>& colorLum,
                            uint8_t                             gridSize,
                            PCCVector3D&                        curPosColor,
                            const GeneratePointCloudParameters& params,
@@ -385,7 +390,11 @@ class PCCCodec {
 
   void smoothPointCloudColorLC( PCCPointSet3&                       reconstruct,
                                 const GeneratePointCloudParameters& params,
-                                std::vector<int>&                   cellIndex );
+                                std::vector<int>&                   cellIndex,
+                                std::vector<uint16_t>&              colorGridCount,
+                                std::vector<PCCVector3<float>>&     colorCenter,
+                                std::vector<bool>&                  colorDoSmooth,
+                                std::vector<std::vector<uint16_t>>& colorLum );
 
   bool gridFiltering( const std::vector<uint32_t>&    partition,
                       PCCPointSet3&                   pointCloud,
@@ -424,15 +433,6 @@ class PCCCodec {
 #ifdef CODEC_TRACE
   void printChecksum( PCCPointSet3& ePointcloud, std::string eString );
 #endif
-  std::vector<uint16_t>                  geoSmoothingCount_;
-  std::vector<PCCVector3<float>>         geoSmoothingCenter_;
-  std::vector<bool>                      geoSmoothingDoSmooth_;
-  std::vector<uint32_t>                  geoSmoothingPartition_;
-  std::vector<uint16_t>                  colorSmoothingCount_;
-  std::vector<PCCVector3<float>>         colorSmoothingCenter_;
-  std::vector<bool>                      colorSmoothingDoSmooth_;
-  std::vector<std::pair<size_t, size_t>> colorSmoothingPartition_;
-  std::vector<std::vector<uint16_t>>     colorSmoothingLum_;
 };
 
 };  // namespace pcc
@@ -0,0 +1,18 @@
+#define TMC2_VERSION_MAJOR 12
+#define TMC2_VERSION_MINOR 0
+
+/* Define to 1 if getrusage(2) is present */
+#define HAVE_GETRUSAGE 1
+
+/* #undef ENABLE_PAPI_PROFILING */
+
+/* #undef USE_JMAPP_VIDEO_CODEC */
+/* #undef USE_HMAPP_VIDEO_CODEC */
+/* #undef USE_HMLIB_VIDEO_CODEC */
+/* #undef USE_FFMPEG_VIDEO_CODEC */
+
+/* #undef USE_HDRTOOLS */
+
+/* #undef USE_VOXEL_HASH_NEIGHBOR_SEARCH */
+
+
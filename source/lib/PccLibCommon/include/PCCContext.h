@@ -56,6 +56,13 @@ typedef std::pair<size_t, size_t>                  GlobalPatch;    // [FrameInde
 typedef std::map<size_t, std::vector<GlobalPatch>> GlobalPatches;  // [TrackIndex, <GlobalPatch>]
 typedef std::pair<size_t, size_t>                  SubContext;     // [start, end)
 
+// Digest of a byte string of the decoded atlas information hash SEI: only the field of its hash type is set.
+struct PCCSeiHashDigest {
+  std::vector<uint8_t> md5_;
+  uint16_t             crc_      = 0;
+  uint32_t             checkSum_ = 0;
+};
+
 class PCCAtlasContext {
  public:
   PCCAtlasContext();
@@ -197,6 +204,7 @@ class PCCContext : public PCCHighLevelSyntax {
   std::vector<uint8_t> computeMD5( uint8_t* byteString, size_t size );
   uint16_t             computeCRC( uint8_t* byteString, size_t size );
   uint32_t             computeCheckSum( uint8_t* byteString, size_t size );
+  void                 computeHash( std::vector<uint8_t>& byteString, size_t hashType, PCCSeiHashDigest& digest );
 
  private:
   PCCVector3<float>            modelOrigin_;
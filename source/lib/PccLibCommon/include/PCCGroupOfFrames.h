@@ -68,6 +68,11 @@ class PCCGroupOfFrames {
 
   bool write( const std::string& reconstructedDataPath, size_t& frameNumber, const size_t nbThread = 1 );
 
+  // Starts the background read of the files of the frames [startFrameNumber, endFrameNumber) by the system.
+  static void prefetch( const std::string& uncompressedDataPath,
+                        const size_t       startFrameNumber,
+                        const size_t       endFrameNumber );
+
  private:
   std::vector<PCCPointSet3> frames_;
 };
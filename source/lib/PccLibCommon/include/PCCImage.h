@@ -42,8 +42,10 @@ template <typename T, size_t N>
 class PCCImage {
  public:
   PCCImage() : width_( 0 ), height_( 0 ), format_( PCCCOLORFORMAT::UNKNOWN ), deprecatedColorFormat_( 0 ) {}
-  PCCImage( const PCCImage& ) = default;
+  PCCImage( const PCCImage& )                = default;
+  PCCImage( PCCImage&& )                     = default;
   PCCImage& operator=( const PCCImage& rhs ) = default;
+  PCCImage& operator=( PCCImage&& rhs )      = default;
   ~PCCImage()                                = default;
   std::vector<T>& operator[]( int index ) { return channels_[index]; }
 
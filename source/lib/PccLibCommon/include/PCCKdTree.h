@@ -35,6 +35,7 @@
 
 #include "PCCCommon.h"
 #include "PCCPointSet.h"
+#include <mutex>
 
 namespace pcc {
 
@@ -99,5 +100,33 @@ class PCCKdTree {
   void* kdtree_;
 };
 
+// Kd-trees of the point sets shared between the stages that search the same point set (segmentation, 3D
+// padding, color transfer, metrics...). A kd-tree is identified by the address of its point set and is built
+// again when the point count or the checksum of the positions of the point set have changed since it was built,
+// so that the positions changed in any way, including in place through operator[] or getPositions(), are seen.
+class PCCKdTreeCache {
+ public:
+  PCCKdTreeCache()                        = default;
+  PCCKdTreeCache( const PCCKdTreeCache& ) = delete;
+  PCCKdTreeCache& operator=( const PCCKdTreeCache& ) = delete;
+  ~PCCKdTreeCache()                                  = default;
+
+  std::shared_ptr<const PCCKdTree> get( const PCCPointSet3& pointCloud );
+  void                             release( const PCCPointSet3& pointCloud );
+  void                             clear();
+
+ private:
+  struct Entry {
+    size_t                           pointCount_;
+    uint64_t                         checksum_;
+    std::shared_ptr<const PCCKdTree> kdtree_;
+  };
+  std::map<const PCCPointSet3*, Entry> entries_;
+  std::mutex                           mutex_;
+};
+
+// Returns the kd-tree of the point set from the cache or builds a new one when there is no cache.
+std::shared_ptr<const PCCKdTree> getKdTree( PCCKdTreeCache* kdTreeCache, const PCCPointSet3& pointCloud );
+
 }  // namespace pcc
 #endif /* PCCKdTree_h */
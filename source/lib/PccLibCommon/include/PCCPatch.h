@@ -36,6 +36,7 @@
 
 #include "PCCCommon.h"
 #include "PCCPointSet.h"
+#include "PCCBitboardCanvas.h"
 
 namespace pcc {
 
@@ -80,6 +81,17 @@ static const std::vector<uint8_t> g_orientation = {
     0, 0, 2, 0, 0, 0, 0, 0, 0, 0, 3, 3, 0, 3, 0, 0, 0, 4, 1, 0, 0, 0, 1, 0, 1, 0, 2, 3, 0, 0, 1, 2, 0, 0};
 static const int8_t g_dilate[8][2] = {{1, 0}, {1, 1}, {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}, {0, -1}, {1, -1}};
 
+// Dilated occupancy of a patch in one orientation, as tested against the packing canvas.
+struct PCCPatchCanvasMask {
+  size_t            sizeU0_;
+  size_t            sizeV0_;
+  size_t            occupancyStride_;
+  size_t            orientation_;
+  int               safeguard_;
+  bool              precedence_;
+  PCCBitboardCanvas mask_;
+};
+
 class PCCPatch {
  public:
   PCCPatch() :
@@ -176,7 +188,10 @@ class PCCPatch {
   size_t&                     getTangentAxis() { return tangentAxis_; }
   size_t&                     getBitangentAxis() { return bitangentAxis_; }
   std::vector<int16_t>&       getDepth( int i ) { return depth_[i]; }
-  std::vector<bool>&          getOccupancy() { return occupancy_; }
+  std::vector<bool>&          getOccupancy() {
+    canvasMasks_.clear();
+    return occupancy_;
+  }
   size_t                      getLodScaleX() { return levelOfDetailX_; }
   size_t                      getLodScaleY() { return levelOfDetailY_; }
   size_t                      getLodScaleX() const { return levelOfDetailX_; }
@@ -212,6 +227,7 @@ class PCCPatch {
   std::vector<int64_t>&       getDepth0PccIdx() { return depth0PCidx_; }
   bool&                       getIsRoiPatch() { return isRoiPatch_; }
   size_t&                     getRoiIndex() { return roiIndex_; }
+  size_t                      getRoiIndex() const { return roiIndex_; }
   size_t&                     getPatchOrientation() { return patchOrientation_; }
   size_t                      getPatchOrientation() const { return patchOrientation_; }
   bool&                       getIsGlobalPatch() { return isGlobalPatch_; }
@@ -550,31 +566,14 @@ class PCCPatch {
     return int( x + canvasStrideBlk * y );
   }
 
-  bool checkFitPatchCanvas( std::vector<bool> canvas,
-                            size_t            canvasStrideBlk,
-                            size_t            canvasHeightBlk,
-                            bool              bPrecedence,
-                            int               safeguard = 0,
-                            const Tile        tile      = Tile() ) {
-    for ( size_t v0 = 0; v0 < getSizeV0(); ++v0 ) {
-      for ( size_t u0 = 0; u0 < getSizeU0(); ++u0 ) {
-        for ( int deltaY = -safeguard; deltaY < safeguard + 1; deltaY++ ) {
-          for ( int deltaX = -safeguard; deltaX < safeguard + 1; deltaX++ ) {
-            int pos = patchBlock2CanvasBlock( u0 + deltaX, v0 + deltaY, canvasStrideBlk, canvasHeightBlk, tile );
-            if ( pos < 0 ) {
-              return false;
-            } else {
-              if ( bPrecedence ) {
-                if ( canvas[pos] && occupancy_[u0 + getSizeU0() * v0] ) { return false; }
-              } else {
-                if ( canvas[pos] ) { return false; }
-              }
-            }
-          }
-        }
-      }
-    }
-    return true;
+  bool checkFitPatchCanvas( const PCCBitboardCanvas& canvas,
+                            size_t                   canvasStrideBlk,
+                            size_t                   canvasHeightBlk,
+                            bool                     bPrecedence,
+                            int                      safeguard = 0,
+                            const Tile               tile      = Tile() ) const {
+    return checkFitPatchCanvas( canvas, canvasStrideBlk, canvasHeightBlk, bPrecedence, safeguard, tile, u0_, v0_,
+                                sizeU0_, sizeV0_, patchOrientation_ );
   }
 
   bool smallerRefFirst( const PCCPatch& rhs ) {
@@ -938,31 +937,14 @@ class PCCPatch {
     return int( x + canvasStrideBlk * y );
   }
 
-  bool checkFitPatchCanvasForGPA( std::vector<bool> canvas,
-                                  size_t            canvasStrideBlk,
-                                  size_t            canvasHeightBlk,
-                                  bool              bPrecedence,
-                                  int               safeguard = 0 ) {
-    for ( size_t v0 = 0; v0 < curGPAPatchData_.sizeV0; ++v0 ) {
-      for ( size_t u0 = 0; u0 < curGPAPatchData_.sizeU0; ++u0 ) {
-        for ( int deltaY = -safeguard; deltaY < safeguard + 1; deltaY++ ) {
-          for ( int deltaX = -safeguard; deltaX < safeguard + 1; deltaX++ ) {
-            int pos = patchBlock2CanvasBlockForGPA( u0 + deltaX, v0 + deltaY, canvasStrideBlk, canvasHeightBlk );
-            if ( pos < 0 ) {
-              return false;
-            } else {
-              if ( bPrecedence ) {
-                if ( canvas[pos] && occupancy_[u0 + getSizeU0() * v0] ) { return false; }
-              } else {
-                if ( canvas[pos] ) { return false; }
-              }
-            }
-          }
-        }
-      }
-    }
-
-    return true;
+  bool checkFitPatchCanvasForGPA( const PCCBitboardCanvas& canvas,
+                                  size_t                   canvasStrideBlk,
+                                  size_t                   canvasHeightBlk,
+                                  bool                     bPrecedence,
+                                  int                      safeguard = 0 ) const {
+    return checkFitPatchCanvas( canvas, canvasStrideBlk, canvasHeightBlk, bPrecedence, safeguard, Tile(),
+                                curGPAPatchData_.u0, curGPAPatchData_.v0, curGPAPatchData_.sizeU0,
+                                curGPAPatchData_.sizeV0, curGPAPatchData_.patchOrientation );
   }
 
   void allocOneLayerData() {
@@ -1316,6 +1298,114 @@ class PCCPatch {
   }
 
  private:
+  // The blocks of the patch dilated by safeguard must lie in the canvas and in the tile. With bPrecedence, the
+  // dilated occupied blocks must be free in the canvas, otherwise the whole dilated rectangle must be free.
+  bool checkFitPatchCanvas( const PCCBitboardCanvas& canvas,
+                            size_t                   canvasStrideBlk,
+                            size_t                   canvasHeightBlk,
+                            bool                     bPrecedence,
+                            int                      safeguard,
+                            const Tile&              tile,
+                            size_t                   u0,
+                            size_t                   v0,
+                            size_t                   sizeU0,
+                            size_t                   sizeV0,
+                            size_t                   orientation ) const {
+    if ( sizeU0 == 0 || sizeV0 == 0 ) { return true; }
+    if ( orientation > PATCH_ORIENTATION_MROT270 ) { return false; }
+    const bool   switched = isOrientationSwitched( orientation );
+    const size_t border   = size_t( safeguard );
+    const size_t width    = ( switched ? sizeV0 : sizeU0 ) + 2 * border;
+    const size_t height   = ( switched ? sizeU0 : sizeV0 ) + 2 * border;
+    if ( u0 < border || v0 < border ) { return false; }
+    const size_t x = u0 - border;
+    const size_t y = v0 - border;
+    if ( x + width > ( std::min )( canvasStrideBlk, canvas.getWidth() ) ||
+         y + height > ( std::min )( canvasHeightBlk, canvas.getHeight() ) ) {
+      return false;
+    }
+    if ( tile.minU != -1 && ( x < size_t( tile.minU ) || y < size_t( tile.minV ) ||
+                              x + width - 1 > size_t( tile.maxU ) || y + height - 1 > size_t( tile.maxV ) ) ) {
+      return false;
+    }
+    return !canvas.intersects( getCanvasMask( sizeU0, sizeV0, orientation, safeguard, bPrecedence ), x, y );
+  }
+
+  static bool isOrientationSwitched( size_t orientation ) {
+    return orientation != PATCH_ORIENTATION_DEFAULT && orientation != PATCH_ORIENTATION_ROT180 &&
+           orientation != PATCH_ORIENTATION_MIRROR && orientation != PATCH_ORIENTATION_MROT180;
+  }
+
+  // the masks are computed once per orientation and kept until the occupancy is accessed for writing
+  const PCCBitboardCanvas& getCanvasMask( size_t sizeU0,
+                                          size_t sizeV0,
+                                          size_t orientation,
+                                          int    safeguard,
+                                          bool   bPrecedence ) const {
+    for ( const auto& canvasMask : canvasMasks_ ) {
+      if ( canvasMask.sizeU0_ == sizeU0 && canvasMask.sizeV0_ == sizeV0 && canvasMask.occupancyStride_ == sizeU0_ &&
+           canvasMask.orientation_ == orientation && canvasMask.safeguard_ == safeguard &&
+           canvasMask.precedence_ == bPrecedence ) {
+        return canvasMask.mask_;
+      }
+    }
+    PCCPatchCanvasMask canvasMask;
+    canvasMask.sizeU0_          = sizeU0;
+    canvasMask.sizeV0_          = sizeV0;
+    canvasMask.occupancyStride_ = sizeU0_;
+    canvasMask.orientation_     = orientation;
+    canvasMask.safeguard_       = safeguard;
+    canvasMask.precedence_      = bPrecedence;
+    const bool   switched       = isOrientationSwitched( orientation );
+    const size_t border         = 2 * size_t( safeguard );
+    auto&        mask           = canvasMask.mask_;
+    mask.resize( ( switched ? sizeV0 : sizeU0 ) + border, ( switched ? sizeU0 : sizeV0 ) + border );
+    for ( size_t v = 0; v < sizeV0; ++v ) {
+      for ( size_t u = 0; u < sizeU0; ++u ) {
+        const size_t p = u + sizeU0_ * v;
+        if ( bPrecedence && ( p >= occupancy_.size() || !occupancy_[p] ) ) { continue; }
+        size_t x, y;
+        switch ( orientation ) {
+          case PATCH_ORIENTATION_DEFAULT:
+            x = u;
+            y = v;
+            break;
+          case PATCH_ORIENTATION_ROT90:
+            x = sizeV0 - 1 - v;
+            y = u;
+            break;
+          case PATCH_ORIENTATION_ROT180:
+            x = sizeU0 - 1 - u;
+            y = sizeV0 - 1 - v;
+            break;
+          case PATCH_ORIENTATION_ROT270:
+            x = v;
+            y = sizeU0 - 1 - u;
+            break;
+          case PATCH_ORIENTATION_MIRROR:
+            x = sizeU0 - 1 - u;
+            y = v;
+            break;
+          case PATCH_ORIENTATION_MROT90:
+            x = sizeV0 - 1 - v;
+            y = sizeU0 - 1 - u;
+            break;
+          case PATCH_ORIENTATION_MROT180:
+            x = u;
+            y = sizeV0 - 1 - v;
+            break;
+          default:  // PATCH_ORIENTATION_MROT270 and PATCH_ORIENTATION_SWAP
+            x = v;
+            y = u;
+            break;
+        }
+        for ( size_t dy = 0; dy <= border; dy++ ) { mask.setRange( x, x + border, y + dy ); }
+      }
+    }
+    canvasMasks_.push_back( canvasMask );
+    return canvasMasks_.back().mask_;
+  }
+
   size_t index_;          // patch index
   size_t originalIndex_;  // patch original index
   size_t frameIndex_;
@@ -1373,6 +1463,8 @@ class PCCPatch {
   std::vector<uint8_t>    occupancyMap_;        // Occupancy map
   std::vector<PCCPoint3D> borderPoints_;        // 3D points created from borders of
                                                 // the patch
+
+  mutable std::vector<PCCPatchCanvasMask> canvasMasks_;  // dilated occupancy tested by the packing
 };
 
 class PatchBlockFiltering {
@@ -39,12 +39,16 @@
 
 namespace pcc {
 
+class PCCKdTreeCache;
+
 class PCCPointSet3 {
  public:
   PCCPointSet3() : withNormals_( false ), withColors_( false ), withReflectances_( false ) {}
   PCCPointSet3( const PCCPointSet3& ) = default;
+  PCCPointSet3( PCCPointSet3&& )      = default;
   PCCPointSet3& operator=( const PCCPointSet3& rhs ) = default;
-  ~PCCPointSet3()                                    = default;
+  PCCPointSet3& operator=( PCCPointSet3&& rhs ) = default;
+  ~PCCPointSet3()                               = default;
 
   PCCPoint3D operator[]( const size_t index ) const {
     assert( index < positions_.size() );
@@ -55,14 +59,14 @@ class PCCPointSet3 {
     return positions_[index];
   }
   size_t appendPointSet( PCCPointSet3& pointSet ) {
-    std::vector<PCCPoint3D>::iterator                itPositions;
-    std::vector<PCCColor3B>::iterator                itColors;
-    std::vector<PCCColor16bit>::iterator             itColors16bit;
-    std::vector<uint16_t>::iterator                  itReflectances;
-    std::vector<uint16_t>::iterator                  itBoundaryPointTypes;
-    std::vector<std::pair<size_t, size_t>>::iterator itPointPatchIndexes;
-    std::vector<uint8_t>::iterator                   itTypes;
-    std::vector<PCCNormal3D>::iterator               itNormals;
+    std::vector<PCCPoint3D>::iterator                    itPositions;
+    std::vector<PCCColor3B>::iterator                    itColors;
+    std::vector<PCCColor16bit>::iterator                 itColors16bit;
+    std::vector<uint16_t>::iterator                      itReflectances;
+    std::vector<uint16_t>::iterator                      itBoundaryPointTypes;
+    std::vector<std::pair<uint32_t, uint32_t>>::iterator itPointPatchIndexes;
+    std::vector<uint8_t>::iterator                       itTypes;
+    std::vector<PCCNormal3D>::iterator                   itNormals;
 
     itPositions          = positions_.end();
     itColors             = colors_.end();
@@ -174,12 +178,12 @@ class PCCPointSet3 {
     assert( index < boundaryPointTypes_.size() );
     boundaryPointTypes_[index] = BoundaryPointType;
   }
-  std::vector<std::pair<size_t, size_t>>& getPointPatchIndexes() { return pointPatchIndexes_; }
-  std::pair<size_t, size_t>               getPointPatchIndex( const size_t index ) const {
+  std::vector<std::pair<uint32_t, uint32_t>>& getPointPatchIndexes() { return pointPatchIndexes_; }
+  std::pair<uint32_t, uint32_t>               getPointPatchIndex( const size_t index ) const {
     assert( index < pointPatchIndexes_.size() );
     return pointPatchIndexes_[index];
   }
-  std::pair<size_t, size_t>& getPointPatchIndex( const size_t index ) {
+  std::pair<uint32_t, uint32_t>& getPointPatchIndex( const size_t index ) {
     assert( index < pointPatchIndexes_.size() );
     return pointPatchIndexes_[index];
   }
@@ -188,10 +192,16 @@ class PCCPointSet3 {
     pointPatchIndexes_[index].first  = tileIndex;
     pointPatchIndexes_[index].second = patchIndex;
   }
+  // The parent point indexes are only used by the intermediate point sets of the color transfers: they are
+  // allocated on first use and then follow the size of the point set.
   std::vector<uint64_t>& getParentPointIndex() { return parentPointIndex_; }
-  uint64_t&              getParentPointIndex( const size_t index ) { return parentPointIndex_[index]; }
-  void                   setParentPointIndex( const size_t index, const uint64_t parentIndex ) {
+  uint64_t&              getParentPointIndex( const size_t index ) {
     assert( index < parentPointIndex_.size() );
+    return parentPointIndex_[index];
+  }
+  void setParentPointIndex( const size_t index, const uint64_t parentIndex ) {
+    assert( index < getPointCount() );
+    if ( parentPointIndex_.size() != getPointCount() ) { parentPointIndex_.resize( getPointCount() ); }
     parentPointIndex_[index] = parentIndex;
   }
   uint16_t getReflectance( const size_t index ) const {
@@ -266,23 +276,24 @@ class PCCPointSet3 {
     normals_[idx] = value;
   }
 
-  bool transferColors( PCCPointSet3& target,
-                       const int32_t searchRange,
-                       const bool    losslessTexture                         = false,
-                       const int     numNeighborsColorTransferFwd            = 1,
-                       const int     numNeighborsColorTransferBwd            = 1,
-                       const bool    useDistWeightedAverageFwd               = true,
-                       const bool    useDistWeightedAverageBwd               = true,
-                       const bool    skipAvgIfIdenticalSourcePointPresentFwd = true,
-                       const bool    skipAvgIfIdenticalSourcePointPresentBwd = true,
-                       const double  distOffsetFwd                           = 0.0001,
-                       const double  distOffsetBwd                           = 0.0001,
-                       double        maxGeometryDist2Fwd                     = 10000.0,
-                       double        maxGeometryDist2Bwd                     = 10000.0,
-                       double        maxColorDist2Fwd                        = 10000.0,
-                       double        maxColorDist2Bwd                        = 10000.0,
-                       const bool    excludeColorOutlier                     = false,
-                       const double  thresholdColorOutlierDist               = 10.0 ) const;
+  bool transferColors( PCCPointSet3&   target,
+                       const int32_t   searchRange,
+                       const bool      losslessTexture                         = false,
+                       const int       numNeighborsColorTransferFwd            = 1,
+                       const int       numNeighborsColorTransferBwd            = 1,
+                       const bool      useDistWeightedAverageFwd               = true,
+                       const bool      useDistWeightedAverageBwd               = true,
+                       const bool      skipAvgIfIdenticalSourcePointPresentFwd = true,
+                       const bool      skipAvgIfIdenticalSourcePointPresentBwd = true,
+                       const double    distOffsetFwd                           = 0.0001,
+                       const double    distOffsetBwd                           = 0.0001,
+                       double          maxGeometryDist2Fwd                     = 10000.0,
+                       double          maxGeometryDist2Bwd                     = 10000.0,
+                       double          maxColorDist2Fwd                        = 10000.0,
+                       double          maxColorDist2Bwd                        = 10000.0,
+                       const bool      excludeColorOutlier                     = false,
+                       const double    thresholdColorOutlierDist               = 10.0,
+                       PCCKdTreeCache* kdTreeCache                             = nullptr ) const;
 
   bool transferColors16bitBP( PCCPointSet3& target,
                               const int     filterType,
@@ -357,7 +368,7 @@ class PCCPointSet3 {
     if ( hasNormals() ) { normals_.resize( size ); }
     boundaryPointTypes_.resize( size );
     pointPatchIndexes_.resize( size );
-    parentPointIndex_.resize( size );
+    if ( !parentPointIndex_.empty() ) { parentPointIndex_.resize( size ); }
   }
   void reserve( const size_t size ) {
     positions_.reserve( size );
@@ -369,7 +380,6 @@ class PCCPointSet3 {
     if ( PCC_SAVE_POINT_TYPE ) { types_.reserve( size ); }
     boundaryPointTypes_.reserve( size );
     pointPatchIndexes_.reserve( size );
-    parentPointIndex_.reserve( size );
   }
   void clear() {
     positions_.clear();
@@ -476,8 +486,8 @@ class PCCPointSet3 {
 
   void                 removeDuplicate( PCCPointSet3& newPointcloud, size_t dropDuplicates ) const;
   void                 copyNormals( const PCCPointSet3& sourceWithNormal );
-  void                 scaleNormals( const PCCPointSet3& sourceWithNormal );
-  std::vector<uint8_t> computeChecksum( bool reorderPoints = false );
+  void                 scaleNormals( const PCCPointSet3& sourceWithNormal, PCCKdTreeCache* kdTreeCache = nullptr );
+  std::vector<uint8_t> computeChecksum( bool reorderPoints = false, bool fastDigest = false );
   void                 sortColor( std::vector<size_t>& list );
   void                 reorder();
   void                 reorder( PCCPointSet3& newPointcloud, bool dropDuplicates );
@@ -494,22 +504,20 @@ class PCCPointSet3 {
                  float&              distVAB,
                  float&              distVBA ) const;
   void distance( const PCCPointSet3& pointcloud, float& distPAB, float& distPBA ) const;
-  void distance( const PCCPointSet3& pointcloud, float& distP, float& distY, float& distU, float& distV ) const;
   void distance( const PCCPointSet3& pointcloud, float& distP ) const;
-  std::vector<uint8_t> computeMd5();
 
-  std::vector<PCCPoint3D>                positions_;
-  std::vector<PCCColor3B>                colors_;
-  std::vector<PCCColor16bit>             colors16bit_;
-  std::vector<uint16_t>                  reflectances_;
-  std::vector<uint16_t>                  boundaryPointTypes_;
-  std::vector<std::pair<size_t, size_t>> pointPatchIndexes_;
-  std::vector<uint64_t>                  parentPointIndex_;
-  std::vector<uint8_t>                   types_;
-  std::vector<PCCNormal3D>               normals_;
-  bool                                   withNormals_;
-  bool                                   withColors_;
-  bool                                   withReflectances_;
+  std::vector<PCCPoint3D>                    positions_;
+  std::vector<PCCColor3B>                    colors_;
+  std::vector<PCCColor16bit>                 colors16bit_;
+  std::vector<uint16_t>                      reflectances_;
+  std::vector<uint16_t>                      boundaryPointTypes_;
+  std::vector<std::pair<uint32_t, uint32_t>> pointPatchIndexes_;
+  std::vector<uint64_t>                      parentPointIndex_;
+  std::vector<uint8_t>                       types_;
+  std::vector<PCCNormal3D>                   normals_;
+  bool                                       withNormals_;
+  bool                                       withColors_;
+  bool                                       withReflectances_;
 };
 }  // namespace pcc
 
@@ -0,0 +1,116 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PCCPointSetComponents_h
+#define PCCPointSetComponents_h
+
+#include "PCCCommon.h"
+#include "PCCPointSet.h"
+
+namespace pcc {
+
+// Allocator of the arrays of the components: the arrays start on a cache line, so that the vectorised loops over
+// them do not split their loads. The address of the allocated block is stored just before the array.
+template <typename T, size_t Alignment = 64>
+class PCCAlignedAllocator {
+ public:
+  typedef T value_type;
+  template <typename U>
+  struct rebind {
+    typedef PCCAlignedAllocator<U, Alignment> other;
+  };
+  PCCAlignedAllocator() = default;
+  template <typename U>
+  PCCAlignedAllocator( const PCCAlignedAllocator<U, Alignment>& ) {}
+
+  T* allocate( const size_t count ) {
+    char*        block  = static_cast<char*>( ::operator new( count * sizeof( T ) + Alignment + sizeof( void* ) ) );
+    const size_t offset = reinterpret_cast<uintptr_t>( block + sizeof( void* ) ) % Alignment;
+    char*        array  = block + sizeof( void* ) + ( offset == 0 ? 0 : Alignment - offset );
+    reinterpret_cast<void**>( array )[-1] = block;
+    return reinterpret_cast<T*>( array );
+  }
+  void deallocate( T* array, const size_t ) { ::operator delete( reinterpret_cast<void**>( array )[-1] ); }
+
+  template <typename U>
+  bool operator==( const PCCAlignedAllocator<U, Alignment>& ) const {
+    return true;
+  }
+  template <typename U>
+  bool operator!=( const PCCAlignedAllocator<U, Alignment>& ) const {
+    return false;
+  }
+};
+
+template <typename T>
+using PCCAlignedVector = std::vector<T, PCCAlignedAllocator<T>>;
+
+// Structure of arrays storage of the positions and of the colors of a point set: each coordinate and each color
+// channel has its own aligned array, so that the loops over one component of all the points (bounding box and
+// splits of the kd-trees, color conversions) are vectorised. The colors are only allocated when they are
+// requested and the point set has colors. PCCPointSet3 keeps the interleaved storage used by the rest of the
+// codec; the components are a copy made by the stages that scan the points component by component.
+class PCCPointSetComponents {
+ public:
+  PCCPointSetComponents() = default;
+  PCCPointSetComponents( const PCCPointSet3& pointSet, const bool withColors = false ) { init( pointSet, withColors ); }
+  ~PCCPointSetComponents() = default;
+
+  void init( const PCCPointSet3& pointSet, const bool withColors = false );
+  void clear();
+
+  size_t         getPointCount() const { return positions_[0].size(); }
+  bool           hasColors() const { return !colors_[0].empty(); }
+  const PCCType* getPositions( const size_t dimension ) const { return positions_[dimension].data(); }
+  const uint8_t* getColors( const size_t channel ) const { return colors_[channel].data(); }
+  PCCType        getPosition( const size_t index, const size_t dimension ) const {
+    return positions_[dimension][index];
+  }
+  PCCPoint3D getPosition( const size_t index ) const {
+    return PCCPoint3D( positions_[0][index], positions_[1][index], positions_[2][index] );
+  }
+  PCCColor3B getColor( const size_t index ) const {
+    assert( hasColors() );
+    return PCCColor3B( colors_[0][index], colors_[1][index], colors_[2][index] );
+  }
+
+  // Smallest and largest coordinates of the points.
+  void computeBoundingBox( PCCPoint3D& min, PCCPoint3D& max ) const;
+
+ private:
+  PCCAlignedVector<PCCType> positions_[3];
+  PCCAlignedVector<uint8_t> colors_[3];
+};
+
+}  // namespace pcc
+
+#endif /* PCCPointSetComponents_h */
@@ -48,6 +48,34 @@ int system( const char* command ) noexcept;
 #else
 static inline int system( const char* command ) { return ::system( command ); }
 #endif
+
+/**
+ * Read-only view of a whole file: the file is memory mapped when the
+ * platform allows it, otherwise it is read in a buffer.
+ */
+class PCCMappedFile {
+ public:
+  PCCMappedFile( const std::string& fileName );
+  ~PCCMappedFile();
+
+  bool           isOpen() const { return data_ != nullptr; }
+  const uint8_t* data() const { return data_; }
+  size_t         size() const { return size_; }
+
+ private:
+  PCCMappedFile( const PCCMappedFile& ) = delete;
+  PCCMappedFile& operator=( const PCCMappedFile& ) = delete;
+
+  const uint8_t*       data_;
+  size_t               size_;
+  std::vector<uint8_t> buffer_;
+};
+
+/**
+ * Asks the operating system to read a file ahead in the background, so that
+ * a later read finds it in the page cache. Does nothing when not supported.
+ */
+void prefetchFile( const std::string& fileName );
 }  // namespace pcc
 
 //===========================================================================
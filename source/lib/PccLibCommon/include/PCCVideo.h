@@ -67,6 +67,7 @@ class PCCVideo {
     for ( auto& f : frames_ ) f.setDeprecatedColorFormat( value );
   }
   void resize( const size_t frameCount ) { frames_.resize( frameCount ); }
+  void reserve( const size_t frameCount ) { frames_.reserve( frameCount ); }
 
   typename std::vector<PCCImage<T, N> >::iterator begin() { return frames_.begin(); }
   typename std::vector<PCCImage<T, N> >::iterator end() { return frames_.end(); }
@@ -0,0 +1,102 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PCCVoxelHash_h
+#define PCCVoxelHash_h
+
+#include "PCCCommon.h"
+#include "PCCPointSet.h"
+
+namespace pcc {
+
+class PCCNNResult;
+
+// Nearest neighbor searches in the point clouds with integer coordinates: the points are sorted by cubic cells
+// of 2^shift_ voxels indexed by an open addressing hash table, and the queries visit the cells ring by ring
+// around the cell of the query point until no closer point can be found. When the rings grow too large (query
+// far from the points), the remaining cells are visited by increasing distance of the coarse blocks of 8x8x8
+// cells that hold them. The squared distances are computed with integers and the
+// neighbors of the same distance are ordered by point index.
+class PCCVoxelHash {
+ public:
+  PCCVoxelHash() : shift_( 0 ), mask_( 0 ) {}
+  PCCVoxelHash( const PCCPointSet3& pointCloud ) : shift_( 0 ), mask_( 0 ) { init( pointCloud ); }
+  ~PCCVoxelHash() = default;
+
+  void init( const PCCPointSet3& pointCloud );
+  void search( const PCCPoint3D& point, const size_t num_results, PCCNNResult& results ) const;
+  void searchRadius( const PCCPoint3D& point,
+                     const size_t      num_results,
+                     const double      radius,
+                     PCCNNResult&      results ) const;
+
+ private:
+  struct Cell {
+    PCCVector3<int32_t> index_;
+    uint32_t            begin_;
+    uint32_t            end_;
+  };
+  static uint64_t getKey( const int32_t x, const int32_t y, const int32_t z ) {
+    return ( uint64_t( x ) << 32 ) | ( uint64_t( y ) << 16 ) | uint64_t( z );
+  }
+  PCCVector3<int32_t> getCellIndex( const PCCPoint3D& point ) const;
+  const Cell*         findCell( const int32_t x, const int32_t y, const int32_t z ) const;
+  int64_t getDistance2( const PCCVector3<int32_t>& index, const size_t shift, const PCCPoint3D& point ) const;
+  int32_t             getRing( const Cell& cell, const PCCVector3<int32_t>& index ) const;
+  int32_t             getFirstRing( const PCCVector3<int32_t>& index ) const;
+  int32_t             getRingCount( const PCCVector3<int32_t>& index ) const;
+  size_t              getRingCellCount( const PCCVector3<int32_t>& index, const int32_t ring ) const;
+  bool                useRing( const PCCVector3<int32_t>& index, const int32_t ring, size_t& budget ) const;
+  template <typename F>
+  void visitRing( const PCCVector3<int32_t>& index, const int32_t ring, F&& visit ) const;
+  template <typename F>
+  void visitFarCells( const PCCPoint3D&          point,
+                      const PCCVector3<int32_t>& index,
+                      const int32_t              ring,
+                      int64_t&                   maxDist2,
+                      F&&                        visit ) const;
+
+  size_t                  shift_;
+  size_t                  mask_;
+  PCCVector3<int32_t>     minCell_;
+  PCCVector3<int32_t>     maxCell_;
+  std::vector<Cell>       cells_;
+  std::vector<Cell>       blocks_;
+  std::vector<uint32_t>   blockCells_;
+  std::vector<uint32_t>   table_;
+  std::vector<uint32_t>   indices_;
+  std::vector<PCCPoint3D> positions_;
+};
+
+}  // namespace pcc
+
+#endif /* PCCVoxelHash_h */
@@ -0,0 +1,92 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "PCCCommon.h"
+
+#include "PCCBitboardCanvas.h"
+
+using namespace pcc;
+
+static const uint32_t g_emptyRowMin = ( std::numeric_limits<uint32_t>::max )();
+
+void PCCBitboardCanvas::resize( const size_t width, const size_t height ) {
+  if ( width == width_ || height_ == 0 ) {
+    width_  = width;
+    height_ = height;
+    stride_ = ( width + 63 ) >> 6;
+    words_.resize( stride_ * height, 0 );
+    rowMin_.resize( height, g_emptyRowMin );
+    rowMax_.resize( height, 0 );
+    return;
+  }
+  // the blocks keep their raster scan position
+  PCCBitboardCanvas canvas;
+  canvas.resize( width, height );
+  const size_t count = ( std::min )( width_ * height_, width * height );
+  for ( size_t pos = 0; pos < count; pos++ ) {
+    if ( ( *this )[pos] ) { canvas.set( pos ); }
+  }
+  std::swap( *this, canvas );
+}
+
+void PCCBitboardCanvas::setRange( const size_t x0, const size_t x1, const size_t y ) {
+  uint64_t* row = words_.data() + y * stride_;
+  for ( size_t w = x0 >> 6; w <= ( x1 >> 6 ); w++ ) {
+    const size_t first = ( std::max )( x0, w << 6 ) & 63;
+    const size_t last  = ( std::min )( x1, ( w << 6 ) + 63 ) & 63;
+    row[w] |= ( ~uint64_t( 0 ) >> ( 63 - last ) ) & ( ~uint64_t( 0 ) << first );
+  }
+  rowMin_[y] = ( std::min )( rowMin_[y], uint32_t( x0 ) );
+  rowMax_[y] = ( std::max )( rowMax_[y], uint32_t( x1 ) );
+}
+
+bool PCCBitboardCanvas::intersects( const PCCBitboardCanvas& mask, const size_t x, const size_t y ) const {
+  assert( x + mask.width_ <= width_ && y + mask.height_ <= height_ );
+  const size_t shift = x & 63;
+  for ( size_t v = 0; v < mask.height_; v++ ) {
+    // rows of the mask and of the canvas with disjoint occupied spans are skipped
+    if ( mask.rowMin_[v] > mask.rowMax_[v] || rowMin_[y + v] > rowMax_[y + v] ||
+         x + mask.rowMin_[v] > rowMax_[y + v] || x + mask.rowMax_[v] < rowMin_[y + v] ) {
+      continue;
+    }
+    const uint64_t* maskRow = mask.words_.data() + v * mask.stride_;
+    const uint64_t* row     = words_.data() + ( y + v ) * stride_ + ( x >> 6 );
+    for ( size_t w = mask.rowMin_[v] >> 6; w <= ( mask.rowMax_[v] >> 6 ); w++ ) {
+      if ( ( row[w] & ( maskRow[w] << shift ) ) != 0 ) { return true; }
+      if ( shift != 0 ) {
+        const uint64_t high = maskRow[w] >> ( 64 - shift );
+        if ( high != 0 && ( row[w + 1] & high ) != 0 ) { return true; }
+      }
+    }
+  }
+  return false;
+}
@@ -126,13 +126,11 @@ void PCCCodec::smoothPointCloudPostprocess( PCCPointSet3&
         }
       }
 
-      geoSmoothingCenter_.resize( numBoundaryCells );
-      geoSmoothingCount_.resize( numBoundaryCells );
-      geoSmoothingPartition_.resize( numBoundaryCells );
-      geoSmoothingDoSmooth_.resize( numBoundaryCells );
-      int size = static_cast<int>( geoSmoothingCount_.size() );
-      geoSmoothingCount_.resize( 0 );
-      geoSmoothingCount_.resize( size, 0 );
+      // grid buffers are local to the call so that several frames can be smoothed concurrently
+      std::vector<uint16_t>          geoSmoothingCount( numBoundaryCells, 0 );
+      std::vector<PCCVector3<float>> geoSmoothingCenter( numBoundaryCells );
+      std::vector<bool>              geoSmoothingDoSmooth( numBoundaryCells );
+      std::vector<uint32_t>          geoSmoothingPartition( numBoundaryCells );
       for ( int j = 0; j < reconstruct.getPointCount(); j++ ) {
         PCCPoint3D point  = reconstruct[j];
         int        x2     = point.x() / params.gridSize_;
@@ -140,15 +138,16 @@ void PCCCodec::smoothPointCloudPostprocess( PCCPointSet3&
         int        z2     = point.z() / params.gridSize_;
         int        cellId = x2 + y2 * w + z2 * w * w;
         if ( cellIndex[cellId] != -1 ) {
-          addGridCentroid( reconstruct[j], partition[j] + 1, geoSmoothingCount_, geoSmoothingCenter_,
-                           geoSmoothingPartition_, geoSmoothingDoSmooth_, static_cast<int>( params.gridSize_ ), w,
+          addGridCentroid( reconstruct[j], partition[j] + 1, geoSmoothingCount, geoSmoothingCenter,
+                           geoSmoothingPartition, geoSmoothingDoSmooth, static_cast<int>( params.gridSize_ ), w,
                            cellIndex[cellId] );
         }
       }
-      for ( int i = 0; i < geoSmoothingCount_.size(); i++ ) {
-        if ( geoSmoothingCount_[i] != 0U ) { geoSmoothingCenter_[i] /= geoSmoothingCount_[i]; }
+      for ( int i = 0; i < geoSmoothingCount.size(); i++ ) {
+        if ( geoSmoothingCount[i] != 0U ) { geoSmoothingCenter[i] /= geoSmoothingCount[i]; }
       }
-      smoothPointCloudGrid( reconstruct, partition, params, w, cellIndex );
+      smoothPointCloudGrid( reconstruct, partition, params, w, cellIndex, geoSmoothingCount, geoSmoothingCenter,
+                            geoSmoothingDoSmooth );
       cellIndex.clear();
     } else {
       if ( !params.pbfEnableFlag_ ) { smoothPointCloud( reconstruct, partition, params ); }
@@ -216,18 +215,12 @@ void PCCCodec::colorSmoothing( PCCPointSet3&                       reconstruct,
       }
     }
   }
-  colorSmoothingCenter_.resize( numBoundaryCells );
-  colorSmoothingCount_.resize( numBoundaryCells );
-  colorSmoothingPartition_.resize( numBoundaryCells );
-  colorSmoothingDoSmooth_.resize( numBoundaryCells );
-  std::fill( colorSmoothingCenter_.begin(), colorSmoothingCenter_.end(), 0 );
-  std::fill( colorSmoothingCount_.begin(), colorSmoothingCount_.end(), 0 );
-  std::pair<size_t, size_t> initPair;
-  initPair.first = initPair.second = 0;
-  std::fill( colorSmoothingPartition_.begin(), colorSmoothingPartition_.end(), initPair );
-  std::fill( colorSmoothingDoSmooth_.begin(), colorSmoothingDoSmooth_.end(), 0 );
-  colorSmoothingLum_.clear();
-  colorSmoothingLum_.resize( numBoundaryCells );
+  // grid buffers are local to the call so that several frames can be smoothed concurrently
+  std::vector<uint16_t>                  colorSmoothingCount( numBoundaryCells, 0 );
+  std::vector<PCCVector3<float>>         colorSmoothingCenter( numBoundaryCells, PCCVector3<float>( 0.F ) );
+  std::vector<bool>                      colorSmoothingDoSmooth( numBoundaryCells, false );
+  std::vector<std::pair<size_t, size_t>> colorSmoothingPartition( numBoundaryCells, std::make_pair( 0, 0 ) );
+  std::vector<std::vector<uint16_t>>     colorSmoothingLum( numBoundaryCells );
   for ( int k = 0; k < reconstruct.getPointCount(); k++ ) {
     PCCPoint3D point  = reconstruct[k];
     int        x2     = point.x() / gridSize;
@@ -243,23 +236,14 @@ void PCCCodec::colorSmoothing( PCCPointSet3&                       reconstruct,
         for ( size_t c = 0; c < 3; ++c ) { clr[c] = double( color16bit[c] ); }
         auto tilePatchIndexPlusOne   = reconstruct.getPointPatchIndex( k );
         tilePatchIndexPlusOne.second = tilePatchIndexPlusOne.second + 1;
-        addGridColorCentroid( reconstruct[k], clr, tilePatchIndexPlusOne, colorSmoothingCount_, colorSmoothingCenter_,
-                              colorSmoothingPartition_, colorSmoothingDoSmooth_, gridSize, colorSmoothingLum_, params,
+        addGridColorCentroid( reconstruct[k], clr, tilePatchIndexPlusOne, colorSmoothingCount, colorSmoothingCenter,
+                              colorSmoothingPartition, colorSmoothingDoSmooth, gridSize, colorSmoothingLum, params,
                               cellIndex[cellId] );
       }
     }
   }
-  smoothPointCloudColorLC( reconstruct, params, cellIndex );
-  colorSmoothingCenter_.resize( 0 );
-  colorSmoothingCenter_.shrink_to_fit();
-  colorSmoothingCount_.resize( 0 );
-  colorSmoothingCount_.shrink_to_fit();
-  colorSmoothingPartition_.resize( 0 );
-  colorSmoothingPartition_.shrink_to_fit();
-  colorSmoothingDoSmooth_.resize( 0 );
-  colorSmoothingDoSmooth_.shrink_to_fit();
-  colorSmoothingLum_.resize( 0 );
-  colorSmoothingLum_.shrink_to_fit();
+  smoothPointCloudColorLC( reconstruct, params, cellIndex, colorSmoothingCount, colorSmoothingCenter,
+                           colorSmoothingDoSmooth, colorSmoothingLum );
 }
 
 int PCCCodec::getDeltaNeighbors( const PCCImageGeometry& frame,
@@ -1341,7 +1325,10 @@ void PCCCodec::smoothPointCloudGrid( PCCPointSet3&                       reconst
                                      const std::vector<uint32_t>&        partition,
                                      const GeneratePointCloudParameters& params,
                                      uint16_t                            gridWidth,
-                                     std::vector<int>&                   cellIndex ) {
+                                     std::vector<int>&                   cellIndex,
+                                     std::vector<uint16_t>&              gridCount,
+                                     std::vector<PCCVector3<float>>&     center,
+                                     std::vector<bool>&                  doSmooth ) {
   TRACE_CODEC( " smoothPointCloudGrid start \n" );
   const size_t pointCount = reconstruct.getPointCount();
   const int    gridSize   = static_cast<int>( params.gridSize_ );
@@ -1360,8 +1347,8 @@ void PCCCodec::smoothPointCloudGrid( PCCPointSet3&                       reconst
     PCCVector3D color( 0, 0, 0 );
     if ( reconstruct.getBoundaryPointType( c ) == 1 ) {
       otherClusterPointCount =
-          gridFiltering( partition, reconstruct, curPoint, centroid, count, geoSmoothingCount_, geoSmoothingCenter_,
-                         geoSmoothingDoSmooth_, gridSize, gridWidth, cellIndex );
+          gridFiltering( partition, reconstruct, curPoint, centroid, count, gridCount, center, doSmooth, gridSize,
+                         gridWidth, cellIndex );
     }
     if ( otherClusterPointCount ) {
       double dist2 = ( ( curVector * count - centroid ).getNorm2() ) / static_cast<double>( count ) + 0.5;
@@ -1468,6 +1455,7 @@ bool PCCCodec::gridFilteringColor( PCCPoint3D&                         curPos,
                                    std::vector<uint16_t>&              colorGridCount,
                                    std::vector<PCCVector3<float>>&     colorCenter,
                                    std::vector<bool>&                  colorDoSmooth,
+                                   std::vector<std::vector<uint16_t>>& colorLum,
                                    uint8_t                             gridSize,
                                    PCCVector3D&                        curPosColor,
                                    const GeneratePointCloudParameters& params,
@@ -1523,9 +1511,9 @@ bool PCCCodec::gridFilteringColor( PCCPoint3D&                         curPos,
     cnt0 = colorGridCount[cellIndex[idx[0][0][0]]];
     if ( colorGridCount[cellIndex[idx[0][0][0]]] > 1 ) {
       double meanY =
-          mean( colorSmoothingLum_[cellIndex[idx[0][0][0]]], int( colorGridCount[cellIndex[idx[0][0][0]]] ) );
+          mean( colorLum[cellIndex[idx[0][0][0]]], int( colorGridCount[cellIndex[idx[0][0][0]]] ) );
       double medianY =
-          median( colorSmoothingLum_[cellIndex[idx[0][0][0]]], int( colorGridCount[cellIndex[idx[0][0][0]]] ) );
+          median( colorLum[cellIndex[idx[0][0][0]]], int( colorGridCount[cellIndex[idx[0][0][0]]] ) );
       if ( abs( meanY - medianY ) > mmThresh ) {
         colorCentroid = curPosColor;
         colorCount    = 1;
@@ -1550,9 +1538,9 @@ bool PCCCodec::gridFilteringColor( PCCPoint3D&                         curPos,
     if ( abs( Y0 - Y1 ) > yThresh ) { colorCentroid3[0][0][1] = curPosColor; }
     if ( colorGridCount[cellIndex[idx[0][0][1]]] > 1 ) {
       double meanY =
-          mean( colorSmoothingLum_[cellIndex[idx[0][0][1]]], int( colorGridCount[cellIndex[idx[0][0][1]]] ) );
+          mean( colorLum[cellIndex[idx[0][0][1]]], int( colorGridCount[cellIndex[idx[0][0][1]]] ) );
       double medianY =
-          median( colorSmoothingLum_[cellIndex[idx[0][0][1]]], int( colorGridCount[cellIndex[idx[0][0][1]]] ) );
+          median( colorLum[cellIndex[idx[0][0][1]]], int( colorGridCount[cellIndex[idx[0][0][1]]] ) );
       if ( abs( meanY - medianY ) > mmThresh ) { colorCentroid3[0][0][1] = curPosColor; }
     }
   } else {
@@ -1571,9 +1559,9 @@ bool PCCCodec::gridFilteringColor( PCCPoint3D&                         curPos,
     if ( abs( Y0 - Y2 ) > yThresh ) { colorCentroid3[0][1][0] = curPosColor; }
     if ( colorGridCount[cellIndex[idx[0][1][0]]] > 1 ) {
       double meanY =
-          mean( colorSmoothingLum_[cellIndex[idx[0][1][0]]], int( colorGridCount[cellIndex[idx[0][1][0]]] ) );
+          mean( colorLum[cellIndex[idx[0][1][0]]], int( colorGridCount[cellIndex[idx[0][1][0]]] ) );
       double medianY =
-          median( colorSmoothingLum_[cellIndex[idx[0][1][0]]], int( colorGridCount[cellIndex[idx[0][1][0]]] ) );
+          median( colorLum[cellIndex[idx[0][1][0]]], int( colorGridCount[cellIndex[idx[0][1][0]]] ) );
       if ( abs( meanY - medianY ) > mmThresh ) { colorCentroid3[0][1][0] = curPosColor; }
     }
   } else {
@@ -1593,9 +1581,9 @@ bool PCCCodec::gridFilteringColor( PCCPoint3D&                         curPos,
     if ( abs( Y0 - Y3 ) > yThresh ) { colorCentroid3[0][1][1] = curPosColor; }
     if ( colorGridCount[cellIndex[idx[0][1][1]]] > 1 ) {
       double meanY =
-          mean( colorSmoothingLum_[cellIndex[idx[0][1][1]]], int( colorGridCount[cellIndex[idx[0][1][1]]] ) );
+          mean( colorLum[cellIndex[idx[0][1][1]]], int( colorGridCount[cellIndex[idx[0][1][1]]] ) );
       double medianY =
-          median( colorSmoothingLum_[cellIndex[idx[0][1][1]]], int( colorGridCount[cellIndex[idx[0][1][1]]] ) );
+          median( colorLum[cellIndex[idx[0][1][1]]], int( colorGridCount[cellIndex[idx[0][1][1]]] ) );
       if ( abs( meanY - medianY ) > mmThresh ) { colorCentroid3[0][1][1] = curPosColor; }
     }
   } else {
@@ -1614,9 +1602,9 @@ bool PCCCodec::gridFilteringColor( PCCPoint3D&                         curPos,
     if ( abs( Y0 - Y4 ) > yThresh ) { colorCentroid3[1][0][0] = curPosColor; }
     if ( colorGridCount[cellIndex[idx[1][0][0]]] > 1 ) {
       double meanY =
-          mean( colorSmoothingLum_[cellIndex[idx[1][0][0]]], int( colorGridCount[cellIndex[idx[1][0][0]]] ) );
+          mean( colorLum[cellIndex[idx[1][0][0]]], int( colorGridCount[cellIndex[idx[1][0][0]]] ) );
       double medianY =
-          median( colorSmoothingLum_[cellIndex[idx[1][0][0]]], int( colorGridCount[cellIndex[idx[1][0][0]]] ) );
+          median( colorLum[cellIndex[idx[1][0][0]]], int( colorGridCount[cellIndex[idx[1][0][0]]] ) );
       if ( abs( meanY - medianY ) > mmThresh ) { colorCentroid3[1][0][0] = curPosColor; }
     }
   } else {
@@ -1635,9 +1623,9 @@ bool PCCCodec::gridFilteringColor( PCCPoint3D&                         curPos,
     if ( abs( Y0 - Y5 ) > yThresh ) { colorCentroid3[1][0][1] = curPosColor; }
     if ( colorGridCount[cellIndex[idx[1][0][1]]] > 1 ) {
       double meanY =
-          mean( colorSmoothingLum_[cellIndex[idx[1][0][1]]], int( colorGridCount[cellIndex[idx[1][0][1]]] ) );
+          mean( colorLum[cellIndex[idx[1][0][1]]], int( colorGridCount[cellIndex[idx[1][0][1]]] ) );
       double medianY =
-          median( colorSmoothingLum_[cellIndex[idx[1][0][1]]], int( colorGridCount[cellIndex[idx[1][0][1]]] ) );
+          median( colorLum[cellIndex[idx[1][0][1]]], int( colorGridCount[cellIndex[idx[1][0][1]]] ) );
       if ( abs( meanY - medianY ) > mmThresh ) { colorCentroid3[1][0][1] = curPosColor; }
     }
   } else {
@@ -1656,9 +1644,9 @@ bool PCCCodec::gridFilteringColor( PCCPoint3D&                         curPos,
     if ( abs( Y0 - Y6 ) > yThresh ) { colorCentroid3[1][1][0] = curPosColor; }
     if ( colorGridCount[cellIndex[idx[1][1][0]]] > 1 ) {
       double meanY =
-          mean( colorSmoothingLum_[cellIndex[idx[1][1][0]]], int( colorGridCount[cellIndex[idx[1][1][0]]] ) );
+          mean( colorLum[cellIndex[idx[1][1][0]]], int( colorGridCount[cellIndex[idx[1][1][0]]] ) );
       double medianY =
-          median( colorSmoothingLum_[cellIndex[idx[1][1][0]]], int( colorGridCount[cellIndex[idx[1][1][0]]] ) );
+          median( colorLum[cellIndex[idx[1][1][0]]], int( colorGridCount[cellIndex[idx[1][1][0]]] ) );
       if ( abs( meanY - medianY ) > mmThresh ) { colorCentroid3[1][1][0] = curPosColor; }
     }
   } else {
@@ -1676,9 +1664,9 @@ bool PCCCodec::gridFilteringColor( PCCPoint3D&                         curPos,
     if ( abs( Y0 - Y7 ) > yThresh ) { colorCentroid3[1][1][1] = curPosColor; }
     if ( colorGridCount[cellIndex[idx[1][1][1]]] > 1 ) {
       double meanY =
-          mean( colorSmoothingLum_[cellIndex[idx[1][1][1]]], int( colorGridCount[cellIndex[idx[1][1][1]]] ) );
+          mean( colorLum[cellIndex[idx[1][1][1]]], int( colorGridCount[cellIndex[idx[1][1][1]]] ) );
       double medianY =
-          median( colorSmoothingLum_[cellIndex[idx[1][1][1]]], int( colorGridCount[cellIndex[idx[1][1][1]]] ) );
+          median( colorLum[cellIndex[idx[1][1][1]]], int( colorGridCount[cellIndex[idx[1][1][1]]] ) );
       if ( abs( meanY - medianY ) > mmThresh ) { colorCentroid3[1][1][1] = curPosColor; }
     }
   } else {
@@ -1706,7 +1694,11 @@ bool PCCCodec::gridFilteringColor( PCCPoint3D&                         curPos,
 
 void PCCCodec::smoothPointCloudColorLC( PCCPointSet3&                       reconstruct,
                                         const GeneratePointCloudParameters& params,
-                                        std::vector<int>&                   cellIndex ) {
+                                        std::vector<int>&                   cellIndex,
+                                        std::vector<uint16_t>&              colorGridCount,
+                                        std::vector<PCCVector3<float>>&     colorCenter,
+                                        std::vector<bool>&                  colorDoSmooth,
+                                        std::vector<std::vector<uint16_t>>& colorLum ) {
   const size_t pointCount = reconstruct.getPointCount();
   const int    gridSize   = params.occupancyPrecision_;
   const int    disth      = ( std::max )( gridSize / 2, 1 );
@@ -1730,8 +1722,8 @@ void PCCCodec::smoothPointCloudColorLC( PCCPointSet3&                       reco
     curPosColor[2] = double( color16bit[2] );
     if ( reconstruct.getBoundaryPointType( i ) == 1 ) {
       otherClusterPointCount =
-          gridFilteringColor( curPos, colorCentroid, colorCount, colorSmoothingCount_, colorSmoothingCenter_,
-                              colorSmoothingDoSmooth_, gridSize, curPosColor, params, cellIndex );
+          gridFilteringColor( curPos, colorCentroid, colorCount, colorGridCount, colorCenter, colorDoSmooth, colorLum,
+                              gridSize, curPosColor, params, cellIndex );
     }
     if ( otherClusterPointCount ) {
       colorCentroid = ( colorCentroid + static_cast<double>( colorCount ) / 2.0 ) / static_cast<double>( colorCount );
@@ -1908,8 +1900,6 @@ size_t PCCCodec::colorPointCloud( PCCPointSet3&                       reconstruc
 
 void PCCCodec::generateRawPointsGeometryfromVideo( PCCContext& context, size_t frameIndex ) {
   TRACE_CODEC( " generateRawPointsGeometryfromVideo start \n" );
-  auto& videoRawPointsGeometry = context.getVideoRawPointsGeometry();
-  videoRawPointsGeometry.resize( context.size() );
   for ( size_t tileIdx = 0; tileIdx < context.getFrame( frameIndex ).getNumTilesInAtlasFrame(); tileIdx++ ) {
     auto& tile = context.getFrame( frameIndex ).getTile( tileIdx );
     generateRawPointsGeometryfromVideo( context, tile, frameIndex );
@@ -1959,8 +1949,6 @@ void PCCCodec::generateRawPointsGeometryfromVideo( PCCContext& context, PCCFrame
 }
 
 void PCCCodec::generateRawPointsTexturefromVideo( PCCContext& context, size_t frameIndex ) {
-  auto& videoRawPointsTexture = context.getVideoRawPointsTexture();
-  videoRawPointsTexture.resize( context.size() );
   TRACE_CODEC( "generateRawPointsTexturefromVideo \n" );
   for ( size_t tileIdx = 0; tileIdx < context.getFrame( frameIndex ).getNumTilesInAtlasFrame(); tileIdx++ ) {
     auto& tile = context.getFrame( frameIndex ).getTile( tileIdx );
@@ -35,6 +35,7 @@
 #include "PCCVideo.h"
 #include "PCCContext.h"
 #include "MD5.h"
+#include <array>
 
 using namespace pcc;
 
@@ -237,19 +238,25 @@ std::vector<uint8_t> PCCContext::computeMD5( uint8_t* byteString, size_t len ) {
 }
 
 uint16_t PCCContext::computeCRC( uint8_t* byteString, size_t len ) {
-  uint8_t      crcMsb, bitVal, dataByte;
-  unsigned int crc    = 0xFFFF;
-  byteString[len]     = 0;
-  byteString[len + 1] = 0;
-
-  for ( unsigned int bitIdx = 0; bitIdx < ( len + 2 ) * 8; bitIdx++ ) {
-    dataByte = byteString[bitIdx >> 3];
-    crcMsb   = ( crc >> 15 ) & 1;
-    bitVal   = ( dataByte >> ( 7 - bitIdx ) ) & 1;
-    crc      = ( ( ( crc << 1 ) + bitVal ) & 0xFFFF ) ^ ( crcMsb * 0x1021 );
+  // CRC of the byte string followed by two zero bytes with the register initialized to 0xFFFF, computed byte-wise
+  // without the two zero bytes from 0x1D0F, the register obtained by shifting 0xFFFF through sixteen zero bits.
+  static const std::array<uint16_t, 256> table = [] {
+    std::array<uint16_t, 256> values{};
+    for ( size_t i = 0; i < 256; i++ ) {
+      auto crc = static_cast<uint16_t>( i << 8 );
+      for ( size_t bit = 0; bit < 8; bit++ ) {
+        crc = static_cast<uint16_t>( ( crc << 1 ) ^ ( ( crc & 0x8000 ) != 0 ? 0x1021 : 0 ) );
+      }
+      values[i] = crc;
+    }
+    return values;
+  }();
+  uint16_t crc = 0x1D0F;
+  for ( size_t i = 0; i < len; i++ ) {
+    crc = static_cast<uint16_t>( ( crc << 8 ) ^ table[( ( crc >> 8 ) ^ byteString[i] ) & 0xFF] );
   }
   return crc;
-};
+}
 
 uint32_t PCCContext::computeCheckSum( uint8_t* byteString, size_t len ) {
   uint32_t checkSum = 0;
@@ -261,6 +268,16 @@ uint32_t PCCContext::computeCheckSum( uint8_t* byteString, size_t len ) {
   return checkSum;
 }
 
+void PCCContext::computeHash( std::vector<uint8_t>& byteString, size_t hashType, PCCSeiHashDigest& digest ) {
+  if ( hashType == 0 ) {
+    digest.md5_ = computeMD5( byteString.data(), byteString.size() );
+  } else if ( hashType == 1 ) {
+    digest.crc_ = computeCRC( byteString.data(), byteString.size() );
+  } else if ( hashType == 2 ) {
+    digest.checkSum_ = computeCheckSum( byteString.data(), byteString.size() );
+  }
+}
+
 void PCCContext::allocOneLayerData() {
   atlasContexts_[atlasIndex_].allocOneLayerData();
   for ( size_t frameIdx = 0; frameIdx < size(); frameIdx++ ) {
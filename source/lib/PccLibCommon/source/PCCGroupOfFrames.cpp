@@ -33,6 +33,7 @@
 #include "PCCCommon.h"
 #include "PCCPointSet.h"
 #include "PCCGroupOfFrames.h"
+#include "PCCSystem.h"
 #include "tbb/tbb.h"
 
 using namespace pcc;
@@ -68,6 +69,16 @@ bool PCCGroupOfFrames::load( const std::string&      uncompressedDataPath,
   return ( startFrameNumber != endFrameNumber );
 }
 
+void PCCGroupOfFrames::prefetch( const std::string& uncompressedDataPath,
+                                 const size_t       startFrameNumber,
+                                 const size_t       endFrameNumber ) {
+  char fileName[4096];
+  for ( size_t frameNumber = startFrameNumber; frameNumber < endFrameNumber; frameNumber++ ) {
+    sprintf( fileName, uncompressedDataPath.c_str(), frameNumber );
+    prefetchFile( fileName );
+  }
+}
+
 bool PCCGroupOfFrames::write( const std::string& reconstructedDataPath, size_t& frameNumber, const size_t nbThread ) {
   char            fileName[4096];
   bool            ret = true;
@@ -35,11 +35,65 @@
 #include "PCCPointSet.h"
 #include "PCCKdTree.h"
 
-#include "KDTreeVectorOfVectorsAdaptor.h"
+#ifdef USE_VOXEL_HASH_NEIGHBOR_SEARCH
+#include "PCCVoxelHash.h"
+#else
+#include "PCCPointSetComponents.h"
+#include "nanoflann.hpp"
+#endif
 
 using namespace pcc;
 
-typedef KDTreeVectorOfVectorsAdaptor<PCCPointSet3, PCCType, float, 3, metric_L2_Simple_2, size_t> KdTreeAdaptor;
+#ifdef USE_VOXEL_HASH_NEIGHBOR_SEARCH
+typedef PCCVoxelHash KdTreeAdaptor;
+#else
+// Data source of the nanoflann kd-tree. The tree is built on the structure of arrays components of the point set,
+// as its bounding box and its splits read one coordinate of many points, and searched on the positions of the
+// point set, as the distances of its leaves read the three coordinates of a point: the components are released
+// once the tree is built.
+class KdTreeAdaptor {
+ public:
+  typedef nanoflann::L2_Simple_Adaptor<PCCType, KdTreeAdaptor, double>          Metric;
+  typedef nanoflann::KDTreeSingleIndexAdaptor<Metric, KdTreeAdaptor, 3, size_t> Index;
+
+  KdTreeAdaptor( const PCCPointSet3& pointCloud, const int leafMaxSize ) :
+      index( nullptr ), pointCloud_( pointCloud ), components_( pointCloud ) {
+    index = new Index( 3, *this, nanoflann::KDTreeSingleIndexAdaptorParams( leafMaxSize ) );
+    index->buildIndex();
+    components_.clear();
+  }
+  ~KdTreeAdaptor() { delete index; }
+
+  size_t kdtree_get_point_count() const { return pointCloud_.getPointCount(); }
+  float  kdtree_distance( const PCCType* point, const size_t index2, size_t size ) const {
+    const PCCPoint3D point2 = pointCloud_[index2];
+    float            sum    = 0;
+    for ( size_t i = 0; i < size; i++ ) {
+      const float diff = float( point[i] ) - float( point2[i] );
+      sum += diff * diff;
+    }
+    return sum;
+  }
+  PCCType kdtree_get_pt( const size_t index2, int dim ) const { return components_.getPosition( index2, dim ); }
+  template <class BBOX>
+  bool kdtree_get_bbox( BBOX& bbox ) const {
+    PCCPoint3D min;
+    PCCPoint3D max;
+    components_.computeBoundingBox( min, max );
+    for ( size_t k = 0; k < 3; ++k ) {
+      bbox[k].low  = min[k];
+      bbox[k].high = max[k];
+    }
+    return true;
+  }
+
+  Index* index;
+
+ private:
+  const PCCPointSet3&   pointCloud_;
+  PCCPointSetComponents components_;
+};
+#endif
 
 PCCKdTree::PCCKdTree() : kdtree_( nullptr ) {}
 
@@ -55,9 +109,25 @@ void PCCKdTree::clear() {
 
 void PCCKdTree::init( const PCCPointSet3& pointCloud ) {
   clear();
-  kdtree_ = new KdTreeAdaptor( 3, pointCloud, 10 );
+#ifdef USE_VOXEL_HASH_NEIGHBOR_SEARCH
+  kdtree_ = new KdTreeAdaptor( pointCloud );
+#else
+  kdtree_ = new KdTreeAdaptor( pointCloud, 10 );
+#endif
 }
 
+#ifdef USE_VOXEL_HASH_NEIGHBOR_SEARCH
+void PCCKdTree::search( const PCCPoint3D& point, const size_t num_results, PCCNNResult& results ) const {
+  ( static_cast<KdTreeAdaptor*>( kdtree_ ) )->search( point, num_results, results );
+}
+
+void PCCKdTree::searchRadius( const PCCPoint3D& point,
+                              const size_t      num_results,
+                              const double      radius,
+                              PCCNNResult&      results ) const {
+  ( static_cast<KdTreeAdaptor*>( kdtree_ ) )->searchRadius( point, num_results, radius, results );
+}
+#else
 void PCCKdTree::search( const PCCPoint3D& point, const size_t num_results, PCCNNResult& results ) const {
   if ( num_results != results.size() ) { results.resize( num_results ); }
   auto retSize = ( static_cast<KdTreeAdaptor*>( kdtree_ ) )
@@ -87,3 +157,55 @@ void PCCKdTree::searchRadius( const PCCPoint3D& point,
   for ( const auto& result : ret ) { results.pushBack( result ); }
 }
 #endif
+#endif
+
+// Checksum of the positions: the sum of the mixed values of the points and of their indexes, computed without a
+// dependency between the points. Its cost is a small fraction of the one of building a kd-tree.
+static uint64_t computePositionsChecksum( const PCCPointSet3& pointCloud ) {
+  const size_t pointCount = pointCloud.getPointCount();
+  uint64_t     checksum   = pointCount;
+  for ( size_t i = 0; i < pointCount; i++ ) {
+    const PCCPoint3D point = pointCloud[i];
+    uint64_t         value = uint64_t( uint16_t( point[0] ) ) | ( uint64_t( uint16_t( point[1] ) ) << 16 ) |
+                     ( uint64_t( uint16_t( point[2] ) ) << 32 ) | ( uint64_t( i ) << 48 );
+    value ^= uint64_t( i ) * 0x9E3779B97F4A7C15ULL;
+    value ^= value >> 29;
+    value *= 0xBF58476D1CE4E5B9ULL;
+    value ^= value >> 32;
+    checksum += value;
+  }
+  return checksum;
+}
+
+std::shared_ptr<const PCCKdTree> PCCKdTreeCache::get( const PCCPointSet3& pointCloud ) {
+  // the positions are checked outside of the lock
+  const size_t   pointCount = pointCloud.getPointCount();
+  const uint64_t checksum   = computePositionsChecksum( pointCloud );
+  {
+    std::lock_guard<std::mutex> lock( mutex_ );
+    auto                        it = entries_.find( &pointCloud );
+    if ( it != entries_.end() && it->second.pointCount_ == pointCount && it->second.checksum_ == checksum ) {
+      return it->second.kdtree_;
+    }
+  }
+  // the kd-trees of different point sets are built concurrently outside of the lock
+  auto                        kdtree = std::make_shared<const PCCKdTree>( pointCloud );
+  std::lock_guard<std::mutex> lock( mutex_ );
+  entries_[&pointCloud] = {pointCount, checksum, kdtree};
+  return kdtree;
+}
+
+void PCCKdTreeCache::release( const PCCPointSet3& pointCloud ) {
+  std::lock_guard<std::mutex> lock( mutex_ );
+  entries_.erase( &pointCloud );
+}
+
+void PCCKdTreeCache::clear() {
+  std::lock_guard<std::mutex> lock( mutex_ );
+  entries_.clear();
+}
+
+std::shared_ptr<const PCCKdTree> pcc::getKdTree( PCCKdTreeCache* kdTreeCache, const PCCPointSet3& pointCloud ) {
+  if ( kdTreeCache != nullptr ) { return kdTreeCache->get( pointCloud ); }
+  return std::make_shared<const PCCKdTree>( pointCloud );
+}
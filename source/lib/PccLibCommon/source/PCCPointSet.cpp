@@ -36,10 +36,51 @@
 #include "PCCMath.h"
 #include "KDTreeVectorOfVectorsAdaptor.h"
 #include "PCCKdTree.h"
+#include "PCCPointSetComponents.h"
+#include "PCCSystem.h"
 #include <numeric>
+#include <tbb/tbb.h>
 
 using namespace pcc;
 
+static bool isBigEndianPlatform() {
+  const uint16_t value = 1;
+  return *reinterpret_cast<const uint8_t*>( &value ) == 0;
+}
+
+// Decodes one property of the records of a binary PLY: the values are read at a fixed stride from the mapped file,
+// byte swapped if the endianness of the file differs from the platform one, and given to the store function.
+template <typename T, typename F>
+static void decodePlyProperty( const uint8_t* data,
+                               const size_t   recordSize,
+                               const size_t   recordCount,
+                               const bool     swap,
+                               F              store ) {
+  for ( size_t i = 0; i < recordCount; ++i, data += recordSize ) {
+    uint8_t bytes[sizeof( T )];
+    memcpy( bytes, data, sizeof( T ) );
+    if ( swap ) { std::reverse( bytes, bytes + sizeof( T ) ); }
+    T value;
+    memcpy( &value, bytes, sizeof( T ) );
+    store( i, value );
+  }
+}
+
+// Decodes a float32 or float64 property according to its byte count.
+template <typename F>
+static void decodePlyReal( const size_t   byteCount,
+                           const uint8_t* data,
+                           const size_t   recordSize,
+                           const size_t   recordCount,
+                           const bool     swap,
+                           F              store ) {
+  if ( byteCount == 4 ) {
+    decodePlyProperty<float>( data, recordSize, recordCount, swap, store );
+  } else {
+    decodePlyProperty<double>( data, recordSize, recordCount, swap, store );
+  }
+}
+
 void PCCPointSet3::removeDuplicate() {
   PCCPointSet3 newPointcloud;
   if ( withColors_ ) { newPointcloud.hasColors(); }
@@ -82,6 +123,55 @@ void PCCPointSet3::distanceGeo( const PCCPointSet3& pointcloud, float& distPAB,
   pointcloud.distance( *this, distPBA );
 }
 
+// Color space conversion to YUV of the colors of all the points, component by component.
+static void convertRGBtoYUV_BT709( const PCCPointSet3& pointcloud, std::vector<float> yuv[3] ) {
+  const PCCPointSetComponents components( pointcloud, true );
+  const size_t                pointCount = components.getPointCount();
+  for ( size_t c = 0; c < 3; ++c ) { yuv[c].assign( pointCount, 0.F ); }
+  if ( !components.hasColors() ) { return; }
+  const uint8_t* r = components.getColors( 0 );
+  const uint8_t* g = components.getColors( 1 );
+  const uint8_t* b = components.getColors( 2 );
+  float*         y = yuv[0].data();
+  float*         u = yuv[1].data();
+  float*         v = yuv[2].data();
+  for ( size_t i = 0; i < pointCount; ++i ) {
+    y[i] = ( 0.2126F * r[i] + 0.7152F * g[i] + 0.0722F * b[i] ) / 255.0F;
+    u[i] = ( -0.1146F * r[i] - 0.3854F * g[i] + 0.5000F * b[i] ) / 255.0F + 0.5000F;
+    v[i] = ( 0.5000F * r[i] - 0.4542F * g[i] - 0.0458F * b[i] ) / 255.0F + 0.5000F;
+  }
+}
+
+static void distanceColor( const PCCPointSet3&      pointcloudA,
+                           const std::vector<float> yuvA[3],
+                           const PCCPointSet3&      pointcloudB,
+                           const std::vector<float> yuvB[3],
+                           float&                   distP,
+                           float&                   distY,
+                           float&                   distU,
+                           float&                   distV ) {
+  distP = 0.F;
+  distY = 0.F;
+  distU = 0.F;
+  distV = 0.F;
+  PCCKdTree    kdtree( pointcloudB );
+  PCCNNResult  result;
+  const size_t pointCount = pointcloudA.getPointCount();
+  for ( size_t i = 0; i < pointCount; ++i ) {
+    kdtree.search( pointcloudA[i], 1, result );
+    distP += result.dist( 0 );
+    const size_t j = result.indices( 0 );
+    distY += pow( yuvA[0][i] - yuvB[0][j], 2.F );
+    distU += pow( yuvA[1][i] - yuvB[1][j], 2.F );
+    distV += pow( yuvA[2][i] - yuvB[2][j], 2.F );
+  }
+  distP /= static_cast<float>( pointCount );
+
+  distY /= static_cast<float>( pointCount );
+  distU /= static_cast<float>( pointCount );
+  distV /= static_cast<float>( pointCount );
+}
+
 void PCCPointSet3::distanceGeoColor( const PCCPointSet3& pointcloud,
                                      float&              distPAB,
                                      float&              distPBA,
@@ -91,43 +181,13 @@ void PCCPointSet3::distanceGeoColor( const PCCPointSet3& pointcloud,
                                      float&              distUBA,
                                      float&              distVAB,
                                      float&              distVBA ) const {
-  this->distance( pointcloud, distPAB, distYAB, distUAB, distVAB );
-  pointcloud.distance( *this, distPBA, distYBA, distUBA, distVBA );
-}
-void convertRGBtoYUV_BT709( const PCCColor3B& in_rgb, float* out_yuv ) {
-  // color space conversion to YUV
-  out_yuv[0] = ( 0.2126F * in_rgb[0] + 0.7152F * in_rgb[1] + 0.0722F * in_rgb[2] ) / 255.0F;
-  out_yuv[1] = ( -0.1146F * in_rgb[0] - 0.3854F * in_rgb[1] + 0.5000F * in_rgb[2] ) / 255.0F + 0.5000F;
-  out_yuv[2] = ( 0.5000F * in_rgb[0] - 0.4542F * in_rgb[1] - 0.0458F * in_rgb[2] ) / 255.0F + 0.5000F;
-}
-void PCCPointSet3::distance( const PCCPointSet3& pointcloud,
-                             float&              distP,
-                             float&              distY,
-                             float&              distU,
-                             float&              distV ) const {
-  distP = 0.F;
-  distY = 0.F;
-  distU = 0.F;
-  distV = 0.F;
-  PCCKdTree   kdtree( pointcloud );
-  PCCNNResult result;
-
-  for ( size_t i = 0; i < positions_.size(); ++i ) {
-    kdtree.search( positions_[i], 1, result );
-    distP += result.dist( 0 );
-    float yuvA[3];
-    float yuvB[3];
-    convertRGBtoYUV_BT709( colors_[i], yuvA );
-    convertRGBtoYUV_BT709( pointcloud.colors_[result.indices( 0 )], yuvB );
-    distY += pow( yuvA[0] - yuvB[0], 2.F );
-    distU += pow( yuvA[1] - yuvB[1], 2.F );
-    distV += pow( yuvA[2] - yuvB[2], 2.F );
-  }
-  distP /= static_cast<float>( positions_.size() );
-
-  distY /= static_cast<float>( positions_.size() );
-  distU /= static_cast<float>( positions_.size() );
-  distV /= static_cast<float>( positions_.size() );
+  // the colors of the two point sets are converted once for the two directions
+  std::vector<float> yuvA[3];
+  std::vector<float> yuvB[3];
+  convertRGBtoYUV_BT709( *this, yuvA );
+  convertRGBtoYUV_BT709( pointcloud, yuvB );
+  distanceColor( *this, yuvA, pointcloud, yuvB, distPAB, distYAB, distUAB, distVAB );
+  distanceColor( pointcloud, yuvB, *this, yuvA, distPBA, distYBA, distUBA, distVBA );
 }
 
 void PCCPointSet3::distance( const PCCPointSet3& pointcloud, float& distP ) const {
@@ -220,29 +280,155 @@ void PCCPointSet3::removeDuplicate( PCCPointSet3& newPointcloud, size_t dropDupl
 
 using UInt = unsigned int;
 #include "MD5.h"
-std::vector<uint8_t> PCCPointSet3::computeChecksum( bool reorderPoints ) {
-  if ( reorderPoints ) {
-    PCCPointSet3 reorderPointCloud;
-    if ( withColors_ ) { reorderPointCloud.hasColors(); }
-    if ( withReflectances_ ) { reorderPointCloud.addReflectances(); }
-    reorder( reorderPointCloud, true );
-    return reorderPointCloud.computeMd5();
-  }
-  return computeMd5();
+
+// Digest of the byte ranges given back to back to update(). The MD5 digest is the reference one. The fast digest is a
+// non-cryptographic 128-bit hash of the ranges cut in blocks of fixed size: the blocks are hashed concurrently and
+// chained in order, so the digest does not depend on the number of threads, but it only compares with fast digests.
+class PCCPointSetDigest {
+ public:
+  PCCPointSetDigest( bool fast ) : fast_( fast ) {}
+  PCCPointSetDigest( const PCCPointSetDigest& ) = delete;
+  PCCPointSetDigest& operator=( const PCCPointSetDigest& ) = delete;
+
+  void update( const void* data, const size_t size ) {
+    if ( !fast_ ) {
+      md5_.update( reinterpret_cast<uint8_t*>( const_cast<void*>( data ) ), size );
+      return;
+    }
+    const auto*                          bytes      = reinterpret_cast<const uint8_t*>( data );
+    const size_t                         blockCount = ( size + blockSize_ - 1 ) / blockSize_;
+    std::vector<std::array<uint64_t, 2>> blocks( blockCount );
+    tbb::parallel_for( size_t( 0 ), blockCount, [&]( const size_t block ) {
+      const size_t start = block * blockSize_;
+      blocks[block]      = hashBlock( bytes + start, ( std::min )( blockSize_, size - start ) );
+    } );
+    for ( const auto& block : blocks ) {
+      state_[0] = mix( state_[0] ^ block[0] ) + state_[1];
+      state_[1] = mix( state_[1] ^ block[1] ) ^ state_[0];
+    }
+    size_ += size;
+  }
+
+  std::vector<uint8_t> finalize() {
+    std::vector<uint8_t> digest( MD5_DIGEST_STRING_LENGTH, 0 );
+    if ( !fast_ ) {
+      md5_.finalize( digest.data() );
+      return digest;
+    }
+    const uint64_t lanes[2] = {mix( state_[0] ^ size_ ), mix( state_[1] + state_[0] )};
+    for ( size_t i = 0; i < digest.size(); i++ ) {
+      digest[i] = static_cast<uint8_t>( lanes[i / 8] >> ( 8 * ( i % 8 ) ) );
+    }
+    return digest;
+  }
+
+ private:
+  static uint64_t rotate( const uint64_t value, const int shift ) {
+    return ( value << shift ) | ( value >> ( 64 - shift ) );
+  }
+  static uint64_t mix( uint64_t value ) {
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdULL;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53ULL;
+    return value ^ ( value >> 33 );
+  }
+  static uint64_t round( const uint64_t lane, const uint64_t word ) {
+    return rotate( lane + word * 0xc2b2ae3d27d4eb4fULL, 31 ) * 0x9e3779b185ebca87ULL;
+  }
+  static std::array<uint64_t, 2> hashBlock( const uint8_t* bytes, const size_t size ) {
+    uint64_t lanes[2] = {0x9e3779b185ebca87ULL ^ size, 0xc2b2ae3d27d4eb4fULL};
+    size_t   i        = 0;
+    for ( ; i + 16 <= size; i += 16 ) {
+      uint64_t words[2];
+      memcpy( words, bytes + i, 16 );
+      lanes[0] = round( lanes[0], words[0] );
+      lanes[1] = round( lanes[1], words[1] );
+    }
+    if ( i < size ) {
+      uint64_t words[2] = {0, 0};
+      memcpy( words, bytes + i, size - i );
+      lanes[0] = round( lanes[0], words[0] );
+      lanes[1] = round( lanes[1], words[1] );
+    }
+    return {mix( lanes[0] ^ rotate( lanes[1], 17 ) ), mix( lanes[1] + lanes[0] )};
+  }
+
+  static const size_t blockSize_ = 65536;
+  bool                fast_;
+  MD5                 md5_;
+  uint64_t            state_[2] = {0, 0};
+  uint64_t            size_     = 0;
+};
+
+// Indexes of the points sorted by x, then y, then z, the points at the same position in the order of their indexes:
+// the order of reorder(). Stable radix sort on the 16-bit coordinates, from z to x, in place of the maps of reorder().
+static void sortByPosition( const std::vector<PCCPoint3D>& positions, std::vector<size_t>& order ) {
+  const size_t        pointCount = positions.size();
+  std::vector<size_t> sorted( pointCount );
+  std::vector<size_t> counts( size_t( 1 ) << 16 );
+  order.resize( pointCount );
+  std::iota( order.begin(), order.end(), 0 );
+  for ( int c = 2; c >= 0; c-- ) {
+    auto digit = [&]( const size_t index ) { return static_cast<uint16_t>( positions[index][c] ) ^ 0x8000; };
+    std::fill( counts.begin(), counts.end(), 0 );
+    for ( size_t i = 0; i < pointCount; i++ ) { counts[digit( i )]++; }
+    if ( pointCount == 0 || counts[digit( 0 )] == pointCount ) { continue; }
+    for ( size_t d = 0, start = 0; d < counts.size(); d++ ) {
+      const size_t count = counts[d];
+      counts[d]          = start;
+      start += count;
+    }
+    for ( const auto index : order ) { sorted[counts[digit( index )]++] = index; }
+    order.swap( sorted );
+  }
 }
-std::vector<uint8_t> PCCPointSet3::computeMd5() {
-  std::vector<uint8_t> digest;
-  MD5                  md5;
-  md5.update( reinterpret_cast<uint8_t*>( positions_.data() ), positions_.size() * sizeof( PCCPoint3D ) );
-  if ( withColors_ ) {
-    md5.update( reinterpret_cast<uint8_t*>( colors_.data() ), colors_.size() * sizeof( PCCColor3B ) );
+
+std::vector<uint8_t> PCCPointSet3::computeChecksum( bool reorderPoints, bool fastDigest ) {
+  PCCPointSetDigest digest( fastDigest );
+  if ( !reorderPoints ) {
+    digest.update( positions_.data(), positions_.size() * sizeof( PCCPoint3D ) );
+    if ( withColors_ ) { digest.update( colors_.data(), colors_.size() * sizeof( PCCColor3B ) ); }
+    if ( withReflectances_ ) { digest.update( reflectances_.data(), reflectances_.size() * sizeof( uint16_t ) ); }
+    return digest.finalize();
   }
+
+  // Bytes of the point cloud given by reorder( pointcloud, true ), without building it: with colors, the points at
+  // the same position are merged into one with the average of their colors, otherwise all the points are kept; the
+  // reflectances are not copied and are zeros.
+  std::vector<size_t> order;
+  sortByPosition( positions_, order );
+  std::vector<PCCPoint3D> positions;
+  std::vector<PCCColor3B> colors;
+  positions.reserve( order.size() );
+  if ( withColors_ ) { colors.reserve( order.size() ); }
+  for ( size_t i = 0; i < order.size(); ) {
+    const auto& position = positions_[order[i]];
+    size_t      end      = i + 1;
+    if ( withColors_ ) {
+      size_t r = 0;
+      size_t g = 0;
+      size_t b = 0;
+      for ( ; end < order.size() && positions_[order[end]] == position; end++ ) {}
+      for ( size_t j = i; j < end; j++ ) {
+        r += colors_[order[j]][0];
+        g += colors_[order[j]][1];
+        b += colors_[order[j]][2];
+      }
+      const size_t count = end - i;
+      colors.push_back( PCCColor3B( static_cast<uint8_t>( r / count ), static_cast<uint8_t>( g / count ),
+                                    static_cast<uint8_t>( b / count ) ) );
+    }
+    positions.push_back( position );
+    i = end;
+  }
+  digest.update( positions.data(), positions.size() * sizeof( PCCPoint3D ) );
+  if ( withColors_ ) { digest.update( colors.data(), colors.size() * sizeof( PCCColor3B ) ); }
   if ( withReflectances_ ) {
-    md5.update( reinterpret_cast<uint8_t*>( reflectances_.data() ), reflectances_.size() * sizeof( uint16_t ) );
+    std::vector<uint16_t> reflectances( positions.size(), 0 );
+    digest.update( reflectances.data(), reflectances.size() * sizeof( uint16_t ) );
   }
-  digest.resize( MD5_DIGEST_STRING_LENGTH );
-  md5.finalize( digest.data() );
-  return digest;
+  return digest.finalize();
 }
 
 void PCCPointSet3::sortColor( std::vector<size_t>& list ) {
@@ -501,6 +687,7 @@ bool PCCPointSet3::read( const std::string& fileName, const bool readNormals ) {
     return false;
   }
   bool   isAscii          = false;
+  bool   isBigEndian      = false;
   double version          = 1.0;
   size_t pointCount       = 0;
   bool   isVertexProperty = true;
@@ -517,8 +704,9 @@ bool PCCPointSet3::read( const std::string& fileName, const bool readNormals ) {
         std::cout << "Error: corrupted format info!" << std::endl;
         return false;
       }
-      isAscii = tokens[1] == "ascii";
-      version = atof( tokens[2].c_str() );
+      isAscii     = tokens[1] == "ascii";
+      isBigEndian = tokens[1] == "binary_big_endian";
+      version     = atof( tokens[2].c_str() );
     } else if ( tokens[0] == "element" ) {
       if ( tokens.size() != 3 ) {
         std::cout << "Error: corrupted element info!" << std::endl;
@@ -646,100 +834,56 @@ bool PCCPointSet3::read( const std::string& fileName, const bool readNormals ) {
     }
   } else {
     ifs.close();
-    ifs.open( fileName, std::ifstream::binary | std::ifstream::in );
-    ifs.read( tmp, MAX_BUFFER_SIZE );
-    char* str       = strstr( tmp, "end_header" );
-    str             = strstr( str, "\n" );
-    int headerCount = str - tmp + 1;
-    ifs.close();
-    ifs.open( fileName, std::ifstream::binary | std::ifstream::in );
-    ifs.read( tmp, headerCount );
-    for ( size_t pointCounter = 0; pointCounter < pointCount && !ifs.eof(); ++pointCounter ) {
-      auto& position = positions_[pointCounter];
-      for ( size_t a = 0; a < attributeCount && !ifs.eof(); ++a ) {
-        const auto& attributeInfo = attributesInfo[a];
-        if ( a == indexX ) {
-          if ( attributeInfo.byteCount == 4 ) {
-            float x;
-            ifs.read( reinterpret_cast<char*>( &x ), sizeof( float ) );
-            position[0] = x;
-          } else {
-            double x;
-            ifs.read( reinterpret_cast<char*>( &x ), sizeof( double ) );
-            position[0] = x;
-          }
-        } else if ( a == indexY ) {
-          if ( attributeInfo.byteCount == 4 ) {
-            float y;
-            ifs.read( reinterpret_cast<char*>( &y ), sizeof( float ) );
-            position[1] = y;
-          } else {
-            double y;
-            ifs.read( reinterpret_cast<char*>( &y ), sizeof( double ) );
-            position[1] = y;
-          }
-        } else if ( a == indexZ ) {
-          if ( attributeInfo.byteCount == 4 ) {
-            float z;
-            ifs.read( reinterpret_cast<char*>( &z ), sizeof( float ) );
-            position[2] = z;
-          } else {
-            double z;
-            ifs.read( reinterpret_cast<char*>( &z ), sizeof( double ) );
-            position[2] = z;
-          }
-        } else if ( a == indexR && attributeInfo.byteCount == 1 ) {
-          auto& color = colors_[pointCounter];
-          ifs.read( reinterpret_cast<char*>( &color[0] ), sizeof( uint8_t ) );
-        } else if ( a == indexG && attributeInfo.byteCount == 1 ) {
-          auto& color = colors_[pointCounter];
-          ifs.read( reinterpret_cast<char*>( &color[1] ), sizeof( uint8_t ) );
-        } else if ( a == indexB && attributeInfo.byteCount == 1 ) {
-          auto& color = colors_[pointCounter];
-          ifs.read( reinterpret_cast<char*>( &color[2] ), sizeof( uint8_t ) );
-        } else if ( a == indexNX ) {
-          if ( attributeInfo.byteCount == 4 ) {
-            float nx;
-            ifs.read( reinterpret_cast<char*>( &nx ), sizeof( float ) );
-            normals_[pointCounter][0] = nx;
-          } else {
-            double nx;
-            ifs.read( reinterpret_cast<char*>( &nx ), sizeof( double ) );
-            normals_[pointCounter][0] = nx;
-          }
-        } else if ( a == indexNY ) {
-          if ( attributeInfo.byteCount == 4 ) {
-            float ny;
-            ifs.read( reinterpret_cast<char*>( &ny ), sizeof( float ) );
-            normals_[pointCounter][1] = ny;
-          } else {
-            double ny;
-            ifs.read( reinterpret_cast<char*>( &ny ), sizeof( double ) );
-            normals_[pointCounter][1] = ny;
-          }
-        } else if ( a == indexNZ ) {
-          if ( attributeInfo.byteCount == 4 ) {
-            float nz;
-            ifs.read( reinterpret_cast<char*>( &nz ), sizeof( float ) );
-            normals_[pointCounter][2] = nz;
-          } else {
-            double nz;
-            ifs.read( reinterpret_cast<char*>( &nz ), sizeof( double ) );
-            normals_[pointCounter][2] = nz;
-          }
-        } else if ( a == indexReflectance && attributeInfo.byteCount <= 2 ) {
-          if ( indexReflectance == 1 ) {
-            uint8_t reflectance;
-            ifs.read( reinterpret_cast<char*>( &reflectance ), sizeof( uint8_t ) );
-            reflectances_[pointCounter] = reflectance;
-          } else {
-            auto& reflectance = reflectances_[pointCounter];
-            ifs.read( reinterpret_cast<char*>( reflectance ), sizeof( uint16_t ) );
-          }
-        } else {
-          char buffer[128];
-          ifs.read( buffer, attributeInfo.byteCount );
-        }
+    // binary: the file is mapped and each vertex property is decoded from the records in place.
+    PCCMappedFile file( fileName );
+    if ( !file.isOpen() ) { return false; }
+    const char*  begin     = reinterpret_cast<const char*>( file.data() );
+    const char*  end       = begin + file.size();
+    const char   tag[]     = "end_header";
+    const char*  headerEnd = std::search( begin, end, tag, tag + sizeof( tag ) - 1 );
+    headerEnd              = std::find( headerEnd, end, '\n' );
+    if ( headerEnd == end ) {
+      std::cout << "Error: corrupted header!" << std::endl;
+      return false;
+    }
+    std::vector<size_t> offsets( attributeCount );
+    size_t              recordSize = 0;
+    for ( size_t a = 0; a < attributeCount; ++a ) {
+      offsets[a] = recordSize;
+      recordSize += attributesInfo[a].byteCount;
+    }
+    const uint8_t* records     = file.data() + ( headerEnd + 1 - begin );
+    const size_t   recordCount = ( std::min )( pointCount, size_t( end - ( headerEnd + 1 ) ) / recordSize );
+    const bool     swap        = isBigEndian != isBigEndianPlatform();
+    decodePlyReal( attributesInfo[indexX].byteCount, records + offsets[indexX], recordSize, recordCount, swap,
+                   [&]( size_t i, double value ) { positions_[i][0] = value; } );
+    decodePlyReal( attributesInfo[indexY].byteCount, records + offsets[indexY], recordSize, recordCount, swap,
+                   [&]( size_t i, double value ) { positions_[i][1] = value; } );
+    decodePlyReal( attributesInfo[indexZ].byteCount, records + offsets[indexZ], recordSize, recordCount, swap,
+                   [&]( size_t i, double value ) { positions_[i][2] = value; } );
+    if ( hasColors() ) {
+      decodePlyProperty<uint8_t>( records + offsets[indexR], recordSize, recordCount, false,
+                                  [&]( size_t i, uint8_t value ) { colors_[i][0] = value; } );
+      decodePlyProperty<uint8_t>( records + offsets[indexG], recordSize, recordCount, false,
+                                  [&]( size_t i, uint8_t value ) { colors_[i][1] = value; } );
+      decodePlyProperty<uint8_t>( records + offsets[indexB], recordSize, recordCount, false,
+                                  [&]( size_t i, uint8_t value ) { colors_[i][2] = value; } );
+    }
+    if ( hasNormals() ) {
+      decodePlyReal( 4, records + offsets[indexNX], recordSize, recordCount, swap,
+                     [&]( size_t i, double value ) { normals_[i][0] = value; } );
+      decodePlyReal( 4, records + offsets[indexNY], recordSize, recordCount, swap,
+                     [&]( size_t i, double value ) { normals_[i][1] = value; } );
+      decodePlyReal( 4, records + offsets[indexNZ], recordSize, recordCount, swap,
+                     [&]( size_t i, double value ) { normals_[i][2] = value; } );
+    }
+    if ( hasReflectances() ) {
+      if ( attributesInfo[indexReflectance].byteCount == 1 ) {
+        decodePlyProperty<uint8_t>( records + offsets[indexReflectance], recordSize, recordCount, false,
+                                    [&]( size_t i, uint8_t value ) { reflectances_[i] = value; } );
+      } else {
+        decodePlyProperty<uint16_t>( records + offsets[indexReflectance], recordSize, recordCount, swap,
+                                     [&]( size_t i, uint16_t value ) { reflectances_[i] = value; } );
       }
     }
   }
@@ -794,31 +938,60 @@ void PCCPointSet3::convertYUVToRGB() {  // BT709
   }
 }
 
-bool PCCPointSet3::transferColors( PCCPointSet3& target,
-                                   const int32_t searchRange,
-                                   const bool    losslessTexture,
-                                   const int     numNeighborsColorTransferFwd,
-                                   const int     numNeighborsColorTransferBwd,
-                                   const bool    useDistWeightedAverageFwd,
-                                   const bool    useDistWeightedAverageBwd,
-                                   const bool    skipAvgIfIdenticalSourcePointPresentFwd,
-                                   const bool    skipAvgIfIdenticalSourcePointPresentBwd,
-                                   const double  distOffsetFwd,
-                                   const double  distOffsetBwd,
-                                   double        maxGeometryDist2Fwd,
-                                   double        maxGeometryDist2Bwd,
-                                   double        maxColorDist2Fwd,
-                                   double        maxColorDist2Bwd,
-                                   const bool    excludeColorOutlier,
-                                   const double  thresholdColorOutlierDist ) const {
+// Gathers the candidates given by the source points to the target points in the backward direction of the color
+// transfers. The source points are searched concurrently by blocks of fixed size, then the candidates of the blocks
+// are appended to the lists of the target points in the order of the source points: the lists, their sorts and the
+// colors derived from them are the ones of a serial loop over the source points, whatever the number of threads.
+template <typename T, typename Search>
+static void gatherBackwardCandidates( const size_t                 pointCount,
+                                      std::vector<std::vector<T>>& candidates,
+                                      Search                       search ) {
+  const size_t                                   blockSize  = 4096;
+  const size_t                                   blockCount = ( pointCount + blockSize - 1 ) / blockSize;
+  std::vector<std::vector<std::pair<size_t, T>>> blocks( blockCount );
+  tbb::parallel_for( size_t( 0 ), blockCount, [&]( const size_t block ) {
+    PCCNNResult  result;
+    const size_t end = ( std::min )( pointCount, ( block + 1 ) * blockSize );
+    for ( size_t index = block * blockSize; index < end; ++index ) { search( index, result, blocks[block] ); }
+  } );
+  std::vector<size_t> counts( candidates.size(), 0 );
+  for ( const auto& block : blocks ) {
+    for ( const auto& candidate : block ) { counts[candidate.first]++; }
+  }
+  for ( size_t index = 0; index < candidates.size(); ++index ) { candidates[index].reserve( counts[index] ); }
+  for ( const auto& block : blocks ) {
+    for ( const auto& candidate : block ) { candidates[candidate.first].push_back( candidate.second ); }
+  }
+}
+
+bool PCCPointSet3::transferColors( PCCPointSet3&   target,
+                                   const int32_t   searchRange,
+                                   const bool      losslessTexture,
+                                   const int       numNeighborsColorTransferFwd,
+                                   const int       numNeighborsColorTransferBwd,
+                                   const bool      useDistWeightedAverageFwd,
+                                   const bool      useDistWeightedAverageBwd,
+                                   const bool      skipAvgIfIdenticalSourcePointPresentFwd,
+                                   const bool      skipAvgIfIdenticalSourcePointPresentBwd,
+                                   const double    distOffsetFwd,
+                                   const double    distOffsetBwd,
+                                   double          maxGeometryDist2Fwd,
+                                   double          maxGeometryDist2Bwd,
+                                   double          maxColorDist2Fwd,
+                                   double          maxColorDist2Bwd,
+                                   const bool      excludeColorOutlier,
+                                   const double    thresholdColorOutlierDist,
+                                   PCCKdTreeCache* kdTreeCache ) const {
   printf( "transferColors \n" );
   const auto&  source           = *this;
   const size_t pointCountSource = source.getPointCount();
   const size_t pointCountTarget = target.getPointCount();
   if ( ( pointCountSource == 0u ) || ( pointCountTarget == 0u ) || !source.hasColors() ) { return false; }
-  PCCKdTree kdtreeTarget( target );
-  PCCKdTree kdtreeSource( source );
   target.addColors();
+  auto             kdtreeTargetPtr = getKdTree( kdTreeCache, target );
+  auto             kdtreeSourcePtr = getKdTree( kdTreeCache, source );
+  const PCCKdTree& kdtreeTarget    = *kdtreeTargetPtr;
+  const PCCKdTree& kdtreeSource    = *kdtreeSourcePtr;
   std::vector<PCCColor3B> refinedColors1;
   refinedColors1.resize( pointCountTarget );
   maxGeometryDist2Fwd = ( maxGeometryDist2Fwd < 512 ) ? maxGeometryDist2Fwd : std::numeric_limits<double>::max();
@@ -831,94 +1004,98 @@ bool PCCPointSet3::transferColors( PCCPointSet3& target,
   // ==========================================================================================
   // for each target point indexed by index, derive the refined color as
   // refinedColors1[index]
-  PCCNNResult result;
-  for ( size_t index = 0; index < pointCountTarget; ++index ) {
-    kdtreeSource.search( target[index], numNeighborsColorTransferFwd, result );
-    // keep the points that satisfy geometry dist threshold
-    while ( true ) {
-      if ( result.size() == 1 ) { break; }
-      if ( result.dist( int( result.size() ) - 1 ) <= maxGeometryDist2Fwd ) { break; }
-      result.popBack();
-    }
-    bool isDone = false;
-    if ( skipAvgIfIdenticalSourcePointPresentFwd ) {
-      if ( result.dist( 0 ) < 0.0001 ) {
-        refinedColors1[index] = source.getColor( result.indices( 0 ) );
-        isDone                = true;
+  tbb::parallel_for( tbb::blocked_range<size_t>( 0, pointCountTarget ), [&]( const tbb::blocked_range<size_t>& range ) {
+    PCCNNResult result;
+    for ( size_t index = range.begin(); index < range.end(); ++index ) {
+      kdtreeSource.search( target[index], numNeighborsColorTransferFwd, result );
+      // keep the points that satisfy geometry dist threshold
+      while ( true ) {
+        if ( result.size() == 1 ) { break; }
+        if ( result.dist( int( result.size() ) - 1 ) <= maxGeometryDist2Fwd ) { break; }
+        result.popBack();
       }
-    }
-    if ( !isDone ) {
-      int nNN = static_cast<int>( result.size() );
-      while ( nNN > 0 && !isDone ) {
-        if ( nNN == 1 ) {
+      bool isDone = false;
+      if ( skipAvgIfIdenticalSourcePointPresentFwd ) {
+        if ( result.dist( 0 ) < 0.0001 ) {
           refinedColors1[index] = source.getColor( result.indices( 0 ) );
           isDone                = true;
         }
-        if ( !isDone ) {
-          std::vector<PCCVector3D> colors;
-          colors.resize( 0 );
-          colors.resize( nNN );
-          for ( int i = 0; i < nNN; ++i ) {
-            for ( int k = 0; k < 3; ++k ) { colors[i][k] = double( source.getColor( result.indices( i ) )[k] ); }
+      }
+      if ( !isDone ) {
+        int nNN = static_cast<int>( result.size() );
+        while ( nNN > 0 && !isDone ) {
+          if ( nNN == 1 ) {
+            refinedColors1[index] = source.getColor( result.indices( 0 ) );
+            isDone                = true;
           }
-          double maxColorDist2 = std::numeric_limits<double>::min();
-          for ( int i = 0; i < nNN; ++i ) {
-            for ( int j = i + 1; j < nNN; ++j ) {
-              const double dist2 = ( colors[i] - colors[j] ).getNorm2();
-              if ( dist2 > maxColorDist2 ) { maxColorDist2 = dist2; }
+          if ( !isDone ) {
+            std::vector<PCCVector3D> colors;
+            colors.resize( 0 );
+            colors.resize( nNN );
+            for ( int i = 0; i < nNN; ++i ) {
+              for ( int k = 0; k < 3; ++k ) { colors[i][k] = double( source.getColor( result.indices( i ) )[k] ); }
             }
-          }
-          if ( maxColorDist2 <= maxColorDist2Fwd ) {
-            PCCVector3D refinedColor( 0.0 );
-            if ( useDistWeightedAverageFwd ) {
-              double sumWeights{0.0};
-              for ( int i = 0; i < nNN; ++i ) {
-                const double weight = 1 / ( result.dist( i ) + distOffsetFwd );
-                for ( int k = 0; k < 3; ++k ) { refinedColor[k] += source.getColor( result.indices( i ) )[k] * weight; }
-                sumWeights += weight;
+            double maxColorDist2 = std::numeric_limits<double>::min();
+            for ( int i = 0; i < nNN; ++i ) {
+              for ( int j = i + 1; j < nNN; ++j ) {
+                const double dist2 = ( colors[i] - colors[j] ).getNorm2();
+                if ( dist2 > maxColorDist2 ) { maxColorDist2 = dist2; }
               }
-              refinedColor /= sumWeights;
-              if ( excludeColorOutlier ) {
-                PCCVector3D excludeOutlierRefinedColor( 0.0 );
-                size_t      excludeCount = 0;
-                sumWeights               = 0.0;
+            }
+            if ( maxColorDist2 <= maxColorDist2Fwd ) {
+              PCCVector3D refinedColor( 0.0 );
+              if ( useDistWeightedAverageFwd ) {
+                double sumWeights{0.0};
                 for ( int i = 0; i < nNN; ++i ) {
-                  double      dist     = 0.0;
-                  PCCColor3B  tmpColor = source.getColor( result.indices( i ) );
-                  PCCVector3D sourceColor( tmpColor[0], tmpColor[1], tmpColor[2] );
-                  dist = ( sourceColor - refinedColor ).getNorm2();
-                  if ( dist > thresholdColorOutlierDist * thresholdColorOutlierDist ) {
-                    excludeCount += 1;
-                    continue;
-                  }
                   const double weight = 1 / ( result.dist( i ) + distOffsetFwd );
                   for ( int k = 0; k < 3; ++k ) {
-                    excludeOutlierRefinedColor[k] += source.getColor( result.indices( i ) )[k] * weight;
+                    refinedColor[k] += source.getColor( result.indices( i ) )[k] * weight;
                   }
                   sumWeights += weight;
                 }
+                refinedColor /= sumWeights;
+                if ( excludeColorOutlier ) {
+                  PCCVector3D excludeOutlierRefinedColor( 0.0 );
+                  size_t      excludeCount = 0;
+                  sumWeights               = 0.0;
+                  for ( int i = 0; i < nNN; ++i ) {
+                    double      dist     = 0.0;
+                    PCCColor3B  tmpColor = source.getColor( result.indices( i ) );
+                    PCCVector3D sourceColor( tmpColor[0], tmpColor[1], tmpColor[2] );
+                    dist = ( sourceColor - refinedColor ).getNorm2();
+                    if ( dist > thresholdColorOutlierDist * thresholdColorOutlierDist ) {
+                      excludeCount += 1;
+                      continue;
+                    }
+                    const double weight = 1 / ( result.dist( i ) + distOffsetFwd );
+                    for ( int k = 0; k < 3; ++k ) {
+                      excludeOutlierRefinedColor[k] += source.getColor( result.indices( i ) )[k] * weight;
+                    }
+                    sumWeights += weight;
+                  }
 
-                if ( excludeCount != nNN && excludeCount != 0 ) {
-                  refinedColor = excludeOutlierRefinedColor / sumWeights;
+                  if ( excludeCount != nNN && excludeCount != 0 ) {
+                    refinedColor = excludeOutlierRefinedColor / sumWeights;
+                  }
                 }
+              } else {
+                for ( int i = 0; i < nNN; ++i ) {
+                  for ( int k = 0; k < 3; ++k ) { refinedColor[k] += source.getColor( result.indices( i ) )[k]; }
+                }
+                refinedColor /= nNN;
               }
-            } else {
-              for ( int i = 0; i < nNN; ++i ) {
-                for ( int k = 0; k < 3; ++k ) { refinedColor[k] += source.getColor( result.indices( i ) )[k]; }
+              for ( int k = 0; k < 3; ++k ) {
+                refinedColors1[index][k] = uint8_t( PCCClip( round( refinedColor[k] ), 0.0, 255.0 ) );
               }
-              refinedColor /= nNN;
-            }
-            for ( int k = 0; k < 3; ++k ) {
-              refinedColors1[index][k] = uint8_t( PCCClip( round( refinedColor[k] ), 0.0, 255.0 ) );
+              isDone = true;
+            } else {
+              --nNN;
             }
-            isDone = true;
-          } else {
-            --nNN;
           }
         }
       }
     }
-  }
+  } );
   // ==========================================================================================
   //                                  Backward direction
   // ==========================================================================================
@@ -930,23 +1107,24 @@ bool PCCPointSet3::transferColors( PCCPointSet3& target,
   std::vector<std::vector<DistColor8Bit>> refinedColorsDists2;
   refinedColorsDists2.resize( pointCountTarget );
   // populate refinedColorsDists2
-  for ( size_t index = 0; index < pointCountSource; ++index ) {
-    const PCCColor3B color = source.getColor( index );
-    kdtreeTarget.search( source[index], numNeighborsColorTransferBwd, result );
-    // keep the points that satisfy geometry dist threshold
-    for ( int i = 0; i < result.size(); ++i ) {
-      if ( result.dist( i ) <= maxGeometryDist2Bwd ) {
-        refinedColorsDists2[result.indices( i )].push_back( DistColor8Bit{result.dist( i ), color} );
-      }
-    }
-  }
+  gatherBackwardCandidates(
+      pointCountSource, refinedColorsDists2, [&]( const size_t index, PCCNNResult& result, auto& candidates ) {
+        const PCCColor3B color = source.getColor( index );
+        kdtreeTarget.search( source[index], numNeighborsColorTransferBwd, result );
+        // keep the points that satisfy geometry dist threshold
+        for ( int i = 0; i < result.size(); ++i ) {
+          if ( result.dist( i ) <= maxGeometryDist2Bwd ) {
+            candidates.emplace_back( result.indices( i ), DistColor8Bit{result.dist( i ), color} );
+          }
+        }
+      } );
   // sort refinedColorsDists2 according to distance
-  for ( size_t index = 0; index < pointCountTarget; ++index ) {
+  tbb::parallel_for( size_t( 0 ), pointCountTarget, [&]( const size_t index ) {
     std::sort( refinedColorsDists2[index].begin(), refinedColorsDists2[index].end(),
                []( DistColor8Bit& dc1, DistColor8Bit& dc2 ) { return dc1.dist < dc2.dist; } );
-  }
+  } );
   // compute centroid2
-  for ( size_t index = 0; index < pointCountTarget; ++index ) {
+  tbb::parallel_for( size_t( 0 ), pointCountTarget, [&]( const size_t index ) {
     const PCCColor3B color1       = refinedColors1[index];       // refined color derived in forward direction
     auto&            colorsDists2 = refinedColorsDists2[index];  // set of candidate points
                                                                  // derived in backward
@@ -1110,7 +1288,7 @@ bool PCCPointSet3::transferColors( PCCPointSet3& target,
         target.setColor( index, color1 );
       }
     }
-  }
+  } );
   return true;
 }
 
@@ -1153,108 +1331,116 @@ bool PCCPointSet3::transferColors16bitBP( PCCPointSet3& target,
   // ==========================================================================================
   // for each target point indexed by index, derive the refined color as
   // refinedColors1[index]
-  PCCNNResult result;
-  for ( size_t index = 0; index < pointCountTarget; ++index ) {
-    PCCColor16bit colorT16bit = target.getColor16bit( index );
-    for ( int k = 0; k < 3; ++k ) { refinedColors1[index][k] = colorT16bit[k]; }
-    if ( target.getBoundaryPointType( index ) == 3 ) {
-      kdtreeSource.search( target[index], numNeighborsColorTransferFwd, result );
-      if ( filterType == 1 ) {
-        for ( size_t rI = 0; rI < result.size(); ++rI ) {
-          auto indexInSource = result.indices( rI );
-          auto partIndex2    = partSource.addPoint( source[indexInSource] );
-          partSource.setColor( partIndex2, source.getColor( indexInSource ) );
-          partSource.setColor16bit( partIndex2, source.getColor16bit( indexInSource ) );
-          partSource.setParentPointIndex( partIndex2, indexInSource );
+  std::vector<std::vector<size_t>> partSourceIndices( filterType == 1 ? pointCountTarget : 0 );
+  tbb::parallel_for( tbb::blocked_range<size_t>( 0, pointCountTarget ), [&]( const tbb::blocked_range<size_t>& range ) {
+    PCCNNResult result;
+    for ( size_t index = range.begin(); index < range.end(); ++index ) {
+      PCCColor16bit colorT16bit = target.getColor16bit( index );
+      for ( int k = 0; k < 3; ++k ) { refinedColors1[index][k] = colorT16bit[k]; }
+      if ( target.getBoundaryPointType( index ) == 3 ) {
+        kdtreeSource.search( target[index], numNeighborsColorTransferFwd, result );
+        if ( filterType == 1 ) {
+          partSourceIndices[index].assign( result.indices(), result.indices() + result.size() );
         }
-      }
-      // keep the points that satisfy geometry dist threshold
-      while ( true ) {
-        if ( result.size() == 1 ) { break; }
-        if ( result.dist( int( result.size() ) - 1 ) <= maxGeometryDist2Fwd ) { break; }
-        result.popBack();
-      }
-      bool isDone = false;
-      if ( skipAvgIfIdenticalSourcePointPresentFwd ) {
-        if ( result.dist( 0 ) < 0.0001 ) {
-          refinedColors1[index] = source.getColor16bit( result.indices( 0 ) );
-          isDone                = true;
+        // keep the points that satisfy geometry dist threshold
+        while ( true ) {
+          if ( result.size() == 1 ) { break; }
+          if ( result.dist( int( result.size() ) - 1 ) <= maxGeometryDist2Fwd ) { break; }
+          result.popBack();
         }
-      }
-      if ( !isDone ) {
-        int nNN = static_cast<int>( result.count() );
-        while ( nNN > 0 && !isDone ) {
-          if ( nNN == 1 ) {
+        bool isDone = false;
+        if ( skipAvgIfIdenticalSourcePointPresentFwd ) {
+          if ( result.dist( 0 ) < 0.0001 ) {
             refinedColors1[index] = source.getColor16bit( result.indices( 0 ) );
             isDone                = true;
           }
-          if ( !isDone ) {
-            std::vector<PCCVector3D> colors;
-            colors.resize( 0 );
-            colors.resize( nNN );
-            for ( int i = 0; i < nNN; ++i ) {
-              for ( int k = 0; k < 3; ++k ) { colors[i][k] = double( source.getColor16bit( result.indices( i ) )[k] ); }
+        }
+        if ( !isDone ) {
+          int nNN = static_cast<int>( result.count() );
+          while ( nNN > 0 && !isDone ) {
+            if ( nNN == 1 ) {
+              refinedColors1[index] = source.getColor16bit( result.indices( 0 ) );
+              isDone                = true;
             }
-            double maxColorDist2 = std::numeric_limits<double>::min();
-            for ( int i = 0; i < nNN; ++i ) {
-              for ( int j = i + 1; j < nNN; ++j ) {
-                const double dist2 = ( colors[i] - colors[j] ).getNorm2();
-                if ( dist2 > maxColorDist2 ) { maxColorDist2 = dist2; }
+            if ( !isDone ) {
+              std::vector<PCCVector3D> colors;
+              colors.resize( 0 );
+              colors.resize( nNN );
+              for ( int i = 0; i < nNN; ++i ) {
+                for ( int k = 0; k < 3; ++k ) {
+                  colors[i][k] = double( source.getColor16bit( result.indices( i ) )[k] );
+                }
               }
-            }
-            if ( maxColorDist2 <= maxColorDist2Fwd ) {
-              PCCVector3D refinedColor( 0.0 );
-              if ( useDistWeightedAverageFwd ) {
-                double sumWeights{0.0};
-                for ( int i = 0; i < nNN; ++i ) {
-                  const double weight = 1 / ( result.dist( i ) + distOffsetFwd );
-                  for ( int k = 0; k < 3; ++k ) {
-                    refinedColor[k] += source.getColor16bit( result.indices( i ) )[k] * weight;
-                  }
-                  sumWeights += weight;
+              double maxColorDist2 = std::numeric_limits<double>::min();
+              for ( int i = 0; i < nNN; ++i ) {
+                for ( int j = i + 1; j < nNN; ++j ) {
+                  const double dist2 = ( colors[i] - colors[j] ).getNorm2();
+                  if ( dist2 > maxColorDist2 ) { maxColorDist2 = dist2; }
                 }
-                refinedColor /= sumWeights;
-                if ( excludeColorOutlier ) {
-                  PCCVector3D excludeOutlierRefinedColor( 0.0 );
-                  size_t      excludeCount = 0;
-                  sumWeights               = 0.0;
+              }
+              if ( maxColorDist2 <= maxColorDist2Fwd ) {
+                PCCVector3D refinedColor( 0.0 );
+                if ( useDistWeightedAverageFwd ) {
+                  double sumWeights{0.0};
                   for ( int i = 0; i < nNN; ++i ) {
-                    double        dist     = 0.0;
-                    PCCColor16bit tmpColor = source.getColor16bit( result.indices( i ) );
-                    PCCVector3D   sourceColor( tmpColor[0], tmpColor[1], tmpColor[2] );
-                    dist = ( sourceColor - refinedColor ).getNorm2();
-                    if ( dist > thresholdColorOutlierDist * thresholdColorOutlierDist * 256.0 * 256.0 ) {
-                      excludeCount += 1;
-                      continue;
-                    }
                     const double weight = 1 / ( result.dist( i ) + distOffsetFwd );
                     for ( int k = 0; k < 3; ++k ) {
-                      excludeOutlierRefinedColor[k] += source.getColor16bit( result.indices( i ) )[k] * weight;
+                      refinedColor[k] += source.getColor16bit( result.indices( i ) )[k] * weight;
                     }
                     sumWeights += weight;
                   }
+                  refinedColor /= sumWeights;
+                  if ( excludeColorOutlier ) {
+                    PCCVector3D excludeOutlierRefinedColor( 0.0 );
+                    size_t      excludeCount = 0;
+                    sumWeights               = 0.0;
+                    for ( int i = 0; i < nNN; ++i ) {
+                      double        dist     = 0.0;
+                      PCCColor16bit tmpColor = source.getColor16bit( result.indices( i ) );
+                      PCCVector3D   sourceColor( tmpColor[0], tmpColor[1], tmpColor[2] );
+                      dist = ( sourceColor - refinedColor ).getNorm2();
+                      if ( dist > thresholdColorOutlierDist * thresholdColorOutlierDist * 256.0 * 256.0 ) {
+                        excludeCount += 1;
+                        continue;
+                      }
+                      const double weight = 1 / ( result.dist( i ) + distOffsetFwd );
+                      for ( int k = 0; k < 3; ++k ) {
+                        excludeOutlierRefinedColor[k] += source.getColor16bit( result.indices( i ) )[k] * weight;
+                      }
+                      sumWeights += weight;
+                    }
 
-                  if ( excludeCount != nNN && excludeCount != 0 ) {
-                    refinedColor = excludeOutlierRefinedColor / sumWeights;
+                    if ( excludeCount != nNN && excludeCount != 0 ) {
+                      refinedColor = excludeOutlierRefinedColor / sumWeights;
+                    }
+                  }
+                } else {
+                  for ( int i = 0; i < nNN; ++i ) {
+                    for ( int k = 0; k < 3; ++k ) { refinedColor[k] += source.getColor16bit( result.indices( i ) )[k]; }
                   }
+                  refinedColor /= nNN;
                 }
-              } else {
-                for ( int i = 0; i < nNN; ++i ) {
-                  for ( int k = 0; k < 3; ++k ) { refinedColor[k] += source.getColor16bit( result.indices( i ) )[k]; }
+                for ( int k = 0; k < 3; ++k ) {
+                  refinedColors1[index][k] = uint16_t( PCCClip( round( refinedColor[k] ), 0.0, 65535.0 ) );
                 }
-                refinedColor /= nNN;
-              }
-              for ( int k = 0; k < 3; ++k ) {
-                refinedColors1[index][k] = uint16_t( PCCClip( round( refinedColor[k] ), 0.0, 65535.0 ) );
+                isDone = true;
+              } else {
+                --nNN;
               }
-              isDone = true;
-            } else {
-              --nNN;
             }
           }
         }
       }
     }
+  } );
+  // the neighbors of the target points are appended to partSource in the order of the target points
+  for ( size_t index = 0; index < partSourceIndices.size(); ++index ) {
+    for ( auto indexInSource : partSourceIndices[index] ) {
+      auto partIndex2 = partSource.addPoint( source[indexInSource] );
+      partSource.setColor( partIndex2, source.getColor( indexInSource ) );
+      partSource.setColor16bit( partIndex2, source.getColor16bit( indexInSource ) );
+      partSource.setParentPointIndex( partIndex2, indexInSource );
+    }
   }
   // ==========================================================================================
   //                                  Backward direction
@@ -1269,48 +1455,51 @@ bool PCCPointSet3::transferColors16bitBP( PCCPointSet3& target,
     refinedColorsDists2.resize( pointCountTarget );
     // populate refinedColorsDists2
     auto sampleSetPointCount = partSource.getPointCount();
-    for ( size_t index = 0; index < sampleSetPointCount; ++index ) {
-      const PCCColor16bit color = partSource.getColor16bit( index );
-      kdtreeTarget.search( partSource[index], numNeighborsColorTransferBwd, result );
-      // keep the points that satisfy geometry dist threshold
-      for ( int i = 0; i < result.size(); ++i ) {
-        if ( result.dist( i ) <= maxGeometryDist2Bwd ) {
-          if ( std::abs( color[0] - target.getColor16bit()[result.indices( i )][0] ) < 40 &&
-               std::abs( color[1] - target.getColor16bit()[result.indices( i )][1] ) < 40 &&
-               std::abs( color[2] - target.getColor16bit()[result.indices( i )][2] ) < 40 )
-            refinedColorsDists2[result.indices( i )].push_back( DistColor{
-                result.dist( i ), color, target[result.indices( i )], partSource.getParentPointIndex( index ), index} );
-        }
-      }
-    }
+    gatherBackwardCandidates(
+        sampleSetPointCount, refinedColorsDists2, [&]( const size_t index, PCCNNResult& result, auto& candidates ) {
+          const PCCColor16bit color = partSource.getColor16bit( index );
+          kdtreeTarget.search( partSource[index], numNeighborsColorTransferBwd, result );
+          // keep the points that satisfy geometry dist threshold
+          for ( int i = 0; i < result.size(); ++i ) {
+            if ( result.dist( i ) <= maxGeometryDist2Bwd ) {
+              if ( std::abs( color[0] - target.getColor16bit()[result.indices( i )][0] ) < 40 &&
+                   std::abs( color[1] - target.getColor16bit()[result.indices( i )][1] ) < 40 &&
+                   std::abs( color[2] - target.getColor16bit()[result.indices( i )][2] ) < 40 )
+                candidates.emplace_back( result.indices( i ),
+                                         DistColor{result.dist( i ), color, target[result.indices( i )],
+                                                   partSource.getParentPointIndex( index ), index} );
+            }
+          }
+        } );
 
     // sort refinedColorsDists2 according to distance
-    for ( size_t index = 0; index < pointCountTarget; ++index ) {
+    tbb::parallel_for( size_t( 0 ), pointCountTarget, [&]( const size_t index ) {
       std::sort( refinedColorsDists2[index].begin(), refinedColorsDists2[index].end(),
                  []( DistColor& dc1, DistColor& dc2 ) { return dc1.dist < dc2.dist; } );
-    }
+    } );
   } else {
     // populate refinedColorsDists2
     refinedColorsDists2.resize( pointCountTarget );
-    for ( size_t index = 0; index < pointCountSource; ++index ) {
-      const PCCColor16bit color = source.getColor16bit( index );
-      kdtreeTarget.search( source[index], numNeighborsColorTransferBwd, result );
-      // keep the points that satisfy geometry dist threshold
-      for ( int i = 0; i < result.size(); ++i ) {
-        if ( result.dist( i ) <= maxGeometryDist2Bwd ) {
-          refinedColorsDists2[result.indices( i )].push_back( DistColor{result.dist( i ), color} );
-        }
-      }
-    }
+    gatherBackwardCandidates(
+        pointCountSource, refinedColorsDists2, [&]( const size_t index, PCCNNResult& result, auto& candidates ) {
+          const PCCColor16bit color = source.getColor16bit( index );
+          kdtreeTarget.search( source[index], numNeighborsColorTransferBwd, result );
+          // keep the points that satisfy geometry dist threshold
+          for ( int i = 0; i < result.size(); ++i ) {
+            if ( result.dist( i ) <= maxGeometryDist2Bwd ) {
+              candidates.emplace_back( result.indices( i ), DistColor{result.dist( i ), color} );
+            }
+          }
+        } );
     // sort refinedColorsDists2 according to distance
-    for ( size_t index = 0; index < pointCountTarget; ++index ) {
+    tbb::parallel_for( size_t( 0 ), pointCountTarget, [&]( const size_t index ) {
       std::sort( refinedColorsDists2[index].begin(), refinedColorsDists2[index].end(),
                  []( DistColor& dc1, DistColor& dc2 ) { return dc1.dist < dc2.dist; } );
-    }
+    } );
   }
   // compute centroid2
-  for ( size_t index = 0; index < pointCountTarget; ++index ) {
-    if ( filterType == 1 && target.getBoundaryPointType( index ) != 3 ) continue;
+  tbb::parallel_for( size_t( 0 ), pointCountTarget, [&]( const size_t index ) {
+    if ( filterType == 1 && target.getBoundaryPointType( index ) != 3 ) return;
     const PCCColor16bit color1       = refinedColors1[index];       // refined color derived in forward direction
     auto&               colorsDists2 = refinedColorsDists2[index];  // set of candidate points
                                                                     // derived in backward
@@ -1474,7 +1663,7 @@ bool PCCPointSet3::transferColors16bitBP( PCCPointSet3& target,
         target.setColor16bit( index, color1 );
       }
     }
-  }
+  } );
   return true;
 }
 
@@ -1512,8 +1701,8 @@ bool PCCPointSet3::transferColorsBackward16bitBP( PCCPointSet3& target,
   // ==========================================================================================
   // backward search first
   // ==========================================================================================
-  PCCNNResult       result;
-  std::vector<bool> newValueDecided;
+  // one flag per byte: the flags of different points are set concurrently
+  std::vector<uint8_t> newValueDecided;
   newValueDecided.resize( pointCountTarget, false );
   std::vector<PCCColor16bit> refinedColors1;
   refinedColors1.resize( pointCountTarget );
@@ -1537,49 +1726,51 @@ bool PCCPointSet3::transferColorsBackward16bitBP( PCCPointSet3& target,
   std::vector<std::vector<DistColor>> refinedColorsDists2;
   // populate refinedColorsDists2
   refinedColorsDists2.resize( pointCountTarget );
-  for ( size_t index = 0; index < pointCountSource; ++index ) {
-    const PCCColor16bit color = source.getColor16bit( index );
-    if ( target.getBoundaryPointType( index ) != 3 ) continue;
-    if ( filterType == 9 ) {
-      kdtreePartTarget.search( source[index], numNeighborsColorTransferBwd, result );
-      for ( int i = 0; i < result.count(); ++i ) {
-        if ( result.dist( i ) <= maxGeometryDist2Bwd &&
-             ( std::abs( color[0] - partTarget.getColor16bit()[result.indices( i )][0] ) < 40 &&
-               std::abs( color[1] - partTarget.getColor16bit()[result.indices( i )][1] ) < 40 &&
-               std::abs( color[2] - partTarget.getColor16bit()[result.indices( i )][2] ) < 40 ) ) {
-          auto indexInTarget = partTarget.getParentPointIndex( result.indices( i ) );
-          if ( target.getBoundaryPointType( indexInTarget ) != 3 ) {
-            printf( "something wrong!!\n" );
-            assert( 0 );
-            exit( 0 );
+  gatherBackwardCandidates(
+      pointCountSource, refinedColorsDists2, [&]( const size_t index, PCCNNResult& result, auto& candidates ) {
+        const PCCColor16bit color = source.getColor16bit( index );
+        if ( target.getBoundaryPointType( index ) != 3 ) return;
+        if ( filterType == 9 ) {
+          kdtreePartTarget.search( source[index], numNeighborsColorTransferBwd, result );
+          for ( int i = 0; i < result.count(); ++i ) {
+            if ( result.dist( i ) <= maxGeometryDist2Bwd &&
+                 ( std::abs( color[0] - partTarget.getColor16bit()[result.indices( i )][0] ) < 40 &&
+                   std::abs( color[1] - partTarget.getColor16bit()[result.indices( i )][1] ) < 40 &&
+                   std::abs( color[2] - partTarget.getColor16bit()[result.indices( i )][2] ) < 40 ) ) {
+              auto indexInTarget = partTarget.getParentPointIndex( result.indices( i ) );
+              if ( target.getBoundaryPointType( indexInTarget ) != 3 ) {
+                printf( "something wrong!!\n" );
+                assert( 0 );
+                exit( 0 );
+              }
+              candidates.emplace_back( indexInTarget,
+                                       DistColor{result.dist( i ), color, partTarget[result.indices( i )],
+                                                 indexInTarget, result.indices( i )} );
+            }
+          }
+        } else {
+          kdtreeTarget.search( source[index], numNeighborsColorTransferBwd, result );
+          // keep the points that satisfy geometry dist threshold
+          for ( int i = 0; i < result.count(); ++i ) {
+            if ( result.dist( i ) <= maxGeometryDist2Bwd ) {
+              candidates.emplace_back( result.indices( i ), DistColor{result.dist( i ), color} );
+            }
           }
-          refinedColorsDists2[indexInTarget].push_back(
-              DistColor{result.dist( i ), color, partTarget[result.indices( i )], indexInTarget, result.indices( i )} );
-        }
-      }
-    } else {
-      kdtreeTarget.search( source[index], numNeighborsColorTransferBwd, result );
-      // keep the points that satisfy geometry dist threshold
-      for ( int i = 0; i < result.count(); ++i ) {
-        if ( result.dist( i ) <= maxGeometryDist2Bwd ) {
-          refinedColorsDists2[result.indices( i )].push_back( DistColor{result.dist( i ), color} );
         }
-      }
-    }
-  }
+      } );
 
-  for ( size_t index = 0; index < pointCountTarget; ++index ) {
+  tbb::parallel_for( size_t( 0 ), pointCountTarget, [&]( const size_t index ) {
     std::sort( refinedColorsDists2[index].begin(), refinedColorsDists2[index].end(),
                []( DistColor& dc1, DistColor& dc2 ) { return dc1.dist < dc2.dist; } );
-  }
+  } );
 
   // compute centroid2
-  for ( size_t index = 0; index < pointCountTarget; ++index ) {
+  tbb::parallel_for( size_t( 0 ), pointCountTarget, [&]( const size_t index ) {
     if ( target.getBoundaryPointType( index ) != 3 ) {
       newValueDecided[index] = true;
-      continue;
+      return;
     }
-    if ( refinedColorsDists2[index].empty() ) { continue; }
+    if ( refinedColorsDists2[index].empty() ) { return; }
     auto&       colorsDists2 = refinedColorsDists2[index];
     bool        isDone       = false;
     PCCVector3D centroid2( 0.0 );
@@ -1664,7 +1855,7 @@ bool PCCPointSet3::transferColorsBackward16bitBP( PCCPointSet3& target,
     for ( size_t k = 0; k < 3; ++k ) { color0[k] = PCCClip( round( centroid2[k] ), 0.0, 65535.0 ); }
     target.setColor16bit( index, PCCColor16bit( uint16_t( color0[0] ), uint16_t( color0[1] ), uint16_t( color0[2] ) ) );
     newValueDecided[index] = true;
-  }
+  } );
 
   // ==========================================================================================
   //                                     Forward direction
@@ -1672,103 +1863,108 @@ bool PCCPointSet3::transferColorsBackward16bitBP( PCCPointSet3& target,
   // for each target point indexed by index, derive the refined color as
   // refinedColors1[index]
 
-  for ( size_t index = 0; index < pointCountTarget; ++index ) {
-    PCCColor16bit colorT16bit = target.getColor16bit( index );
-    for ( int k = 0; k < 3; ++k ) { refinedColors1[index][k] = colorT16bit[k]; }
-    if ( target.getBoundaryPointType( index ) == 3 && newValueDecided[index] == false ) {
-      kdtreeSource.search( target[index], numNeighborsColorTransferFwd, result );
-      // keep the points that satisfy geometry dist threshold
-      while ( true ) {
-        if ( result.count() == 1 ) { break; }
-        if ( result.dist( int( result.size() ) - 1 ) <= maxGeometryDist2Fwd ) { break; }
-        result.popBack();
-      }
-      bool isDone = false;
-      if ( skipAvgIfIdenticalSourcePointPresentFwd ) {
-        if ( result.dist( 0 ) < 0.0001 ) {
-          refinedColors1[index] = source.getColor16bit( result.indices( 0 ) );
-          isDone                = true;
+  tbb::parallel_for( tbb::blocked_range<size_t>( 0, pointCountTarget ), [&]( const tbb::blocked_range<size_t>& range ) {
+    PCCNNResult result;
+    for ( size_t index = range.begin(); index < range.end(); ++index ) {
+      PCCColor16bit colorT16bit = target.getColor16bit( index );
+      for ( int k = 0; k < 3; ++k ) { refinedColors1[index][k] = colorT16bit[k]; }
+      if ( target.getBoundaryPointType( index ) == 3 && newValueDecided[index] == false ) {
+        kdtreeSource.search( target[index], numNeighborsColorTransferFwd, result );
+        // keep the points that satisfy geometry dist threshold
+        while ( true ) {
+          if ( result.count() == 1 ) { break; }
+          if ( result.dist( int( result.size() ) - 1 ) <= maxGeometryDist2Fwd ) { break; }
+          result.popBack();
         }
-      }
-      if ( !isDone ) {
-        int nNN = static_cast<int>( result.count() );
-        while ( nNN > 0 && !isDone ) {
-          if ( nNN == 1 ) {
+        bool isDone = false;
+        if ( skipAvgIfIdenticalSourcePointPresentFwd ) {
+          if ( result.dist( 0 ) < 0.0001 ) {
             refinedColors1[index] = source.getColor16bit( result.indices( 0 ) );
             isDone                = true;
           }
-          if ( !isDone ) {
-            std::vector<PCCVector3D> colors;
-            colors.resize( 0 );
-            colors.resize( nNN );
-            for ( int i = 0; i < nNN; ++i ) {
-              for ( int k = 0; k < 3; ++k ) { colors[i][k] = double( source.getColor16bit( result.indices( i ) )[k] ); }
+        }
+        if ( !isDone ) {
+          int nNN = static_cast<int>( result.count() );
+          while ( nNN > 0 && !isDone ) {
+            if ( nNN == 1 ) {
+              refinedColors1[index] = source.getColor16bit( result.indices( 0 ) );
+              isDone                = true;
             }
-            double maxColorDist2 = std::numeric_limits<double>::min();
-            for ( int i = 0; i < nNN; ++i ) {
-              for ( int j = i + 1; j < nNN; ++j ) {
-                const double dist2 = ( colors[i] - colors[j] ).getNorm2();
-                if ( dist2 > maxColorDist2 ) { maxColorDist2 = dist2; }
+            if ( !isDone ) {
+              std::vector<PCCVector3D> colors;
+              colors.resize( 0 );
+              colors.resize( nNN );
+              for ( int i = 0; i < nNN; ++i ) {
+                for ( int k = 0; k < 3; ++k ) {
+                  colors[i][k] = double( source.getColor16bit( result.indices( i ) )[k] );
+                }
               }
-            }
-            if ( maxColorDist2 <= maxColorDist2Fwd ) {
-              PCCVector3D refinedColor( 0.0 );
-              if ( useDistWeightedAverageFwd ) {
-                double sumWeights{0.0};
-                for ( int i = 0; i < nNN; ++i ) {
-                  const double weight = 1 / ( result.dist( i ) + distOffsetFwd );
-                  for ( int k = 0; k < 3; ++k ) {
-                    refinedColor[k] += source.getColor16bit( result.indices( i ) )[k] * weight;
-                  }
-                  sumWeights += weight;
+              double maxColorDist2 = std::numeric_limits<double>::min();
+              for ( int i = 0; i < nNN; ++i ) {
+                for ( int j = i + 1; j < nNN; ++j ) {
+                  const double dist2 = ( colors[i] - colors[j] ).getNorm2();
+                  if ( dist2 > maxColorDist2 ) { maxColorDist2 = dist2; }
                 }
-                refinedColor /= sumWeights;
-                if ( excludeColorOutlier ) {
-                  PCCVector3D excludeOutlierRefinedColor( 0.0 );
-                  size_t      excludeCount = 0;
-                  sumWeights               = 0.0;
+              }
+              if ( maxColorDist2 <= maxColorDist2Fwd ) {
+                PCCVector3D refinedColor( 0.0 );
+                if ( useDistWeightedAverageFwd ) {
+                  double sumWeights{0.0};
                   for ( int i = 0; i < nNN; ++i ) {
-                    double        dist     = 0.0;
-                    PCCColor16bit tmpColor = source.getColor16bit( result.indices( i ) );
-                    PCCVector3D   sourceColor( tmpColor[0], tmpColor[1], tmpColor[2] );
-                    dist = ( sourceColor - refinedColor ).getNorm2();
-                    if ( dist > thresholdColorOutlierDist * thresholdColorOutlierDist * 256.0 * 256.0 ) {
-                      excludeCount += 1;
-                      continue;
-                    }
                     const double weight = 1 / ( result.dist( i ) + distOffsetFwd );
                     for ( int k = 0; k < 3; ++k ) {
-                      excludeOutlierRefinedColor[k] += source.getColor16bit( result.indices( i ) )[k] * weight;
+                      refinedColor[k] += source.getColor16bit( result.indices( i ) )[k] * weight;
                     }
                     sumWeights += weight;
                   }
+                  refinedColor /= sumWeights;
+                  if ( excludeColorOutlier ) {
+                    PCCVector3D excludeOutlierRefinedColor( 0.0 );
+                    size_t      excludeCount = 0;
+                    sumWeights               = 0.0;
+                    for ( int i = 0; i < nNN; ++i ) {
+                      double        dist     = 0.0;
+                      PCCColor16bit tmpColor = source.getColor16bit( result.indices( i ) );
+                      PCCVector3D   sourceColor( tmpColor[0], tmpColor[1], tmpColor[2] );
+                      dist = ( sourceColor - refinedColor ).getNorm2();
+                      if ( dist > thresholdColorOutlierDist * thresholdColorOutlierDist * 256.0 * 256.0 ) {
+                        excludeCount += 1;
+                        continue;
+                      }
+                      const double weight = 1 / ( result.dist( i ) + distOffsetFwd );
+                      for ( int k = 0; k < 3; ++k ) {
+                        excludeOutlierRefinedColor[k] += source.getColor16bit( result.indices( i ) )[k] * weight;
+                      }
+                      sumWeights += weight;
+                    }
 
-                  if ( excludeCount != nNN && excludeCount != 0 ) {
-                    refinedColor = excludeOutlierRefinedColor / sumWeights;
+                    if ( excludeCount != nNN && excludeCount != 0 ) {
+                      refinedColor = excludeOutlierRefinedColor / sumWeights;
+                    }
+                  }
+                } else {
+                  for ( int i = 0; i < nNN; ++i ) {
+                    for ( int k = 0; k < 3; ++k ) { refinedColor[k] += source.getColor16bit( result.indices( i ) )[k]; }
                   }
+                  refinedColor /= nNN;
                 }
-              } else {
-                for ( int i = 0; i < nNN; ++i ) {
-                  for ( int k = 0; k < 3; ++k ) { refinedColor[k] += source.getColor16bit( result.indices( i ) )[k]; }
+                for ( int k = 0; k < 3; ++k ) {
+                  refinedColors1[index][k] = uint16_t( PCCClip( round( refinedColor[k] ), 0.0, 65535.0 ) );
                 }
-                refinedColor /= nNN;
-              }
-              for ( int k = 0; k < 3; ++k ) {
-                refinedColors1[index][k] = uint16_t( PCCClip( round( refinedColor[k] ), 0.0, 65535.0 ) );
+                isDone = true;
+              } else {
+                --nNN;
               }
-              isDone = true;
-            } else {
-              --nNN;
             }
-          }
-        }  // while
-      }    //! isDone
+          }  // while
+        }    //! isDone
 
-      target.setColor16bit( index,
-                            PCCColor16bit( uint16_t( refinedColors1[index][0] ), uint16_t( refinedColors1[index][1] ),
-                                           uint16_t( refinedColors1[index][2] ) ) );
-    }  // if ( target.getBoundaryPointType( index ) == 3 && newValueDecided[ index ] == false )
-  }    // index
+        target.setColor16bit( index,
+                              PCCColor16bit( uint16_t( refinedColors1[index][0] ), uint16_t( refinedColors1[index][1] ),
+                                             uint16_t( refinedColors1[index][2] ) ) );
+      }  // if ( target.getBoundaryPointType( index ) == 3 && newValueDecided[ index ] == false )
+    }
+  } );
 
   return true;
 }
@@ -2325,7 +2521,7 @@ void PCCPointSet3::copyNormals( const PCCPointSet3& sourceWithNormal ) {
   }
 }
 
-void PCCPointSet3::scaleNormals( const PCCPointSet3& sourceWithNormal ) {
+void PCCPointSet3::scaleNormals( const PCCPointSet3& sourceWithNormal, PCCKdTreeCache* kdTreeCache ) {
   if ( !sourceWithNormal.withNormals_ ) {
     std::cerr << "Normal object don't have normals \n" << std::endl;
     exit( -1 );
@@ -2335,15 +2531,15 @@ void PCCPointSet3::scaleNormals( const PCCPointSet3& sourceWithNormal ) {
   count.resize( getPointCount(), 0 );
   const size_t num_results_max  = 30;
   const size_t num_results_incr = 5;
-  PCCKdTree    kdtreeSrc( sourceWithNormal );
-  PCCKdTree    kdtreeDst( *this );
+  auto         kdtreeSrc        = getKdTree( kdTreeCache, sourceWithNormal );
+  auto         kdtreeDst        = getKdTree( kdTreeCache, *this );
   PCCNNResult  result;
   for ( size_t i = 0; i < sourceWithNormal.getPointCount(); ++i ) {
     // For point 'i' in A, find its nearest neighbor in B. store it in 'j'
     size_t num_results = 0;
     do {
       num_results += num_results_incr;
-      kdtreeDst.search( sourceWithNormal.positions_[i], num_results, result );
+      kdtreeDst->search( sourceWithNormal.positions_[i], num_results, result );
     } while ( result.dist( 0 ) == result.dist( num_results - 1 ) && num_results + num_results_incr <= num_results_max );
     for ( size_t j = 0; j < result.size(); ++j ) {
       if ( result.dist( 0 ) == result.dist( j ) ) {
@@ -2365,7 +2561,7 @@ void PCCPointSet3::scaleNormals( const PCCPointSet3& sourceWithNormal ) {
       size_t num_results = 0;
       do {
         num_results += num_results_incr;
-        kdtreeSrc.search( positions_[i], num_results, result );
+        kdtreeSrc->search( positions_[i], num_results, result );
       } while ( result.dist( 0 ) == result.dist( num_results - 1 ) &&
                 num_results + num_results_incr <= num_results_max );
       size_t num = 0;
@@ -0,0 +1,85 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "PCCCommon.h"
+
+#include "PCCPointSetComponents.h"
+
+using namespace pcc;
+
+void PCCPointSetComponents::init( const PCCPointSet3& pointSet, const bool withColors ) {
+  const size_t pointCount = pointSet.getPointCount();
+  for ( auto& positions : positions_ ) { positions.resize( pointCount ); }
+  PCCType* x = positions_[0].data();
+  PCCType* y = positions_[1].data();
+  PCCType* z = positions_[2].data();
+  for ( size_t i = 0; i < pointCount; ++i ) {
+    const PCCPoint3D position = pointSet[i];
+    x[i]                      = position[0];
+    y[i]                      = position[1];
+    z[i]                      = position[2];
+  }
+  if ( withColors && pointSet.hasColors() ) {
+    for ( auto& colors : colors_ ) { colors.resize( pointCount ); }
+    uint8_t* r = colors_[0].data();
+    uint8_t* g = colors_[1].data();
+    uint8_t* b = colors_[2].data();
+    for ( size_t i = 0; i < pointCount; ++i ) {
+      const PCCColor3B color = pointSet.getColor( i );
+      r[i]                   = color[0];
+      g[i]                   = color[1];
+      b[i]                   = color[2];
+    }
+  } else {
+    for ( auto& colors : colors_ ) { PCCAlignedVector<uint8_t>().swap( colors ); }
+  }
+}
+
+void PCCPointSetComponents::clear() {
+  for ( auto& positions : positions_ ) { PCCAlignedVector<PCCType>().swap( positions ); }
+  for ( auto& colors : colors_ ) { PCCAlignedVector<uint8_t>().swap( colors ); }
+}
+
+void PCCPointSetComponents::computeBoundingBox( PCCPoint3D& min, PCCPoint3D& max ) const {
+  const size_t pointCount = getPointCount();
+  for ( size_t k = 0; k < 3; ++k ) {
+    const PCCType* values = positions_[k].data();
+    PCCType        low    = ( std::numeric_limits<PCCType>::max )();
+    PCCType        high   = ( std::numeric_limits<PCCType>::lowest )();
+    for ( size_t i = 0; i < pointCount; ++i ) {
+      low  = values[i] < low ? values[i] : low;
+      high = values[i] > high ? values[i] : high;
+    }
+    min[k] = low;
+    max[k] = high;
+  }
+}
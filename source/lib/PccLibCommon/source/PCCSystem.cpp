@@ -40,6 +40,13 @@
 #include <memory>
 #include "PCCSystem.h"
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 //===========================================================================
 
 #if _WIN32
@@ -105,3 +112,47 @@ int pcc::system( const char* command ) noexcept {
 #endif
 
 //===========================================================================
+
+pcc::PCCMappedFile::PCCMappedFile( const std::string& fileName ) : data_( nullptr ), size_( 0 ) {
+#ifndef _WIN32
+  int fd = open( fileName.c_str(), O_RDONLY );
+  if ( fd < 0 ) { return; }
+  struct stat st;
+  if ( fstat( fd, &st ) == 0 && st.st_size > 0 ) {
+    void* address = mmap( nullptr, static_cast<size_t>( st.st_size ), PROT_READ, MAP_PRIVATE, fd, 0 );
+    if ( address != MAP_FAILED ) {
+      madvise( address, static_cast<size_t>( st.st_size ), MADV_SEQUENTIAL );
+      data_ = static_cast<const uint8_t*>( address );
+      size_ = static_cast<size_t>( st.st_size );
+    }
+  }
+  close( fd );
+  if ( data_ != nullptr ) { return; }
+#endif
+  std::ifstream file( fileName, std::ios::binary | std::ios::ate );
+  if ( !file.good() ) { return; }
+  buffer_.resize( static_cast<size_t>( file.tellg() ) );
+  file.seekg( 0 );
+  file.read( reinterpret_cast<char*>( buffer_.data() ), buffer_.size() );
+  if ( !buffer_.empty() ) {
+    data_ = buffer_.data();
+    size_ = buffer_.size();
+  }
+}
+
+pcc::PCCMappedFile::~PCCMappedFile() {
+#ifndef _WIN32
+  if ( data_ != nullptr && buffer_.empty() ) { munmap( const_cast<uint8_t*>( data_ ), size_ ); }
+#endif
+}
+
+void pcc::prefetchFile( const std::string& fileName ) {
+#if !defined( _WIN32 ) && !defined( __APPLE__ )
+  int fd = open( fileName.c_str(), O_RDONLY );
+  if ( fd < 0 ) { return; }
+  posix_fadvise( fd, 0, 0, POSIX_FADV_WILLNEED );
+  close( fd );
+#endif
+}
+
+//===========================================================================
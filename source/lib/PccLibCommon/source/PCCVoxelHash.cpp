@@ -0,0 +1,335 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "PCCCommon.h"
+
+#include "PCCKdTree.h"
+#include "PCCVoxelHash.h"
+
+using namespace pcc;
+
+static const uint32_t g_emptyEntry = ( std::numeric_limits<uint32_t>::max )();
+
+// Offset of the int16_t coordinates, so that the cell indexes are positive.
+static const int32_t g_coordinateOffset = 32768;
+
+// Size of the blocks of cells used for the queries far from the points.
+static const size_t g_blockShift = 3;
+
+// Number of cells visited ring by ring before switching to the blocks, the cost of which grows with their number.
+static const size_t g_ringBudget         = 64;
+static const size_t g_ringBudgetPerBlock = 4;
+
+static inline size_t hashKey( const uint64_t key ) { return size_t( ( key * 0x9E3779B97F4A7C15ULL ) >> 32 ); }
+
+void PCCVoxelHash::init( const PCCPointSet3& pointCloud ) {
+  const size_t pointCount = pointCloud.getPointCount();
+  cells_.clear();
+  blocks_.clear();
+  blockCells_.clear();
+  table_.clear();
+  indices_.clear();
+  positions_.clear();
+  if ( pointCount == 0 ) { return; }
+
+  // the cell size is increased until the cells hold a few points on average
+  std::vector<std::pair<uint64_t, uint32_t>> sortedKeys( pointCount );
+  size_t                                     cellCount = 0;
+  for ( shift_ = 0;; shift_++ ) {
+    for ( size_t i = 0; i < pointCount; i++ ) {
+      const auto index = getCellIndex( pointCloud[i] );
+      sortedKeys[i]    = std::make_pair( getKey( index[0], index[1], index[2] ), uint32_t( i ) );
+    }
+    std::sort( sortedKeys.begin(), sortedKeys.end() );
+    cellCount = 1;
+    for ( size_t i = 1; i < pointCount; i++ ) { cellCount += sortedKeys[i].first != sortedKeys[i - 1].first; }
+    if ( pointCount >= 4 * cellCount || shift_ == 8 ) { break; }
+  }
+
+  size_t capacity = 16;
+  while ( capacity < 2 * cellCount ) { capacity <<= 1; }
+  mask_ = capacity - 1;
+  table_.assign( capacity, g_emptyEntry );
+  cells_.reserve( cellCount );
+  indices_.resize( pointCount );
+  positions_.resize( pointCount );
+  minCell_ = PCCVector3<int32_t>( ( std::numeric_limits<int32_t>::max )() );
+  maxCell_ = PCCVector3<int32_t>( ( std::numeric_limits<int32_t>::min )() );
+  for ( size_t i = 0; i < pointCount; i++ ) {
+    indices_[i]   = sortedKeys[i].second;
+    positions_[i] = pointCloud[indices_[i]];
+    if ( i == 0 || sortedKeys[i].first != sortedKeys[i - 1].first ) {
+      const uint64_t key = sortedKeys[i].first;
+      Cell           cell;
+      cell.index_ = PCCVector3<int32_t>( int32_t( key >> 32 ), int32_t( ( key >> 16 ) & 0xFFFF ),
+                                         int32_t( key & 0xFFFF ) );
+      cell.begin_ = cell.end_ = uint32_t( i );
+      for ( size_t k = 0; k < 3; k++ ) {
+        minCell_[k] = ( std::min )( minCell_[k], cell.index_[k] );
+        maxCell_[k] = ( std::max )( maxCell_[k], cell.index_[k] );
+      }
+      size_t h = hashKey( key ) & mask_;
+      while ( table_[h] != g_emptyEntry ) { h = ( h + 1 ) & mask_; }
+      table_[h] = uint32_t( cells_.size() );
+      cells_.push_back( cell );
+    }
+    cells_.back().end_++;
+  }
+
+  std::vector<std::pair<uint64_t, uint32_t>> sortedBlocks( cells_.size() );
+  for ( size_t i = 0; i < cells_.size(); i++ ) {
+    const auto& index = cells_[i].index_;
+    const auto  key   = getKey( index[0] >> g_blockShift, index[1] >> g_blockShift, index[2] >> g_blockShift );
+    sortedBlocks[i]   = std::make_pair( key, uint32_t( i ) );
+  }
+  std::sort( sortedBlocks.begin(), sortedBlocks.end() );
+  blockCells_.resize( cells_.size() );
+  for ( size_t i = 0; i < sortedBlocks.size(); i++ ) {
+    blockCells_[i] = sortedBlocks[i].second;
+    if ( i == 0 || sortedBlocks[i].first != sortedBlocks[i - 1].first ) {
+      Cell block;
+      block.index_ = cells_[blockCells_[i]].index_;
+      for ( size_t k = 0; k < 3; k++ ) { block.index_[k] >>= g_blockShift; }
+      block.begin_ = block.end_ = uint32_t( i );
+      blocks_.push_back( block );
+    }
+    blocks_.back().end_++;
+  }
+}
+
+PCCVector3<int32_t> PCCVoxelHash::getCellIndex( const PCCPoint3D& point ) const {
+  return PCCVector3<int32_t>( ( point[0] + g_coordinateOffset ) >> shift_,
+                              ( point[1] + g_coordinateOffset ) >> shift_,
+                              ( point[2] + g_coordinateOffset ) >> shift_ );
+}
+
+const PCCVoxelHash::Cell* PCCVoxelHash::findCell( const int32_t x, const int32_t y, const int32_t z ) const {
+  const uint64_t key = getKey( x, y, z );
+  for ( size_t h = hashKey( key ) & mask_; table_[h] != g_emptyEntry; h = ( h + 1 ) & mask_ ) {
+    const Cell& cell = cells_[table_[h]];
+    if ( cell.index_[0] == x && cell.index_[1] == y && cell.index_[2] == z ) { return &cell; }
+  }
+  return nullptr;
+}
+
+int64_t PCCVoxelHash::getDistance2( const PCCVector3<int32_t>& index,
+                                    const size_t               shift,
+                                    const PCCPoint3D&          point ) const {
+  int64_t dist2 = 0;
+  for ( size_t k = 0; k < 3; k++ ) {
+    const int64_t lo = ( int64_t( index[k] ) << shift ) - g_coordinateOffset;
+    const int64_t hi = lo + ( int64_t( 1 ) << shift ) - 1;
+    const int64_t d  = point[k] < lo ? lo - point[k] : ( point[k] > hi ? point[k] - hi : 0 );
+    dist2 += d * d;
+  }
+  return dist2;
+}
+
+int32_t PCCVoxelHash::getRing( const Cell& cell, const PCCVector3<int32_t>& index ) const {
+  int32_t ring = 0;
+  for ( size_t k = 0; k < 3; k++ ) { ring = ( std::max )( ring, std::abs( cell.index_[k] - index[k] ) ); }
+  return ring;
+}
+
+int32_t PCCVoxelHash::getFirstRing( const PCCVector3<int32_t>& index ) const {
+  int32_t ring = 0;
+  for ( size_t k = 0; k < 3; k++ ) {
+    ring = ( std::max )( ring, ( std::max )( minCell_[k] - index[k], index[k] - maxCell_[k] ) );
+  }
+  return ring;
+}
+
+int32_t PCCVoxelHash::getRingCount( const PCCVector3<int32_t>& index ) const {
+  int32_t ring = 0;
+  for ( size_t k = 0; k < 3; k++ ) {
+    ring = ( std::max )( ring, ( std::max )( index[k] - minCell_[k], maxCell_[k] - index[k] ) );
+  }
+  return ring + 1;
+}
+
+size_t PCCVoxelHash::getRingCellCount( const PCCVector3<int32_t>& index, const int32_t ring ) const {
+  size_t count[2] = {1, 1};
+  for ( int32_t r = ring - 1; r <= ring; r++ ) {
+    for ( size_t k = 0; k < 3; k++ ) {
+      const int32_t size = ( std::min )( index[k] + r, maxCell_[k] ) - ( std::max )( index[k] - r, minCell_[k] ) + 1;
+      count[r - ring + 1] *= r < 0 || size < 0 ? 0 : size_t( size );
+    }
+  }
+  return count[1] - count[0];
+}
+
+bool PCCVoxelHash::useRing( const PCCVector3<int32_t>& index, const int32_t ring, size_t& budget ) const {
+  const size_t cellCount = getRingCellCount( index, ring );
+  if ( cellCount > budget ) { return false; }
+  budget -= cellCount;
+  return true;
+}
+
+template <typename F>
+void PCCVoxelHash::visitRing( const PCCVector3<int32_t>& index, const int32_t ring, F&& visit ) const {
+  const int32_t x0 = ( std::max )( index[0] - ring, minCell_[0] ), x1 = ( std::min )( index[0] + ring, maxCell_[0] );
+  const int32_t y0 = ( std::max )( index[1] - ring, minCell_[1] ), y1 = ( std::min )( index[1] + ring, maxCell_[1] );
+  const int32_t z0 = ( std::max )( index[2] - ring, minCell_[2] ), z1 = ( std::min )( index[2] + ring, maxCell_[2] );
+  // when the two faces orthogonal to the z axis are clipped, only the rows of the other faces are visited
+  const bool zFaces = index[2] - ring >= z0 || index[2] + ring <= z1;
+  for ( int32_t x = x0; x <= x1; x++ ) {
+    const bool    xFace = std::abs( x - index[0] ) == ring;
+    const int32_t yStep = xFace || zFaces ? 1 : 2 * ring;
+    for ( int32_t y = yStep == 1 ? y0 : index[1] - ring; y <= y1; y += yStep ) {
+      if ( y < y0 ) { continue; }
+      // inside the ring, only the two cells of the faces orthogonal to the z axis are visited
+      const bool    onFace = xFace || std::abs( y - index[1] ) == ring;
+      const int32_t zStep  = onFace ? 1 : 2 * ring;
+      for ( int32_t z = onFace ? z0 : index[2] - ring; z <= z1; z += zStep ) {
+        if ( z < z0 ) { continue; }
+        const Cell* cell = findCell( x, y, z );
+        if ( cell != nullptr ) { visit( *cell ); }
+      }
+    }
+  }
+}
+
+template <typename F>
+void PCCVoxelHash::visitFarCells( const PCCPoint3D&          point,
+                                  const PCCVector3<int32_t>& index,
+                                  const int32_t              ring,
+                                  int64_t&                   maxDist2,
+                                  F&&                        visit ) const {
+  thread_local std::vector<std::pair<int64_t, uint32_t>> blockOrder;
+  blockOrder.clear();
+  for ( size_t i = 0; i < blocks_.size(); i++ ) {
+    const int64_t dist2 = getDistance2( blocks_[i].index_, shift_ + g_blockShift, point );
+    if ( dist2 <= maxDist2 ) { blockOrder.emplace_back( dist2, uint32_t( i ) ); }
+  }
+  std::sort( blockOrder.begin(), blockOrder.end() );
+  for ( const auto& block : blockOrder ) {
+    if ( block.first > maxDist2 ) { break; }
+    for ( uint32_t i = blocks_[block.second].begin_; i < blocks_[block.second].end_; i++ ) {
+      const Cell& cell = cells_[blockCells_[i]];
+      if ( getRing( cell, index ) >= ring && getDistance2( cell.index_, shift_, point ) <= maxDist2 ) { visit( cell ); }
+    }
+  }
+}
+
+void PCCVoxelHash::search( const PCCPoint3D& point, const size_t num_results, PCCNNResult& results ) const {
+  // max-heap of the best ( squared distance, index ) pairs found so far
+  thread_local std::vector<std::pair<int64_t, uint32_t>> heap;
+  heap.clear();
+  int64_t maxDist2 = ( std::numeric_limits<int64_t>::max )();
+  auto    addCell  = [&]( const Cell& cell ) {
+    for ( uint32_t i = cell.begin_; i < cell.end_; i++ ) {
+      const int64_t dx        = int64_t( positions_[i][0] ) - point[0];
+      const int64_t dy        = int64_t( positions_[i][1] ) - point[1];
+      const int64_t dz        = int64_t( positions_[i][2] ) - point[2];
+      const auto    candidate = std::make_pair( dx * dx + dy * dy + dz * dz, indices_[i] );
+      if ( heap.size() < num_results ) {
+        heap.push_back( candidate );
+        std::push_heap( heap.begin(), heap.end() );
+      } else if ( candidate < heap.front() ) {
+        std::pop_heap( heap.begin(), heap.end() );
+        heap.back() = candidate;
+        std::push_heap( heap.begin(), heap.end() );
+      }
+    }
+    if ( heap.size() == num_results ) { maxDist2 = heap.front().first; }
+  };
+  if ( !cells_.empty() && num_results > 0 ) {
+    const auto    index     = getCellIndex( point );
+    const int32_t ringCount = getRingCount( index );
+    const int64_t cellSize  = int64_t( 1 ) << shift_;
+    size_t        budget    = g_ringBudget + g_ringBudgetPerBlock * blocks_.size();
+    bool          complete  = false;
+    int32_t       ring      = getFirstRing( index );
+    for ( ; ring < ringCount && useRing( index, ring, budget ); ring++ ) {
+      visitRing( index, ring, addCell );
+      // the points of the next rings are at least at ( ring * cellSize + 1 ) of the query point
+      const int64_t bound = ring * cellSize + 1;
+      if ( heap.size() == num_results && heap.front().first < bound * bound ) {
+        complete = true;
+        break;
+      }
+    }
+    if ( !complete ) { visitFarCells( point, index, ring, maxDist2, addCell ); }
+  }
+  std::sort_heap( heap.begin(), heap.end() );
+  results.resize( heap.size() );
+  for ( size_t i = 0; i < heap.size(); i++ ) {
+    results.indices( i ) = heap[i].second;
+    results.dist( i )    = double( heap[i].first );
+  }
+}
+
+void PCCVoxelHash::searchRadius( const PCCPoint3D& point,
+                                 const size_t      num_results,
+                                 const double      radius,
+                                 PCCNNResult&      results ) const {
+  thread_local std::vector<std::pair<int64_t, uint32_t>> found;
+  found.clear();
+  auto addCell = [&]( const Cell& cell ) {
+    for ( uint32_t i = cell.begin_; i < cell.end_; i++ ) {
+      const int64_t dx    = int64_t( positions_[i][0] ) - point[0];
+      const int64_t dy    = int64_t( positions_[i][1] ) - point[1];
+      const int64_t dz    = int64_t( positions_[i][2] ) - point[2];
+      const int64_t dist2 = dx * dx + dy * dy + dz * dz;
+      if ( double( dist2 ) < radius ) { found.emplace_back( dist2, indices_[i] ); }
+    }
+  };
+  if ( !cells_.empty() ) {
+    const auto    index     = getCellIndex( point );
+    const int32_t ringCount = getRingCount( index );
+    const int64_t cellSize  = int64_t( 1 ) << shift_;
+    size_t        budget    = g_ringBudget + g_ringBudgetPerBlock * blocks_.size();
+    bool          complete  = false;
+    int32_t       ring      = getFirstRing( index );
+    for ( ; ring < ringCount && useRing( index, ring, budget ); ring++ ) {
+      // the points of this ring are at least at ( ( ring - 1 ) * cellSize + 1 ) of the query point
+      const int64_t bound = ( ring - 1 ) * cellSize + 1;
+      if ( ring > 0 && double( bound * bound ) >= radius ) {
+        complete = true;
+        break;
+      }
+      visitRing( index, ring, addCell );
+    }
+    if ( !complete ) {
+      // largest integer squared distance below the radius
+      const int64_t maxRadius = int64_t( 1 ) << 62;
+      int64_t       maxDist2 = radius > double( maxRadius ) ? maxRadius : int64_t( std::ceil( radius ) ) - 1;
+      visitFarCells( point, index, ring, maxDist2, addCell );
+    }
+  }
+  const size_t count = ( std::min )( num_results, found.size() );
+  std::partial_sort( found.begin(), found.begin() + count, found.end() );
+  results.reserve( results.size() + count );
+  for ( size_t i = 0; i < count; i++ ) {
+    results.pushBack( std::make_pair( size_t( found[i].second ), double( found[i].first ) ) );
+  }
+}
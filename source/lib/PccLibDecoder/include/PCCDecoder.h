@@ -61,6 +61,11 @@ class PCCDecoder : public PCCCodec {
 
   int decode( PCCContext& context, PCCGroupOfFrames& reconstruct, int32_t atlasIndex );
 
+  // Two steps decoding of a GOF: decodeVideos() decodes the video sub-bitstreams of the context, then each frame can
+  // be reconstructed independently with decodeFrame() as soon as needed.
+  int decodeVideos( PCCContext& context, int32_t atlasIndex );
+  int decodeFrame( PCCContext& context, size_t frameIndex, PCCPointSet3& reconstruct, int32_t atlasIndex );
+
   void setParameters( const PCCDecoderParameters& params );
   void setPostProcessingSeiParameters( GeneratePointCloudParameters& gpcParams, PCCContext& context );
   void setGeneratePointCloudParameters( GeneratePointCloudParameters& gpcParams, PCCContext& context );
@@ -0,0 +1,103 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PCCStreamDecoder_h
+#define PCCStreamDecoder_h
+
+#include "PCCCommon.h"
+#include "PCCBitstream.h"
+#include "PCCSampleStreamV3CUnit.h"
+#include "PCCBitstreamReader.h"
+#include "PCCDecoderParameters.h"
+#include "PCCDecoder.h"
+#include "PCCPointSet.h"
+
+namespace pcc {
+
+class PCCContext;
+
+/**
+ * Push-style decoder: the bytes of a sample stream V3C bitstream are pushed by chunks of any size and the
+ * reconstructed point clouds are pulled one frame at a time. A group of frames is decoded when its last V3C unit has
+ * been received (i.e. the V3C parameter set of the next one or the end of the stream) and its frames are
+ * reconstructed on demand, by batches of as many frames as threads (nbThread) reconstructed concurrently, so at most
+ * one batch of reconstructed frames is kept in memory.
+ *
+ * Note: only the first atlas is decoded, and all the videos of a group of frames are decoded before its first frame
+ * is output: the latency of the first frame and the memory of the decoded videos grow with the group of frames size.
+ */
+class PCCStreamDecoder {
+ public:
+  PCCStreamDecoder();
+  ~PCCStreamDecoder();
+
+  void setParameters( const PCCDecoderParameters& params );
+  void setLogger( PCCLogger& logger );
+
+  // Appends bytes of the bitstream and extracts the complete V3C units.
+  void push( const uint8_t* data, const size_t size );
+
+  // Signals the end of the bitstream: the last group of frames can then be decoded.
+  void flush();
+
+  // Gets the next reconstructed frame: returns 1 if a frame has been output, 0 if more data must be pushed or if the
+  // bitstream is finished, or if its decoding has been stopped by V3C units that can't be decoded, and a negative
+  // value in case of error.
+  int pull( PCCPointSet3& frame );
+
+  size_t            getFrameCount() { return frameCount_; }
+  PCCBitstreamStat& getBitstreamStat() { return bitstreamStat_; }
+
+ private:
+  bool groupOfFramesAvailable();
+  int  decodeGroupOfFrames();
+  int  reconstructFrames();
+
+  PCCDecoder                  decoder_;
+  PCCBitstreamReader          bitstreamReader_;
+  PCCBitstream                bitstream_;
+  SampleStreamV3CUnit         ssvu_;
+  PCCBitstreamStat            bitstreamStat_;
+  std::unique_ptr<PCCContext> context_;
+  std::vector<PCCPointSet3>   reconstructs_;
+  bool                        headerRead_;
+  bool                        endOfStream_;
+  bool                        stopped_;
+  size_t                      nbThread_;
+  size_t                      frameIndex_;
+  size_t                      reconstructIndex_;
+  size_t                      frameCount_;
+};
+
+};  // namespace pcc
+
+#endif /* PCCStreamDecoder_h */
@@ -40,6 +40,7 @@
 #include "PCCVideoDecoder.h"
 #include "PCCGroupOfFrames.h"
 #include <tbb/tbb.h>
+#include <atomic>
 #include "PCCDecoder.h"
 
 using namespace pcc;
@@ -55,6 +56,26 @@ void PCCDecoder::setParameters( const PCCDecoderParameters& params ) { params_ =
 
 int PCCDecoder::decode( PCCContext& context, PCCGroupOfFrames& reconstructs, int32_t atlasIndex = 0 ) {
   if ( params_.nbThread_ > 0 ) { tbb::task_scheduler_init init( static_cast<int>( params_.nbThread_ ) ); }
+  int ret = decodeVideos( context, atlasIndex );
+  if ( ret != 0 ) { return ret; }
+  const size_t pcFrameCount = context.size();
+  reconstructs.setFrameCount( pcFrameCount );
+  printf( "generate point cloud of %zu frames \n", pcFrameCount );
+  fflush( stdout );
+  // the frames of the GOF are independent once the videos are decoded: they are reconstructed concurrently.
+  std::atomic<int> status( 0 );
+  tbb::task_arena  limited( params_.nbThread_ > 0 ? static_cast<int>( params_.nbThread_ )
+                                                  : static_cast<int>( tbb::task_arena::automatic ) );
+  limited.execute( [&] {
+    tbb::parallel_for( size_t( 0 ), pcFrameCount, [&]( const size_t frameIdx ) {
+      int retFrame = decodeFrame( context, frameIdx, reconstructs[frameIdx], atlasIndex );
+      if ( retFrame != 0 ) { status = retFrame; }
+    } );
+  } );
+  return status;
+}
+
+int PCCDecoder::decodeVideos( PCCContext& context, int32_t atlasIndex ) {
   createPatchFrameDataStructure( context );
 
   // Note JR: logger examples
@@ -71,7 +92,6 @@ int PCCDecoder::decode( PCCContext& context, PCCGroupOfFrames& reconstructs, int
   logger_->trace( LOG_TRACE, "test trace = %d \n", 19 );
 #endif
 
-  PCCVideoDecoder   videoDecoder;
   std::stringstream path;
   auto&             sps          = context.getVps();
   auto&             ai           = sps.getAttributeInformation( atlasIndex );
@@ -83,12 +103,13 @@ int PCCDecoder::decode( PCCContext& context, PCCGroupOfFrames& reconstructs, int
   auto&        plt                      = sps.getProfileTierLevel();
   const size_t mapCount                 = sps.getMapCountMinus1( atlasIndex ) + 1;
   auto&        videoBitstreamOM         = context.getVideoBitstream( VIDEO_OCCUPANCY );
-  int          decodedBitDepthOM        = 8;
   bool         isOCM444                 = false;
   bool         isGeometry444            = false;
   bool         isAuxiliarygeometry444   = false;
   bool         isAttributes444          = plt.getProfileCodecGroupIdc() == CODEC_GROUP_HEVC444;
   bool         isAuxiliaryAttributes444 = plt.getProfileCodecGroupIdc() == CODEC_GROUP_HEVC444;
+  bool         rawVideoPresent          = asps.getRawPatchEnabledFlag() && asps.getAuxiliaryVideoEnabledFlag() &&
+                             sps.getAuxiliaryVideoPresentFlag( atlasIndex );
 
   PCCCodecId occupancyCodecId = (PCCCodecId)oi.getOccupancyCodecId();
   PCCCodecId geometryCodecId  = (PCCCodecId)gi.getGeometryCodecId();
@@ -99,146 +120,187 @@ int PCCDecoder::decode( PCCContext& context, PCCGroupOfFrames& reconstructs, int
   printf( "CodecId occupancyCodecId = %d geometry = %d attribute = %d \n", (int)occupancyCodecId, (int)geometryCodecId,
           (int)attributeCodecId );
 
-  printf( " Decode O size = %zu \n", videoBitstreamOM.size() );
-  fflush( stdout );
-  videoDecoder.decompress( context.getVideoOccupancyMap(),      //  video
-                           path.str(),                          // path
-                           context.size(),                      // frameCount
-                           videoBitstreamOM,                    // bitstream
-                           params_.videoDecoderOccupancyPath_,  // decoderPath
-                           occupancyCodecId,                    // codecId
-                           context,                             // contexts
-                           decodedBitDepthOM,                   // bitDepth
-                           params_.keepIntermediateFiles_,      // keepIntermediateFiles
-                           isOCM444,                            // use444CodecIo
-                           false,                               // patchColorSubsampling
-                           "",                                  // inverseColorSpaceConversionConfig
-                           "" );                                // colorSpaceConversionPath
-  // converting the decoded bitdepth to the nominal bitdepth
-  context.getVideoOccupancyMap().convertBitdepth( decodedBitDepthOM, oi.getOccupancy2DBitdepthMinus1() + 1,
-                                                  oi.getOccupancyMSBAlignFlag() );
+  // The video sub-bitstreams are independent: each of them is decoded by a task with its own video decoder instance
+  // and the tasks run concurrently. The tasks writing the same video are gathered in one task to keep their order.
+  std::vector<std::function<void()>> videoDecodingTasks;
+  videoDecodingTasks.push_back( [&] {
+    printf( " Decode O size = %zu \n", videoBitstreamOM.size() );
+    fflush( stdout );
+    PCCVideoDecoder videoDecoder;
+    int             decodedBitDepthOM = 8;
+    videoDecoder.decompress( context.getVideoOccupancyMap(),      //  video
+                             path.str(),                          // path
+                             context.size(),                      // frameCount
+                             videoBitstreamOM,                    // bitstream
+                             params_.videoDecoderOccupancyPath_,  // decoderPath
+                             occupancyCodecId,                    // codecId
+                             context,                             // contexts
+                             decodedBitDepthOM,                   // bitDepth
+                             params_.keepIntermediateFiles_,      // keepIntermediateFiles
+                             isOCM444,                            // use444CodecIo
+                             false,                               // patchColorSubsampling
+                             "",                                  // inverseColorSpaceConversionConfig
+                             "" );                                // colorSpaceConversionPath
+    // converting the decoded bitdepth to the nominal bitdepth
+    context.getVideoOccupancyMap().convertBitdepth( decodedBitDepthOM, oi.getOccupancy2DBitdepthMinus1() + 1,
+                                                    oi.getOccupancyMSBAlignFlag() );
+  } );
 
   if ( sps.getMultipleMapStreamsPresentFlag( atlasIndex ) ) {
     context.getVideoGeometryMultiple().resize( sps.getMapCountMinus1( atlasIndex ) + 1 );
-    size_t totalGeoSize = 0;
     for ( uint32_t mapIndex = 0; mapIndex < sps.getMapCountMinus1( atlasIndex ) + 1; mapIndex++ ) {
-      std::cout << "*******Video Decoding: Geometry[" << mapIndex << "] ********" << std::endl;
-      int   decodedBitDepth = gi.getGeometry2dBitdepthMinus1() + 1;  // this should be extracted from the bitstream
-      auto  geometryIndex   = static_cast<PCCVideoType>( VIDEO_GEOMETRY_D0 + mapIndex );
-      auto& videoBitstream  = context.getVideoBitstream( geometryIndex );
-      videoDecoder.decompress( context.getVideoGeometryMultiple()[mapIndex], path.str(), pcFrameCount, videoBitstream,
-                               params_.videoDecoderGeometryPath_, geometryCodecId, context, decodedBitDepth,
-                               params_.keepIntermediateFiles_, isGeometry444 );
-      context.getVideoGeometryMultiple()[mapIndex].convertBitdepth(
-          decodedBitDepth, gi.getGeometry2dBitdepthMinus1() + 1, gi.getGeometryMSBAlignFlag() );
-      std::cout << "geometry D" << mapIndex << " video ->" << videoBitstream.size() << " B" << std::endl;
-      totalGeoSize += videoBitstream.size();
+      videoDecodingTasks.push_back( [&, mapIndex] {
+        std::cout << "*******Video Decoding: Geometry[" << mapIndex << "] ********" << std::endl;
+        PCCVideoDecoder videoDecoder;
+        int   decodedBitDepth = gi.getGeometry2dBitdepthMinus1() + 1;  // this should be extracted from the bitstream
+        auto  geometryIndex   = static_cast<PCCVideoType>( VIDEO_GEOMETRY_D0 + mapIndex );
+        auto& videoBitstream  = context.getVideoBitstream( geometryIndex );
+        videoDecoder.decompress( context.getVideoGeometryMultiple()[mapIndex], path.str(), pcFrameCount,
+                                 videoBitstream, params_.videoDecoderGeometryPath_, geometryCodecId, context,
+                                 decodedBitDepth, params_.keepIntermediateFiles_, isGeometry444 );
+        context.getVideoGeometryMultiple()[mapIndex].convertBitdepth(
+            decodedBitDepth, gi.getGeometry2dBitdepthMinus1() + 1, gi.getGeometryMSBAlignFlag() );
+        std::cout << "geometry D" << mapIndex << " video ->" << videoBitstream.size() << " B" << std::endl;
+      } );
     }
-    std::cout << "total geometry video ->" << totalGeoSize << " B" << std::endl;
   } else {
-    std::cout << "*******Video Decoding: Geometry ********" << std::endl;
-    int   decodedBitDepthGeo = gi.getGeometry2dBitdepthMinus1() + 1;
-    auto& videoBitstream     = context.getVideoBitstream( VIDEO_GEOMETRY );
-
-    printf( " Decode G size = %zu \n", videoBitstream.size() );
-    fflush( stdout );
-    videoDecoder.decompress( context.getVideoGeometryMultiple()[0],  //
-                             path.str(),                             //
-                             context.size() * mapCount,              //
-                             videoBitstream,                         //
-                             params_.videoDecoderGeometryPath_,      //
-                             geometryCodecId,                        //
-                             context,                                //
-                             decodedBitDepthGeo,                     //
-                             params_.keepIntermediateFiles_,         //
-                             isGeometry444 );
-    context.getVideoGeometryMultiple()[0].convertBitdepth( decodedBitDepthGeo, gi.getGeometry2dBitdepthMinus1() + 1,
-                                                           gi.getGeometryMSBAlignFlag() );
-    std::cout << "geometry video ->" << videoBitstream.size() << " B" << std::endl;
+    videoDecodingTasks.push_back( [&] {
+      std::cout << "*******Video Decoding: Geometry ********" << std::endl;
+      PCCVideoDecoder videoDecoder;
+      int             decodedBitDepthGeo = gi.getGeometry2dBitdepthMinus1() + 1;
+      auto&           videoBitstream     = context.getVideoBitstream( VIDEO_GEOMETRY );
+      printf( " Decode G size = %zu \n", videoBitstream.size() );
+      fflush( stdout );
+      videoDecoder.decompress( context.getVideoGeometryMultiple()[0],  //
+                               path.str(),                             //
+                               context.size() * mapCount,              //
+                               videoBitstream,                         //
+                               params_.videoDecoderGeometryPath_,      //
+                               geometryCodecId,                        //
+                               context,                                //
+                               decodedBitDepthGeo,                     //
+                               params_.keepIntermediateFiles_,         //
+                               isGeometry444 );
+      context.getVideoGeometryMultiple()[0].convertBitdepth( decodedBitDepthGeo, gi.getGeometry2dBitdepthMinus1() + 1,
+                                                             gi.getGeometryMSBAlignFlag() );
+      std::cout << "geometry video ->" << videoBitstream.size() << " B" << std::endl;
+    } );
   }
 
-  if ( asps.getRawPatchEnabledFlag() && asps.getAuxiliaryVideoEnabledFlag() &&
-       sps.getAuxiliaryVideoPresentFlag( atlasIndex ) ) {
-    std::cout << "*******Video Decoding: Aux Geometry ********" << std::endl;
-    int   decodedBitDepthMP = gi.getGeometry2dBitdepthMinus1() + 1;
-    auto& videoBitstreamMP  = context.getVideoBitstream( VIDEO_GEOMETRY_RAW );
-    videoDecoder.decompress( context.getVideoRawPointsGeometry(), path.str(), pcFrameCount, videoBitstreamMP,
-                             params_.videoDecoderGeometryPath_, geometryCodecId, context, decodedBitDepthMP,
-                             params_.keepIntermediateFiles_, isAuxiliarygeometry444 );
-    context.getVideoRawPointsGeometry().convertBitdepth( decodedBitDepthMP, gi.getGeometry2dBitdepthMinus1() + 1,
-                                                         gi.getGeometryMSBAlignFlag() );
-    std::cout << " raw points geometry -> " << videoBitstreamMP.size() << " B " << endl;
+  if ( rawVideoPresent ) {
+    videoDecodingTasks.push_back( [&] {
+      std::cout << "*******Video Decoding: Aux Geometry ********" << std::endl;
+      PCCVideoDecoder videoDecoder;
+      int             decodedBitDepthMP = gi.getGeometry2dBitdepthMinus1() + 1;
+      auto&           videoBitstreamMP  = context.getVideoBitstream( VIDEO_GEOMETRY_RAW );
+      videoDecoder.decompress( context.getVideoRawPointsGeometry(), path.str(), pcFrameCount, videoBitstreamMP,
+                               params_.videoDecoderGeometryPath_, geometryCodecId, context, decodedBitDepthMP,
+                               params_.keepIntermediateFiles_, isAuxiliarygeometry444 );
+      context.getVideoRawPointsGeometry().convertBitdepth( decodedBitDepthMP, gi.getGeometry2dBitdepthMinus1() + 1,
+                                                           gi.getGeometryMSBAlignFlag() );
+      std::cout << " raw points geometry -> " << videoBitstreamMP.size() << " B " << endl;
+    } );
   }
 
+  // right now we only have one attribute with a single partition, this should be generalized
   if ( ai.getAttributeCount() > 0 ) {
-    for ( int attrIndex = 0; attrIndex < sps.getAttributeInformation( atlasIndex ).getAttributeCount();
-          attrIndex++ ) {  // right now we only have one attribute, this should be generalized
-      int decodedBitdepthAttribute   = ai.getAttribute2dBitdepthMinus1( attrIndex ) + 1;
-      int decodedBitdepthAttributeMP = ai.getAttribute2dBitdepthMinus1( attrIndex ) + 1;
-      for ( int attrPartitionIndex = 0;
-            attrPartitionIndex <
-            sps.getAttributeInformation( atlasIndex ).getAttributeDimensionPartitionsMinus1( attrIndex ) + 1;
-            attrPartitionIndex++ ) {  // right now we have only one partition, this should be generalized
-        if ( sps.getMultipleMapStreamsPresentFlag( atlasIndex ) ) {
-          int sizeTextureVideo = 0;
-          context.getVideoTextureMultiple().resize( sps.getMapCountMinus1( atlasIndex ) + 1 );
-          // this allocation is considering only one attribute, with a single partition, but multiple streams
-          for ( uint32_t mapIndex = 0; mapIndex < sps.getMapCountMinus1( atlasIndex ) + 1; mapIndex++ ) {
-            // decompress T[mapIndex]
-            std::cout << "*******Video Decoding: Attribute [" << mapIndex << "] ********" << std::endl;
-            auto textureIndex =
-                static_cast<PCCVideoType>( VIDEO_TEXTURE_T0 + attrPartitionIndex + MAX_NUM_ATTR_PARTITIONS * mapIndex );
-            auto& videoBitstream = context.getVideoBitstream( textureIndex );
-            videoDecoder.decompress( context.getVideoTextureMultiple()[mapIndex], path.str(), context.size(),
-                                     videoBitstream, params_.videoDecoderAttributePath_, attributeCodecId, context,
-                                     ai.getAttribute2dBitdepthMinus1( 0 ) + 1, params_.keepIntermediateFiles_,
-                                     isAttributes444, params_.patchColorSubsampling_,
-                                     params_.inverseColorSpaceConversionConfig_, params_.colorSpaceConversionPath_ );
-            std::cout << "texture T" << mapIndex << " video ->" << videoBitstream.size() << " B" << std::endl;
-            sizeTextureVideo += videoBitstream.size();
+    const size_t attributeCount = ai.getAttributeCount();
+    if ( sps.getMultipleMapStreamsPresentFlag( atlasIndex ) ) {
+      context.getVideoTextureMultiple().resize( sps.getMapCountMinus1( atlasIndex ) + 1 );
+    }
+    const size_t textureVideoCount =
+        sps.getMultipleMapStreamsPresentFlag( atlasIndex ) ? sps.getMapCountMinus1( atlasIndex ) + 1 : 1;
+    for ( size_t mapIndex = 0; mapIndex < textureVideoCount; mapIndex++ ) {
+      videoDecodingTasks.push_back( [&, mapIndex] {
+        PCCVideoDecoder videoDecoder;
+        for ( size_t attrIndex = 0; attrIndex < attributeCount; attrIndex++ ) {
+          int decodedBitdepthAttribute = ai.getAttribute2dBitdepthMinus1( attrIndex ) + 1;
+          for ( int attrPartitionIndex = 0;
+                attrPartitionIndex < ai.getAttributeDimensionPartitionsMinus1( attrIndex ) + 1;
+                attrPartitionIndex++ ) {
+            if ( sps.getMultipleMapStreamsPresentFlag( atlasIndex ) ) {
+              // decompress T[mapIndex]
+              std::cout << "*******Video Decoding: Attribute [" << mapIndex << "] ********" << std::endl;
+              auto  textureIndex   = static_cast<PCCVideoType>( VIDEO_TEXTURE_T0 + attrPartitionIndex +
+                                                             MAX_NUM_ATTR_PARTITIONS * mapIndex );
+              auto& videoBitstream = context.getVideoBitstream( textureIndex );
+              videoDecoder.decompress( context.getVideoTextureMultiple()[mapIndex], path.str(), context.size(),
+                                       videoBitstream, params_.videoDecoderAttributePath_, attributeCodecId, context,
+                                       ai.getAttribute2dBitdepthMinus1( 0 ) + 1, params_.keepIntermediateFiles_,
+                                       isAttributes444, params_.patchColorSubsampling_,
+                                       params_.inverseColorSpaceConversionConfig_, params_.colorSpaceConversionPath_ );
+              std::cout << "texture T" << mapIndex << " video ->" << videoBitstream.size() << " B" << std::endl;
+            } else {
+              std::cout << "*******Video Decoding: Attribute ********" << std::endl;
+              auto  textureIndex   = static_cast<PCCVideoType>( VIDEO_TEXTURE + attrPartitionIndex );
+              auto& videoBitstream = context.getVideoBitstream( textureIndex );
+              printf( "call videoDecoder.decompress()::context.getVideoTexture() \n" );
+              printf( " Decode T size = %zu \n", videoBitstream.size() );
+              fflush( stdout );
+              videoDecoder.decompress( context.getVideoTextureMultiple()[0],        // video,
+                                       path.str(),                                  // path,
+                                       context.size() * mapCount,                   // frameCount,
+                                       videoBitstream,                              // bitstream,
+                                       params_.videoDecoderAttributePath_,          // decoderPath,
+                                       attributeCodecId,                            // attributeCodecId
+                                       context,                                     // contexts,
+                                       decodedBitdepthAttribute,                    // bitDepth,
+                                       params_.keepIntermediateFiles_,              // keepIntermediateFiles
+                                       isAttributes444,                             // isAttributes444
+                                       params_.patchColorSubsampling_,              // patchColorSubsampling
+                                       params_.inverseColorSpaceConversionConfig_,  // inverseColorSpaceConversionConfig_
+                                       params_.colorSpaceConversionPath_ );
+              std::cout << "texture video  ->" << videoBitstream.size() << " B" << std::endl;
+            }
           }
-          std::cout << "texture    video ->" << sizeTextureVideo << " B" << std::endl;
-        } else {
-          std::cout << "*******Video Decoding: Attribute ********" << std::endl;
-          auto  textureIndex   = static_cast<PCCVideoType>( VIDEO_TEXTURE + attrPartitionIndex );
-          auto& videoBitstream = context.getVideoBitstream( textureIndex );
-          printf( "call videoDecoder.decompress()::context.getVideoTexture() \n" );
-          printf( " Decode T size = %zu \n", videoBitstream.size() );
-          fflush( stdout );
-          videoDecoder.decompress( context.getVideoTextureMultiple()[0],        // video,
-                                   path.str(),                                  // path,
-                                   context.size() * mapCount,                   // frameCount,
-                                   videoBitstream,                              // bitstream,
-                                   params_.videoDecoderAttributePath_,          // decoderPath,
-                                   attributeCodecId,                            // attributeCodecId
-                                   context,                                     // contexts,
-                                   decodedBitdepthAttribute,                    // bitDepth,
-                                   params_.keepIntermediateFiles_,              // keepIntermediateFiles
-                                   isAttributes444,                             // isAttributes444
-                                   params_.patchColorSubsampling_,              // patchColorSubsampling
-                                   params_.inverseColorSpaceConversionConfig_,  // inverseColorSpaceConversionConfig_
-                                   params_.colorSpaceConversionPath_ );
-          std::cout << "texture video  ->" << videoBitstream.size() << " B" << std::endl;
         }
-
-        if ( asps.getRawPatchEnabledFlag() && asps.getAuxiliaryVideoEnabledFlag() &&
-             sps.getAuxiliaryVideoPresentFlag( atlasIndex ) ) {
-          std::cout << "*******Video Decoding: Aux Attribute ********" << std::endl;
-          auto  textureIndex     = static_cast<PCCVideoType>( VIDEO_TEXTURE_RAW + attrPartitionIndex );
-          auto& videoBitstreamMP = context.getVideoBitstream( textureIndex );
-          videoDecoder.decompress( context.getVideoRawPointsTexture(), path.str(), pcFrameCount, videoBitstreamMP,
-                                   params_.videoDecoderAttributePath_, attributeCodecId, context,
-                                   decodedBitdepthAttributeMP, params_.keepIntermediateFiles_, isAuxiliaryAttributes444,
-                                   false, params_.inverseColorSpaceConversionConfig_,
-                                   params_.colorSpaceConversionPath_ );
-          // generateRawPointsTexturefromVideo( context, reconstructs );
-          std::cout << " raw points texture -> " << videoBitstreamMP.size() << " B" << endl;
+      } );
+    }
+    if ( rawVideoPresent ) {
+      videoDecodingTasks.push_back( [&] {
+        PCCVideoDecoder videoDecoder;
+        for ( size_t attrIndex = 0; attrIndex < attributeCount; attrIndex++ ) {
+          int decodedBitdepthAttributeMP = ai.getAttribute2dBitdepthMinus1( attrIndex ) + 1;
+          for ( int attrPartitionIndex = 0;
+                attrPartitionIndex < ai.getAttributeDimensionPartitionsMinus1( attrIndex ) + 1;
+                attrPartitionIndex++ ) {
+            std::cout << "*******Video Decoding: Aux Attribute ********" << std::endl;
+            auto  textureIndex     = static_cast<PCCVideoType>( VIDEO_TEXTURE_RAW + attrPartitionIndex );
+            auto& videoBitstreamMP = context.getVideoBitstream( textureIndex );
+            videoDecoder.decompress( context.getVideoRawPointsTexture(), path.str(), pcFrameCount, videoBitstreamMP,
+                                     params_.videoDecoderAttributePath_, attributeCodecId, context,
+                                     decodedBitdepthAttributeMP, params_.keepIntermediateFiles_,
+                                     isAuxiliaryAttributes444, false, params_.inverseColorSpaceConversionConfig_,
+                                     params_.colorSpaceConversionPath_ );
+            std::cout << " raw points texture -> " << videoBitstreamMP.size() << " B" << endl;
+          }
         }
-      }
+      } );
     }
   }
 
-  reconstructs.setFrameCount( pcFrameCount );
+  tbb::task_arena limited( params_.nbThread_ > 0 ? static_cast<int>( params_.nbThread_ )
+                                                 : static_cast<int>( tbb::task_arena::automatic ) );
+  limited.execute( [&] {
+    tbb::parallel_for( size_t( 0 ), videoDecodingTasks.size(), [&]( const size_t i ) { videoDecodingTasks[i](); } );
+  } );
+
+  // context data shared by the frames is set here, decodeFrame() only modifies the data of its own frame.
+  context.setOccupancyPrecision( sps.getFrameWidth( atlasIndex ) / context.getVideoOccupancyMap().getWidth() );
+  if ( rawVideoPresent ) {
+    context.getVideoRawPointsGeometry().resize( context.size() );
+    if ( ai.getAttributeCount() > 0 ) { context.getVideoRawPointsTexture().resize( context.size() ); }
+  }
+
+  return 0;
+}
+
+int PCCDecoder::decodeFrame( PCCContext& context, size_t frameIdx, PCCPointSet3& reconstruct, int32_t atlasIndex ) {
+  auto& sps             = context.getVps();
+  auto& ai              = sps.getAttributeInformation( atlasIndex );
+  auto& oi              = sps.getOccupancyInformation( atlasIndex );
+  auto& asps            = context.getAtlasSequenceParameterSet( 0 );
+  bool  isAttributes444 = sps.getProfileTierLevel().getProfileCodecGroupIdc() == CODEC_GROUP_HEVC444;
   // recreating the prediction list per attribute (either the attribute is coded absolute, or follows the geometry)
   // see contribution m52529
   std::vector<std::vector<bool>> absoluteT1List;
@@ -257,46 +319,47 @@ int PCCDecoder::decode( PCCContext& context, PCCGroupOfFrames& reconstructs, int
     }
   }
 
-  printf( "generate point cloud of %zu frames \n", pcFrameCount );
-  fflush( stdout );
-  for ( size_t frameIdx = 0; frameIdx < pcFrameCount; frameIdx++ ) {
-    // All video have been decoded, start reconsctruction processes
-    if ( asps.getRawPatchEnabledFlag() && asps.getAuxiliaryVideoEnabledFlag() &&
-         sps.getAuxiliaryVideoPresentFlag( atlasIndex ) ) {
-      printf( "generateRawPointsGeometryfromVideo \n" );
-      fflush( stdout );
-      generateRawPointsGeometryfromVideo( context, frameIdx );
+  // All video have been decoded, start reconsctruction processes
+  if ( asps.getRawPatchEnabledFlag() && asps.getAuxiliaryVideoEnabledFlag() &&
+       sps.getAuxiliaryVideoPresentFlag( atlasIndex ) ) {
+    printf( "generateRawPointsGeometryfromVideo \n" );
+    fflush( stdout );
+    generateRawPointsGeometryfromVideo( context, frameIdx );
 
-      if ( ai.getAttributeCount() > 0 ) {
-        for ( int attrIndex = 0; attrIndex < sps.getAttributeInformation( atlasIndex ).getAttributeCount();
-              attrIndex++ ) {  // right now we only have one attribute, this should be generalized
-          for ( int attrPartitionIndex = 0;
-                attrPartitionIndex <
-                sps.getAttributeInformation( atlasIndex ).getAttributeDimensionPartitionsMinus1( attrIndex ) + 1;
-                attrPartitionIndex++ ) {  // right now we have only one partition,
-                                          // this should be generalized
-            printf( "generateRawPointsTexturefromVideo attrIndex = %d attrPartitionIndex = %d \n", attrIndex,
-                    attrPartitionIndex );
-            fflush( stdout );
-            generateRawPointsTexturefromVideo( context, frameIdx );
-          }
+    if ( ai.getAttributeCount() > 0 ) {
+      for ( int attrIndex = 0; attrIndex < sps.getAttributeInformation( atlasIndex ).getAttributeCount();
+            attrIndex++ ) {  // right now we only have one attribute, this should be generalized
+        for ( int attrPartitionIndex = 0;
+              attrPartitionIndex <
+              sps.getAttributeInformation( atlasIndex ).getAttributeDimensionPartitionsMinus1( attrIndex ) + 1;
+              attrPartitionIndex++ ) {  // right now we have only one partition,
+                                        // this should be generalized
+          printf( "generateRawPointsTexturefromVideo attrIndex = %d attrPartitionIndex = %d \n", attrIndex,
+                  attrPartitionIndex );
+          fflush( stdout );
+          generateRawPointsTexturefromVideo( context, frameIdx );
         }
       }
-    }  // getAuxiliaryVideoEnabledFlag()
+    }
+  }  // getAuxiliaryVideoEnabledFlag()
 
-    context.setOccupancyPrecision( sps.getFrameWidth( atlasIndex ) / context.getVideoOccupancyMap().getWidth() );
-    GeneratePointCloudParameters gpcParams;
-    GeneratePointCloudParameters ppSEIParams;
-    setGeneratePointCloudParameters( gpcParams, context );
-    setPostProcessingSeiParameters( ppSEIParams, context );
+  GeneratePointCloudParameters gpcParams;
+  GeneratePointCloudParameters ppSEIParams;
+  setGeneratePointCloudParameters( gpcParams, context );
+  setPostProcessingSeiParameters( ppSEIParams, context );
 
-    auto&                 reconstruct = reconstructs[frameIdx];
-    std::vector<uint32_t> partition;
-    // Decode point cloud
-    printf( "call generatePointCloud() \n" );
-    std::vector<size_t> accTilePointCount;
-    accTilePointCount.resize( ai.getAttributeCount(), 0 );
-    for ( size_t tileIdx = 0; tileIdx < context[frameIdx].getNumTilesInAtlasFrame(); tileIdx++ ) {
+  std::vector<uint32_t> partition;
+  // Decode point cloud
+  printf( "call generatePointCloud() \n" );
+  std::vector<size_t> accTilePointCount;
+  accTilePointCount.resize( ai.getAttributeCount(), 0 );
+  // the geometry of the tiles is generated concurrently, then the tiles are merged and colored in order.
+  const size_t                       tileCount = context[frameIdx].getNumTilesInAtlasFrame();
+  std::vector<PCCPointSet3>          tileReconstructs( tileCount );
+  std::vector<std::vector<uint32_t>> tilePartitions( tileCount );
+  tbb::task_arena                    limited( static_cast<int>( params_.nbThread_ ) );
+  limited.execute( [&] {
+    tbb::parallel_for( size_t( 0 ), tileCount, [&]( const size_t tileIdx ) {
       std::cout << "Processing frame " << frameIdx << " tile " << tileIdx << std::endl;
       auto& tile = context[frameIdx].getTile( tileIdx );
       if ( !ppSEIParams.pbfEnableFlag_ ) {
@@ -307,68 +370,72 @@ int PCCDecoder::decode( PCCContext& context, PCCGroupOfFrames& reconstructs, int
       generateBlockToPatchFromOccupancyMapVideo(
           context, tile, frameIdx, context.getVideoOccupancyMap().getFrame( frameIdx ),
           size_t( 1 ) << asps.getLog2PatchPackingBlockSize(), context.getOccupancyPrecision() );
-
       printf( "call generatePointCloud() \n" );
-      PCCPointSet3 tileReconstrct;
-      generatePointCloud( tileReconstrct, context, frameIdx, tileIdx, gpcParams, partition, true );
-      reconstruct.appendPointSet( tileReconstrct );
-      if ( context[frameIdx].getNumTilesInAtlasFrame() > 1 )
-        context[frameIdx].getTitleFrameContext().appendPointToPixel(
-            context[frameIdx].getTile( tileIdx ).getPointToPixel() );
-      if ( ai.getAttributeCount() > 0 ) {
-        reconstruct.addColors();
-        reconstruct.addColors16bit();
-      }
-      for ( size_t attIdx = 0; attIdx < ai.getAttributeCount(); attIdx++ ) {
-        printf( "start colorPointCloud attIdx = %zu / %u ] \n", attIdx, ai.getAttributeCount() );
-        fflush( stdout );
-        size_t updatedPointCount  = colorPointCloud( reconstruct, context, tile, absoluteT1List[attIdx],
-                                                    sps.getMultipleMapStreamsPresentFlag( atlasIndex ),
-                                                    ai.getAttributeCount(), accTilePointCount[attIdx], gpcParams );
-        accTilePointCount[attIdx] = updatedPointCount;
-      }
-    }  // tile
-
-    // Post-Processing
-    TRACE_PATCH( "Post-Processing: postprocessSmoothing = %zu pbfEnableFlag = %d \n",
-                 params_.postprocessSmoothingFilter_, ppSEIParams.pbfEnableFlag_ );
-    if ( ppSEIParams.flagGeometrySmoothing_ ) {
-      PCCPointSet3 tempFrameBuffer = reconstruct;
-      if ( ppSEIParams.gridSmoothing_ ) {
-        smoothPointCloudPostprocess( reconstruct, params_.colorTransform_, ppSEIParams, partition );
-      }
-      if ( !ppSEIParams.pbfEnableFlag_ ) {
-        // These are different attribute transfer functions
-        if ( params_.postprocessSmoothingFilter_ == 1 || params_.postprocessSmoothingFilter_ == 5 ) {
-          TRACE_PATCH( " transferColors16bitBP \n" );
-          tempFrameBuffer.transferColors16bitBP( reconstruct, params_.postprocessSmoothingFilter_, int32_t( 0 ),
-                                                 isAttributes444, 8, 1, true, true, true, false, 4, 4, 1000, 1000,
-                                                 1000 * 256, 1000 * 256 );  // jkie: let's make it general
-        } else if ( params_.postprocessSmoothingFilter_ == 2 ) {
-          TRACE_PATCH( " transferColorWeight \n" );
-          tempFrameBuffer.transferColorWeight( reconstruct, 0.1 );
-        } else if ( params_.postprocessSmoothingFilter_ == 3 ) {
-          TRACE_PATCH( " transferColorsFilter3 \n" );
-          tempFrameBuffer.transferColorsFilter3( reconstruct, int32_t( 0 ), isAttributes444 );
-        } else if ( params_.postprocessSmoothingFilter_ == 7 || params_.postprocessSmoothingFilter_ == 9 ) {
-          TRACE_PATCH( " transferColorsFilter3 \n" );
-          tempFrameBuffer.transferColorsBackward16bitBP( reconstruct, params_.postprocessSmoothingFilter_, int32_t( 0 ),
-                                                         isAttributes444, 8, 1, true, true, true, false, 4, 4, 1000,
-                                                         1000, 1000 * 256, 1000 * 256 );
-        }
-      }
+      generatePointCloud( tileReconstructs[tileIdx], context, frameIdx, tileIdx, gpcParams, tilePartitions[tileIdx],
+                          true );
+    } );
+  } );
+  for ( size_t tileIdx = 0; tileIdx < tileCount; tileIdx++ ) {
+    auto& tile = context[frameIdx].getTile( tileIdx );
+    reconstruct.appendPointSet( tileReconstructs[tileIdx] );
+    partition.insert( partition.end(), tilePartitions[tileIdx].begin(), tilePartitions[tileIdx].end() );
+    tileReconstructs[tileIdx].clear();
+    if ( context[frameIdx].getNumTilesInAtlasFrame() > 1 )
+      context[frameIdx].getTitleFrameContext().appendPointToPixel(
+          context[frameIdx].getTile( tileIdx ).getPointToPixel() );
+    if ( ai.getAttributeCount() > 0 ) {
+      reconstruct.addColors();
+      reconstruct.addColors16bit();
     }
-    if ( ppSEIParams.flagColorSmoothing_ ) {
-      TRACE_PATCH( " colorSmoothing \n" );
-      colorSmoothing( reconstruct, params_.colorTransform_, ppSEIParams );
+    for ( size_t attIdx = 0; attIdx < ai.getAttributeCount(); attIdx++ ) {
+      printf( "start colorPointCloud attIdx = %zu / %u ] \n", attIdx, ai.getAttributeCount() );
+      fflush( stdout );
+      size_t updatedPointCount  = colorPointCloud( reconstruct, context, tile, absoluteT1List[attIdx],
+                                                  sps.getMultipleMapStreamsPresentFlag( atlasIndex ),
+                                                  ai.getAttributeCount(), accTilePointCount[attIdx], gpcParams );
+      accTilePointCount[attIdx] = updatedPointCount;
     }
-    if ( !isAttributes444 ) {  // lossy: convert 16-bit yuv444 to 8-bit RGB444
-      TRACE_PATCH( "lossy: convert 16-bit yuv444 to 8-bit RGB444 (convertYUV16ToRGB8) \n" );
-      reconstruct.convertYUV16ToRGB8();
-    } else {  // lossless: copy 16-bit RGB to 8-bit RGB
-      TRACE_PATCH( "lossy: lossless: copy 16-bit RGB to 8-bit RGB (copyRGB16ToRGB8) \n" );
-      reconstruct.copyRGB16ToRGB8();
+  }  // tile
+
+  // Post-Processing
+  TRACE_PATCH( "Post-Processing: postprocessSmoothing = %zu pbfEnableFlag = %d \n",
+               params_.postprocessSmoothingFilter_, ppSEIParams.pbfEnableFlag_ );
+  if ( ppSEIParams.flagGeometrySmoothing_ ) {
+    PCCPointSet3 tempFrameBuffer = reconstruct;
+    if ( ppSEIParams.gridSmoothing_ ) {
+      smoothPointCloudPostprocess( reconstruct, params_.colorTransform_, ppSEIParams, partition );
     }
+    if ( !ppSEIParams.pbfEnableFlag_ ) {
+      // These are different attribute transfer functions
+      if ( params_.postprocessSmoothingFilter_ == 1 || params_.postprocessSmoothingFilter_ == 5 ) {
+        TRACE_PATCH( " transferColors16bitBP \n" );
+        tempFrameBuffer.transferColors16bitBP( reconstruct, params_.postprocessSmoothingFilter_, int32_t( 0 ),
+                                               isAttributes444, 8, 1, true, true, true, false, 4, 4, 1000, 1000,
+                                               1000 * 256, 1000 * 256 );  // jkie: let's make it general
+      } else if ( params_.postprocessSmoothingFilter_ == 2 ) {
+        TRACE_PATCH( " transferColorWeight \n" );
+        tempFrameBuffer.transferColorWeight( reconstruct, 0.1 );
+      } else if ( params_.postprocessSmoothingFilter_ == 3 ) {
+        TRACE_PATCH( " transferColorsFilter3 \n" );
+        tempFrameBuffer.transferColorsFilter3( reconstruct, int32_t( 0 ), isAttributes444 );
+      } else if ( params_.postprocessSmoothingFilter_ == 7 || params_.postprocessSmoothingFilter_ == 9 ) {
+        TRACE_PATCH( " transferColorsFilter3 \n" );
+        tempFrameBuffer.transferColorsBackward16bitBP( reconstruct, params_.postprocessSmoothingFilter_, int32_t( 0 ),
+                                                       isAttributes444, 8, 1, true, true, true, false, 4, 4, 1000,
+                                                       1000, 1000 * 256, 1000 * 256 );
+      }
+    }
+  }
+  if ( ppSEIParams.flagColorSmoothing_ ) {
+    TRACE_PATCH( " colorSmoothing \n" );
+    colorSmoothing( reconstruct, params_.colorTransform_, ppSEIParams );
+  }
+  if ( !isAttributes444 ) {  // lossy: convert 16-bit yuv444 to 8-bit RGB444
+    TRACE_PATCH( "lossy: convert 16-bit yuv444 to 8-bit RGB444 (convertYUV16ToRGB8) \n" );
+    reconstruct.convertYUV16ToRGB8();
+  } else {  // lossless: copy 16-bit RGB to 8-bit RGB
+    TRACE_PATCH( "lossy: lossless: copy 16-bit RGB to 8-bit RGB (copyRGB16ToRGB8) \n" );
+    reconstruct.copyRGB16ToRGB8();
   }
   return 0;
 }
@@ -1247,67 +1314,77 @@ void PCCDecoder::createHashInformation( PCCContext& context, int frameIndex ) {
   if ( !seiHashCancelFlag && sei.getDecodedAtlasTilesHashPresentFlag() ||
        sei.getDecodedAtlasTilesB2pHashPresentFlag() ) {
     size_t numTilesInPatchFrame = context[frameIndex].getNumTilesInAtlasFrame();
+    // the byte strings of the tiles are built and hashed concurrently, then compared in the order of the tiles
+    std::vector<PCCSeiHashDigest> tileHashes( numTilesInPatchFrame );
+    std::vector<PCCSeiHashDigest> tileB2PHashes( numTilesInPatchFrame );
+    tbb::task_arena               limited( static_cast<int>( params_.nbThread_ ) );
+    limited.execute( [&] {
+      tbb::parallel_for( size_t( 0 ), numTilesInPatchFrame, [&]( const size_t tileIdx ) {
+        auto&  atlu   = context.getAtlasTileLayer( context[frameIndex].getTile( tileIdx ).getAtlIndex() );
+        size_t tileId = atlu.getHeader().getId();
+        if ( sei.getDecodedAtlasTilesHashPresentFlag() ) {
+          std::vector<uint8_t> atlasTileData;
+          for ( size_t patchIdx = 0; patchIdx < atlu.getDataUnit().getPatchCount(); patchIdx++ ) {
+            tilePatchCommonByteString( atlasTileData, tileId, patchIdx, tilePatchParams );
+            tilePatchApplicationByteString( atlasTileData, tileId, patchIdx, tilePatchParams );
+          }
+          context.computeHash( atlasTileData, sei.getHashType(), tileHashes[tileIdx] );
+        }
+        if ( sei.getDecodedAtlasTilesB2pHashPresentFlag() ) {
+          std::vector<uint8_t> tileB2PData;
+          tileBlockToPatchByteString( tileB2PData, tileId, tileB2PPatchParams );
+          context.computeHash( tileB2PData, sei.getHashType(), tileB2PHashes[tileIdx] );
+        }
+      } );
+    } );
     for ( size_t tileIdx = 0; tileIdx < numTilesInPatchFrame; tileIdx++ ) {
       auto&  tile   = context[frameIndex].getTile( tileIdx );
       auto&  atlu   = context.getAtlasTileLayer( tile.getAtlIndex() );
       auto&  ath    = atlu.getHeader();
       size_t tileId = ath.getId();
       if ( sei.getDecodedAtlasTilesHashPresentFlag() ) {
-        std::vector<uint8_t> atlasTileData;
-        for ( size_t patchIdx = 0; patchIdx < atlu.getDataUnit().getPatchCount(); patchIdx++ ) {
-          tilePatchCommonByteString( atlasTileData, tileId, patchIdx, tilePatchParams );
-          tilePatchApplicationByteString( atlasTileData, tileId, patchIdx, tilePatchParams );
-        }
         printf( "**sei** TilesPatchHash: frame(%d), tile(%zu, tileId %zu)\n", frameIndex, tileIdx, tileId );
+        auto& digest = tileHashes[tileIdx];
         if ( sei.getHashType() == 0 ) {
           bool                 equal = true;
-          std::vector<uint8_t> encMD5( 16 ), decMD5( 16 );
-          encMD5 = context.computeMD5( atlasTileData.data(), atlasTileData.size() );
+          std::vector<uint8_t> decMD5( 16 );
           for ( int j = 0; j < 16; j++ ) decMD5[j] = sei.getAtlasTilesMd5( tileId, j );
           printf( "\t**sei** (MD5): " );
-          equal = compareHashSEIMD5( encMD5, decMD5 );
+          equal = compareHashSEIMD5( digest.md5_, decMD5 );
           printf( " (%s) \n", equal ? "OK" : "DIFF" );
         } else if ( sei.getHashType() == 1 ) {
-          bool     equal = true;
-          uint16_t crc   = context.computeCRC( atlasTileData.data(), atlasTileData.size() );
+          bool equal = true;
           printf( "\t**sei** (CRC): " );
-          equal = compareHashSEICrc( crc, sei.getAtlasTilesCrc( tileId ) );
+          equal = compareHashSEICrc( digest.crc_, sei.getAtlasTilesCrc( tileId ) );
           printf( " (%s) \n", equal ? "OK" : "DIFF" );
         } else if ( sei.getHashType() == 2 ) {
-          bool     equal    = false;
-          uint32_t checkSum = context.computeCheckSum( atlasTileData.data(), atlasTileData.size() );
+          bool equal = false;
           printf( "\t**sei** (CheckSum): " );
-          equal = compareHashSEICheckSum( checkSum, sei.getAtlasTilesCheckSum( tileId ) );
+          equal = compareHashSEICheckSum( digest.checkSum_, sei.getAtlasTilesCheckSum( tileId ) );
           printf( " (%s) \n", equal ? "OK" : "DIFF" );
         }
-        atlasTileData.clear();
       }
       if ( sei.getDecodedAtlasTilesB2pHashPresentFlag() ) {
-        std::vector<uint8_t> tileB2PData;
-        tileBlockToPatchByteString( tileB2PData, tileId, tileB2PPatchParams );
         printf( "**sei** TilesBlockToPatchHash: frame(%d), tile(%zu, tileId %zu)\n", frameIndex, tileIdx, tileId );
+        auto& digest = tileB2PHashes[tileIdx];
         if ( sei.getHashType() == 0 ) {
           bool                 equal = false;
-          std::vector<uint8_t> encMD5( 16 ), decMD5( 16 );
-          encMD5 = context.computeMD5( tileB2PData.data(), tileB2PData.size() );
+          std::vector<uint8_t> decMD5( 16 );
           for ( int j = 0; j < 16; j++ ) decMD5[j] = sei.getAtlasTilesB2pMd5( tileId, j );
           printf( "\t**sei** (MD5): " );
-          equal = compareHashSEIMD5( encMD5, decMD5 );
+          equal = compareHashSEIMD5( digest.md5_, decMD5 );
           printf( " (%s) \n", equal ? "OK" : "DIFF" );
         } else if ( sei.getHashType() == 1 ) {
-          bool     equal = false;
-          uint16_t crc   = context.computeCRC( tileB2PData.data(), tileB2PData.size() );
+          bool equal = false;
           printf( "\t**sei** (CRC): " );
-          equal = compareHashSEICrc( crc, sei.getAtlasTilesB2pCrc( tileId ) );
+          equal = compareHashSEICrc( digest.crc_, sei.getAtlasTilesB2pCrc( tileId ) );
           printf( " (%s) \n", equal ? "OK" : "DIFF" );
         } else if ( sei.getHashType() == 2 ) {
-          bool     equal    = false;
-          uint32_t checkSum = context.computeCheckSum( tileB2PData.data(), tileB2PData.size() );
+          bool equal = false;
           printf( "\t**sei** (CheckSum): " );
-          equal = compareHashSEICheckSum( checkSum, sei.getAtlasTilesB2pCheckSum( tileId ) );
+          equal = compareHashSEICheckSum( digest.checkSum_, sei.getAtlasTilesB2pCheckSum( tileId ) );
           printf( " (%s) \n", equal ? "OK" : "DIFF" );
         }
-        tileB2PData.clear();
       }
     }  // tileIdx
   }
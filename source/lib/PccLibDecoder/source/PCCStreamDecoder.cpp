@@ -0,0 +1,157 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "PCCCommon.h"
+#include "PCCContext.h"
+#include "PCCFrameContext.h"
+#include "PCCPointSet.h"
+#include "PCCStreamDecoder.h"
+#include <tbb/tbb.h>
+#include <atomic>
+
+using namespace pcc;
+
+PCCStreamDecoder::PCCStreamDecoder() :
+    headerRead_( false ),
+    endOfStream_( false ),
+    stopped_( false ),
+    nbThread_( 0 ),
+    frameIndex_( 0 ),
+    reconstructIndex_( 0 ),
+    frameCount_( 0 ) {}
+PCCStreamDecoder::~PCCStreamDecoder() = default;
+
+void PCCStreamDecoder::setParameters( const PCCDecoderParameters& params ) {
+  decoder_.setParameters( params );
+  nbThread_ = params.nbThread_;
+}
+
+void PCCStreamDecoder::setLogger( PCCLogger& logger ) {
+  decoder_.setLogger( logger );
+#ifdef BITSTREAM_TRACE
+  bitstreamReader_.setLogger( logger );
+  bitstream_.setLogger( logger );
+  bitstream_.setTrace( true );
+#endif
+}
+
+void PCCStreamDecoder::push( const uint8_t* data, const size_t size ) {
+  if ( stopped_ ) { return; }
+  auto& buffer = bitstream_.vector();
+  if ( bitstream_.size() > 0 && 2 * bitstream_.size() >= buffer.size() ) {
+    // drop the V3C units already extracted once they are at least half of the buffer, so that each byte is moved a
+    // bounded number of times whatever the size of the chunks
+    buffer.erase( buffer.begin(), buffer.begin() + bitstream_.size() );
+    bitstream_.beginning();
+  }
+  buffer.insert( buffer.end(), data, data + size );
+  if ( !headerRead_ ) {
+    if ( buffer.empty() ) { return; }
+    bitstreamStat_.incrHeader( PCCBitstreamReader::readHeader( bitstream_, ssvu_ ) );
+    headerRead_ = true;
+  }
+  bitstreamStat_.incrHeader( PCCBitstreamReader::readV3CUnits( bitstream_, ssvu_ ) );
+}
+
+void PCCStreamDecoder::flush() {
+  if ( bitstream_.moreData() ) {
+    printf( "Warning: %zu bytes of an incomplete V3C unit are ignored \n",
+            static_cast<size_t>( bitstream_.capacity() - bitstream_.size() ) );
+  }
+  endOfStream_ = true;
+}
+
+bool PCCStreamDecoder::groupOfFramesAvailable() {
+  auto& units = ssvu_.getV3CUnit();
+  if ( units.empty() ) { return false; }
+  if ( endOfStream_ ) { return true; }
+  for ( size_t i = 1; i < units.size(); i++ ) {
+    if ( units[i].getType() == V3C_VPS ) { return true; }
+  }
+  return false;
+}
+
+int PCCStreamDecoder::decodeGroupOfFrames() {
+  context_.reset( new PCCContext );
+  context_->setBitstreamStat( bitstreamStat_ );
+  if ( bitstreamReader_.decode( ssvu_, *context_ ) == 0 ) {
+    // the V3C units of the group of frames can't be decoded: the decoding stops as at the end of the bitstream
+    printf( "Warning: the V3C units can't be decoded, the decoding is stopped \n" );
+    context_.reset();
+    ssvu_.getV3CUnit().clear();
+    stopped_ = true;
+    return 0;
+  }
+  context_->resizeAtlas( context_->getVps().getAtlasCountMinus1() + 1 );
+  context_->getAtlas( 0 ).allocateVideoFrames( *context_, 0 );
+  context_->setAtlasIndex( 0 );
+  frameIndex_ = 0;
+  return decoder_.decodeVideos( *context_, 0 );
+}
+
+int PCCStreamDecoder::reconstructFrames() {
+  // the frames of a group of frames are independent once its videos are decoded: they are reconstructed
+  // concurrently, one frame per thread of the arena at a time, and output in order by pull().
+  tbb::task_arena limited( nbThread_ > 0 ? static_cast<int>( nbThread_ )
+                                         : static_cast<int>( tbb::task_arena::automatic ) );
+  const size_t threadCount = static_cast<size_t>( ( std::max )( limited.max_concurrency(), 1 ) );
+  const size_t count       = ( std::min )( threadCount, context_->size() - frameIndex_ );
+  reconstructs_.clear();
+  reconstructs_.resize( count );
+  reconstructIndex_ = 0;
+  std::atomic<int> status( 0 );
+  limited.execute( [&] {
+    tbb::parallel_for( size_t( 0 ), count, [&]( const size_t i ) {
+      int ret = decoder_.decodeFrame( *context_, frameIndex_ + i, reconstructs_[i], 0 );
+      if ( ret != 0 ) { status = ret; }
+    } );
+  } );
+  frameIndex_ += count;
+  return status;
+}
+
+int PCCStreamDecoder::pull( PCCPointSet3& frame ) {
+  while ( reconstructIndex_ >= reconstructs_.size() ) {
+    while ( !context_ || frameIndex_ >= context_->size() ) {
+      // release the videos of the previous group of frames before decoding the next one
+      context_.reset();
+      if ( stopped_ || !groupOfFramesAvailable() ) { return 0; }
+      if ( decodeGroupOfFrames() != 0 ) { return -1; }
+    }
+    if ( reconstructFrames() != 0 ) { return -1; }
+  }
+  frame = std::move( reconstructs_[reconstructIndex_] );
+  reconstructs_[reconstructIndex_] = PCCPointSet3();
+  reconstructIndex_++;
+  frameCount_++;
+  return 1;
+}
@@ -59,11 +59,14 @@ typedef pcc::PCCVideo<uint16_t, 3> PCCVideoGeometry;
 typedef pcc::PCCVideo<uint8_t, 3>  PCCVideoOccupancyMap;
 template <typename T, size_t N>
 class PCCImage;
+template <typename T>
+class PCCMipPyramid;
 typedef pcc::PCCImage<uint16_t, 3> PCCImageTexture;
 typedef pcc::PCCImage<uint16_t, 3> PCCImageGeometry;
 typedef pcc::PCCImage<uint8_t, 3>  PCCImageOccupancyMap;
 struct PCCPatchSegmenter3Parameters;
 class PCCPatch;
+class PCCBitboardCanvas;
 struct PCCBistreamPosition;
 
 struct SparseMatrixCoefficient {
@@ -116,6 +119,7 @@ class PCCEncoder : public PCCCodec {
   PCCEncoder();
   ~PCCEncoder();
   void setParameters( const PCCEncoderParameters& params );
+  void setKdTreeCache( PCCKdTreeCache* kdTreeCache ) { kdTreeCache_ = kdTreeCache; }
 
   int encode( const PCCGroupOfFrames& sources, PCCContext& context, PCCGroupOfFrames& reconstructs );
 
@@ -236,13 +240,11 @@ class PCCEncoder : public PCCCodec {
                                size_t            y,
                                uint16_t          mean_val,
                                PCCImageGeometry& image,
-                               PCCKdTree&        kdtree,
+                               const PCCKdTree&  kdtree,
                                PCCFrameContext&  frame );
 
   // Push-pull background filling
   template <typename T>
-  int mean4w( T p1, unsigned char w1, T p2, unsigned char w2, T p3, unsigned char w3, T p4, unsigned char w4 );
-  template <typename T>
   void pushPullMip( const PCCImage<T, 3>&        image,
                     PCCImage<T, 3>&              mip,
                     const std::vector<uint32_t>& occupancyMap,
@@ -251,18 +253,22 @@ class PCCEncoder : public PCCCodec {
   void pushPullFill( PCCImage<T, 3>&              image,
                      const PCCImage<T, 3>&        mip,
                      const std::vector<uint32_t>& occupancyMap,
-                     int                          numIters );
+                     int                          numIters,
+                     PCCImage<T, 3>&              tmpImage );
   template <typename T>
   void dilateSmoothedPushPull( PCCFrameContext& frame, PCCImage<T, 3>& image, int mapIdx = -1 );
   template <typename T>
   void dilateHarmonicBackgroundFill( PCCFrameContext& frame, PCCImage<T, 3>& image );
   template <typename T>
-  void CreateCoarseLayer( PCCImage<T, 3>&        image,
-                          PCCImage<T, 3>&        mip,
-                          std::vector<uint32_t>& occupancyMap,
-                          std::vector<uint32_t>& mipOccupancyMap );
+  void CreateCoarseLayer( const PCCImage<T, 3>&        image,
+                          PCCImage<T, 3>&              mip,
+                          const std::vector<uint32_t>& occupancyMap,
+                          std::vector<uint32_t>&       mipOccupancyMap );
   template <typename T>
-  void regionFill( PCCImage<T, 3>& image, std::vector<uint32_t>& occupancyMap, PCCImage<T, 3>& imageLowRes );
+  void regionFill( PCCImage<T, 3>&              image,
+                   const std::vector<uint32_t>& occupancyMap,
+                   const PCCImage<T, 3>*        imageLowRes,
+                   PCCMipPyramid<T>&            pyramid );
 
   //**placing patches**//
   void packFlexible( PCCFrameContext& tile,
@@ -284,14 +290,14 @@ class PCCEncoder : public PCCCodec {
   size_t packRawPointsPatchSimple( PCCFrameContext& tile, size_t patchStartOffsetX = 0, size_t patchStartOffsetY = 0 );
 
   size_t packRawPointsPatch( PCCFrameContext&   frame,
-                             std::vector<bool>& occupancyMap,
+                             PCCBitboardCanvas& occupancyMap,
                              size_t             width,
                              size_t&            height,
                              size_t             occupancySizeU,
                              size_t             occupancySizeV,
                              size_t             maxOccupancyRow );
   void   packEOMTexturePointsPatch( PCCFrameContext&   frame,
-                                    std::vector<bool>& occupancyMap,
+                                    PCCBitboardCanvas& occupancyMap,
                                     size_t             width,
                                     size_t&            height,
                                     size_t             occupancySizeU,
@@ -302,7 +308,7 @@ class PCCEncoder : public PCCCodec {
                                     PCCFrameContext&       tile,
                                     size_t                 tileIndex,
                                     size_t                 listIndex,
-                                    std::vector<PCCPatch>& tempPatchList );
+                                    std::vector<PCCPatch>& curPatches );
   void   spatialConsistencyPackFlexible( PCCFrameContext& tile,
                                          PCCFrameContext& prevFrame,
                                          int              packingStrategy,
@@ -392,7 +398,7 @@ class PCCEncoder : public PCCCodec {
                                                            size_t&            occupancySizeU,
                                                            size_t&            occupancySizeV,
                                                            const size_t       safeguard,
-                                                           std::vector<bool>& occupancyMap,
+                                                           PCCBitboardCanvas& occupancyMap,
                                                            size_t&            heightGPA,
                                                            size_t&            widthGPA,
                                                            size_t&            maxOccupancyRow );
@@ -405,7 +411,7 @@ class PCCEncoder : public PCCCodec {
                                                  size_t&                      occupancySizeU,
                                                  size_t&                      occupancySizeV,
                                                  const size_t                 safeguard,
-                                                 std::vector<bool>&           occupancyMap,
+                                                 PCCBitboardCanvas&           occupancyMap,
                                                  size_t&                      heightGPA,
                                                  size_t&                      widthGPA,
                                                  size_t&                      maxOccupancyRow );
@@ -441,10 +447,13 @@ class PCCEncoder : public PCCCodec {
   PCCVector3D            calculateWeightNormal( size_t geometryBitDepth3D, const PCCPointSet3& source );
 
   //**print out**//
-  static void printMap( std::vector<bool> img, const size_t sizeU, const size_t sizeV );
-  static void printMapTetris( std::vector<bool> img, const size_t sizeU, const size_t sizeV, std::vector<int> horizon );
+  template <typename T>
+  static void printMap( const T& img, const size_t sizeU, const size_t sizeV );
+  template <typename T>
+  static void printMapTetris( const T& img, const size_t sizeU, const size_t sizeV, std::vector<int> horizon );
 
   PCCEncoderParameters params_;
+  PCCKdTreeCache*      kdTreeCache_;
 };
 
 };  // namespace pcc
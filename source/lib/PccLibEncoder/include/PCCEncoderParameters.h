@@ -67,6 +67,8 @@ class PCCEncoderParameters {
   size_t            nbThread_;
   size_t            frameCount_;
   size_t            groupOfFramesSize_;
+  size_t            groupOfFramesPipelineDepth_;
+  size_t            v3cUnitSizePrecisionBytes_;
   std::string       uncompressedDataPath_;
 
   // packing
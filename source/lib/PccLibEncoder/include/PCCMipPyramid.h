@@ -0,0 +1,117 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PCCMipPyramid_h
+#define PCCMipPyramid_h
+
+#include "PCCCommon.h"
+#include "PCCImage.h"
+
+namespace pcc {
+
+// Mip pyramid of the push-pull and harmonic background padding, with the work buffers of the fills. The
+// levels are kept from one frame to the next, so that padding frames of a size already seen does not allocate.
+// The harmonic fill buffers, several times the size of the image, are only kept for the levels of one fill.
+template <typename T>
+class PCCMipPyramid {
+ public:
+  PCCMipPyramid()                       = default;
+  PCCMipPyramid( const PCCMipPyramid& ) = delete;
+  PCCMipPyramid& operator=( const PCCMipPyramid& ) = delete;
+  ~PCCMipPyramid()                                 = default;
+
+  // Sizes the levels of the pyramid of a width x height image and returns the level count. A push-pull level
+  // is half the size of the level above rounded up, a dyadic level half the power of two above it. The last
+  // level is the first one that is 4 samples wide or high.
+  size_t resize( size_t width, size_t height, bool dyadic ) {
+    levelCount_ = 0;
+    while ( true ) {
+      if ( dyadic ) {
+        width  = nextPowerOfTwo( width ) / 2;
+        height = nextPowerOfTwo( height ) / 2;
+      } else {
+        width  = ( width + 1 ) >> 1;
+        height = ( height + 1 ) >> 1;
+      }
+      if ( images_.size() <= levelCount_ ) {
+        images_.resize( levelCount_ + 1 );
+        occupancyMaps_.resize( levelCount_ + 1 );
+      }
+      images_[levelCount_].resize( width, height, PCCCOLORFORMAT::YUV444 );
+      occupancyMaps_[levelCount_].resize( width * height );
+      levelCount_++;
+      if ( width <= 4 || height <= 4 ) { break; }
+    }
+    return levelCount_;
+  }
+
+  size_t                 getLevelCount() const { return levelCount_; }
+  PCCImage<T, 3>&        getImage( size_t level ) { return images_[level]; }
+  std::vector<uint32_t>& getOccupancyMap( size_t level ) { return occupancyMaps_[level]; }
+  PCCImage<T, 3>&        getScratchImage() { return scratchImage_; }
+  std::vector<uint32_t>& getUnknownIndices() { return unknownIndices_; }
+  std::vector<uint32_t>& getUnknownNeighbors() { return unknownNeighbors_; }
+  std::vector<double>&   getUnknownCounts() { return unknownCounts_; }
+  std::vector<double>&   getUnknownValues() { return unknownValues_; }
+  std::vector<double>&   getKnownSums() { return knownSums_; }
+
+  // Frees the harmonic fill buffers, which are not retained by the pyramid of each thread between frames.
+  void releaseFillBuffers() {
+    std::vector<uint32_t>().swap( unknownIndices_ );
+    std::vector<uint32_t>().swap( unknownNeighbors_ );
+    std::vector<double>().swap( unknownCounts_ );
+    std::vector<double>().swap( unknownValues_ );
+    std::vector<double>().swap( knownSums_ );
+  }
+
+ private:
+  static size_t nextPowerOfTwo( size_t value ) {
+    size_t result = 1;
+    while ( result < value ) { result *= 2; }
+    return result;
+  }
+
+  size_t                             levelCount_ = 0;
+  std::vector<PCCImage<T, 3>>        images_;
+  std::vector<std::vector<uint32_t>> occupancyMaps_;
+  PCCImage<T, 3>                     scratchImage_;
+  std::vector<uint32_t>              unknownIndices_;
+  std::vector<uint32_t>              unknownNeighbors_;
+  std::vector<double>                unknownCounts_;
+  std::vector<double>                unknownValues_;
+  std::vector<double>                knownSums_;
+};
+
+}  // namespace pcc
+
+#endif /* PCCMipPyramid_h */
@@ -35,6 +35,7 @@
 #define PCCNormalsGenerator_h
 
 #include "PCCCommon.h"
+#include "PCCKdTree.h"
 
 namespace pcc {
 enum PCCNormalsGeneratorOrientation {
@@ -111,6 +112,7 @@ class PCCNormalsGenerator3 {
   void orientNormals( const PCCPointSet3&                   pointCloud,
                       const PCCKdTree&                      kdtree,
                       const PCCNormalsGenerator3Parameters& params );
+  void gatherNeighbors( const PCCPointSet3& pointCloud, const PCCKdTree& kdtree, const PCCNNQuery3& nNQuery );
   void addNeighbors( const uint32_t      current,
                      const PCCPointSet3& pointCloud,
                      const PCCKdTree&    kdtree,
@@ -128,6 +130,12 @@ class PCCNormalsGenerator3 {
   std::vector<PCCVector3D>             barycenters_;
   std::vector<uint32_t>                numberOfNearestNeighborsInNormalEstimation_;
   std::vector<uint32_t>                visited_;
+  // Neighbors of the points for the orientation, neighborStride_ slots per point, gathered once and in parallel
+  // for the searches of neighborsQuery_, the orientation only pushing and popping the edges of the spanning tree.
+  std::vector<uint32_t>                neighbors_;
+  std::vector<uint32_t>                neighborCounts_;
+  size_t                               neighborStride_ = 0;
+  PCCNNQuery3                          neighborsQuery_;
   std::priority_queue<PCCWeightedEdge> edges_;
   size_t                               nbThread_;
 };
@@ -0,0 +1,145 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PCCPatchCostEstimator_h
+#define PCCPatchCostEstimator_h
+
+#include "PCCCommon.h"
+#include "PCCBitstreamCommon.h"
+#include "PCCPatch.h"
+
+namespace pcc {
+
+// Sizes of the trial patch data units of the reference atlas frame selection, computed from the Exp-Golomb and
+// fixed length code lengths instead of written in a bitstream. The costs are the byte counts a bitstream written
+// with all the trial units one after the other would measure, the bit position of that stream being kept.
+class PCCPatchCostEstimator {
+ public:
+  PCCPatchCostEstimator( bool useEightOrientations, size_t minLevel, bool absoluteD1, size_t max3DCoordinate ) :
+      useEightOrientations_( useEightOrientations ),
+      minLevel_( minLevel ),
+      absoluteD1_( absoluteD1 ),
+      max3DCoordinate_( max3DCoordinate ) {}
+  ~PCCPatchCostEstimator() = default;
+
+  // Code lengths of the ue(v) and se(v) syntax elements, as written by PCCBitstream::writeUvlc() and writeSvlc().
+  static inline uint32_t getUvlcBits( uint32_t value ) { return 2 * floorLog2( value + 1 ) + 1; }
+  static inline uint32_t getSvlcBits( int32_t value ) {
+    return getUvlcBits( uint32_t( value <= 0 ? -value << 1 : ( value << 1 ) - 1 ) );
+  }
+
+  // Bit counts of the u(v) fields of the intra units.
+  void setBitCounts( uint8_t bitCountU0,
+                     uint8_t bitCountV0,
+                     uint8_t bitCountU1,
+                     uint8_t bitCountV1,
+                     uint8_t bitCountD1,
+                     uint8_t bitCountDD ) {
+    bitCountU0_ = bitCountU0;
+    bitCountV0_ = bitCountV0;
+    bitCountU1_ = bitCountU1;
+    bitCountV1_ = bitCountV1;
+    bitCountD1_ = bitCountD1;
+    bitCountDD_ = bitCountDD;
+  }
+
+  // Intra unit of a patch, the size being coded against the one of the previous patch of the tile if any.
+  size_t getIntraCost( const PCCPatch& patch, const PCCPatch* prevPatch ) {
+    uint64_t bits = uint64_t( bitCountU0_ ) + bitCountV0_ + bitCountU1_ + bitCountV1_ + bitCountD1_ + bitCountDD_;
+    bits += getSvlcBits( int32_t( prevPatch == nullptr ? patch.getSizeU0()
+                                                       : patch.getSizeU0() - prevPatch->getSizeU0() ) );
+    bits += getSvlcBits( int32_t( prevPatch == nullptr ? patch.getSizeV0()
+                                                       : patch.getSizeV0() - prevPatch->getSizeV0() ) );
+    bits += 3 + ( useEightOrientations_ ? 3 : 1 );
+    if ( patch.getAxisOfAdditionalPlane() != 0u ) { bits += 1; }
+    return advance( bits );
+  }
+
+  // Inter unit of a patch predicted from the patch refPatchIndex of the reference frame refIndex.
+  size_t getInterCost( const PCCPatch& patch,
+                       const PCCPatch& refPatch,
+                       int64_t         refPatchIndexDelta,
+                       size_t          refIndex ) {
+    uint64_t bits = getSvlcBits( int32_t( refPatchIndexDelta ) ) + getUvlcBits( uint32_t( refIndex ) );
+    bits += getSvlcBits( int32_t( patch.getU0() - refPatch.getU0() ) );
+    bits += getSvlcBits( int32_t( patch.getV0() - refPatch.getV0() ) );
+    bits += getSvlcBits( int32_t( patch.getSizeU0() - refPatch.getSizeU0() ) );
+    bits += getSvlcBits( int32_t( patch.getSizeV0() - refPatch.getSizeV0() ) );
+    bits += getSvlcBits( int32_t( patch.getU1() - refPatch.getU1() ) );
+    bits += getSvlcBits( int32_t( patch.getV1() - refPatch.getV1() ) );
+    size_t        quantDD  = patch.getSizeD() == 0 ? 0 : ( ( patch.getSizeD() - 1 ) / minLevel_ + 1 );
+    size_t        prevQDD  = refPatch.getSizeD() == 0 ? 0 : ( ( refPatch.getSizeD() - 1 ) / minLevel_ + 1 );
+    const int64_t delta_dd = ( static_cast<int64_t>( quantDD ) ) - ( static_cast<int64_t>( prevQDD ) );
+    bits += getSvlcBits( int32_t( delta_dd ) );
+    int32_t delta_d1 = 0;
+    if ( patch.getProjectionMode() == 0 || !absoluteD1_ ) {
+      delta_d1 = ( ( patch.getD1() / minLevel_ ) - ( refPatch.getD1() / minLevel_ ) );
+    } else {
+      if ( patch.getAxisOfAdditionalPlane() == 0 ) {
+        delta_d1 = ( max3DCoordinate_ - patch.getD1() ) / minLevel_ -
+                   ( max3DCoordinate_ - refPatch.getD1() ) / minLevel_;
+      } else {
+        delta_d1 = ( ( max3DCoordinate_ << 1 ) - patch.getD1() ) / minLevel_ -
+                   ( ( max3DCoordinate_ << 1 ) - refPatch.getD1() ) / minLevel_;
+      }
+    }
+    bits += getSvlcBits( delta_d1 );
+    return advance( bits );
+  }
+
+  // Size in bytes of all the units costed so far.
+  size_t getSize() const { return size_t( position_ >> 3 ); }
+
+ private:
+  inline size_t advance( uint64_t bits ) {
+    const uint64_t bytes = position_ >> 3;
+    position_ += bits;
+    return size_t( ( position_ >> 3 ) - bytes );
+  }
+
+  bool     useEightOrientations_;
+  size_t   minLevel_;
+  bool     absoluteD1_;
+  size_t   max3DCoordinate_;
+  uint8_t  bitCountU0_ = 0;
+  uint8_t  bitCountV0_ = 0;
+  uint8_t  bitCountU1_ = 0;
+  uint8_t  bitCountV1_ = 0;
+  uint8_t  bitCountD1_ = 0;
+  uint8_t  bitCountDD_ = 0;
+  uint64_t position_   = 0;
+};
+
+}  // namespace pcc
+
+#endif /* PCCPatchCostEstimator_h */
@@ -0,0 +1,207 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PCCPatchMatchIndex_h
+#define PCCPatchMatchIndex_h
+
+#include "PCCCommon.h"
+#include "PCCPatch.h"
+#include "PCCPatchSegmenter.h"
+#include <array>
+#include <map>
+
+namespace pcc {
+
+// Index of the patches of a frame for the inter-frame patch matching. The patches are grouped by matching key (the
+// projection and the other fields a match must share) and, in each group, registered in the cells of a grid over
+// their 2D bounding boxes, so that a query only evaluates the patches that can overlap it. The candidates are
+// evaluated in the order of the patches, which gives the matches of a search over all of them.
+class PCCPatchMatchIndex {
+ public:
+  typedef std::array<size_t, 4> Key;
+
+  PCCPatchMatchIndex()                            = default;
+  PCCPatchMatchIndex( const PCCPatchMatchIndex& ) = delete;
+  PCCPatchMatchIndex& operator=( const PCCPatchMatchIndex& ) = delete;
+  ~PCCPatchMatchIndex()                                      = default;
+
+  // Key of the IOU based matches: same view and level of detail, and same ROI if useRoi.
+  static Key getMatchingKey( const PCCPatch& patch, bool useRoi ) {
+    return {patch.getViewId(), patch.getLodScaleX(), patch.getLodScaleY(), useRoi ? patch.getRoiIndex() : 0};
+  }
+
+  // Key of the reference atlas frame selection: same view and orientation.
+  static Key getReferenceKey( const PCCPatch& patch ) {
+    return {patch.getViewId(), patch.getPatchOrientation(), 0, 0};
+  }
+
+  template <typename KeyFunction>
+  void build( const std::vector<PCCPatch>& patches, KeyFunction getKey ) {
+    bucketIndices_.clear();
+    bucketCount_ = 0;
+    for ( size_t i = 0; i < patches.size(); i++ ) {
+      auto it = bucketIndices_.find( getKey( patches[i] ) );
+      if ( it == bucketIndices_.end() ) {
+        it = bucketIndices_.insert( std::make_pair( getKey( patches[i] ), bucketCount_ ) ).first;
+        if ( buckets_.size() <= bucketCount_ ) { buckets_.resize( bucketCount_ + 1 ); }
+        auto& bucket = buckets_[bucketCount_++];
+        bucket.patches_.clear();
+        bucket.unmatchedCount_ = 0;
+        bucket.gridWidth_      = 0;
+        bucket.gridHeight_     = 0;
+      }
+      auto& bucket = buckets_[it->second];
+      bucket.patches_.push_back( uint32_t( i ) );
+      if ( patches[i].getBestMatchIdx() == InvalidPatchIndex ) { bucket.unmatchedCount_++; }
+      if ( patches[i].getSizeU() == 0 || patches[i].getSizeV() == 0 ) { continue; }
+      const size_t cx1   = getCell( patches[i].getU1() + patches[i].getSizeU() - 1 );
+      const size_t cy1   = getCell( patches[i].getV1() + patches[i].getSizeV() - 1 );
+      bucket.gridWidth_  = ( std::max )( bucket.gridWidth_, cx1 + 1 );
+      bucket.gridHeight_ = ( std::max )( bucket.gridHeight_, cy1 + 1 );
+    }
+    // the cells list the patches of their bucket that they intersect in increasing order
+    for ( size_t b = 0; b < bucketCount_; b++ ) {
+      auto& bucket = buckets_[b];
+      bucket.cellStarts_.assign( bucket.gridWidth_ * bucket.gridHeight_ + 1, 0 );
+      for ( int pass = 0; pass < 2; pass++ ) {
+        for ( auto i : bucket.patches_ ) {
+          const auto& patch = patches[i];
+          if ( patch.getSizeU() == 0 || patch.getSizeV() == 0 ) { continue; }
+          for ( size_t cy = getCell( patch.getV1() ); cy <= getCell( patch.getV1() + patch.getSizeV() - 1 ); cy++ ) {
+            for ( size_t cx = getCell( patch.getU1() ); cx <= getCell( patch.getU1() + patch.getSizeU() - 1 );
+                  cx++ ) {
+              const size_t cell = cy * bucket.gridWidth_ + cx;
+              if ( pass == 0 ) {
+                bucket.cellStarts_[cell + 1]++;
+              } else {
+                bucket.cellPatches_[cellEnds_[cell]++] = i;
+              }
+            }
+          }
+        }
+        if ( pass == 0 ) {
+          for ( size_t c = 1; c < bucket.cellStarts_.size(); c++ ) {
+            bucket.cellStarts_[c] += bucket.cellStarts_[c - 1];
+          }
+          bucket.cellPatches_.resize( bucket.cellStarts_.back() );
+          cellEnds_.assign( bucket.cellStarts_.begin(), bucket.cellStarts_.end() - 1 );
+        }
+      }
+    }
+    stamps_.assign( patches.size(), 0 );
+    stamp_ = 0;
+  }
+
+  // Patches of a key in increasing order, empty if none.
+  const std::vector<uint32_t>& getPatches( const Key& key ) const {
+    auto it = bucketIndices_.find( key );
+    return it == bucketIndices_.end() ? emptyList_ : buckets_[it->second].patches_;
+  }
+
+  // True if a patch of the key has no match yet.
+  bool hasUnmatchedPatches( const Key& key ) const {
+    auto it = bucketIndices_.find( key );
+    return it != bucketIndices_.end() && buckets_[it->second].unmatchedCount_ > 0;
+  }
+
+  // Records that a patch of the key has been matched.
+  void setMatched( const Key& key ) { buckets_[bucketIndices_.find( key )->second].unmatchedCount_--; }
+
+  // Index of the unmatched patch of the key with the largest IOU with the bounding box of refPatch, the first one
+  // on ties, or -1 if none overlaps it. maxIou is set to its IOU.
+  int findBestMatch( const std::vector<PCCPatch>& patches, const PCCPatch& refPatch, const Key& key, float& maxIou ) {
+    maxIou  = 0.0F;
+    auto it = bucketIndices_.find( key );
+    if ( it == bucketIndices_.end() || refPatch.getSizeU() == 0 || refPatch.getSizeV() == 0 ) { return -1; }
+    auto& bucket = buckets_[it->second];
+    if ( getCell( refPatch.getU1() ) >= bucket.gridWidth_ || getCell( refPatch.getV1() ) >= bucket.gridHeight_ ) {
+      return -1;
+    }
+    const size_t cx1 = ( std::min )( getCell( refPatch.getU1() + refPatch.getSizeU() - 1 ), bucket.gridWidth_ - 1 );
+    const size_t cy1 = ( std::min )( getCell( refPatch.getV1() + refPatch.getSizeV() - 1 ), bucket.gridHeight_ - 1 );
+    candidates_.clear();
+    stamp_++;
+    for ( size_t cy = getCell( refPatch.getV1() ); cy <= cy1; cy++ ) {
+      for ( size_t cx = getCell( refPatch.getU1() ); cx <= cx1; cx++ ) {
+        const size_t cell = cy * bucket.gridWidth_ + cx;
+        for ( size_t j = bucket.cellStarts_[cell]; j < bucket.cellStarts_[cell + 1]; j++ ) {
+          const uint32_t i = bucket.cellPatches_[j];
+          if ( stamps_[i] != stamp_ ) {
+            stamps_[i] = stamp_;
+            candidates_.push_back( i );
+          }
+        }
+      }
+    }
+    std::sort( candidates_.begin(), candidates_.end() );
+    int  bestIdx = -1;
+    Rect rect    = Rect( refPatch.getU1(), refPatch.getV1(), refPatch.getSizeU(), refPatch.getSizeV() );
+    for ( auto i : candidates_ ) {
+      const auto& patch = patches[i];
+      if ( patch.getBestMatchIdx() != InvalidPatchIndex ) { continue; }
+      Rect  crect = Rect( patch.getU1(), patch.getV1(), patch.getSizeU(), patch.getSizeV() );
+      float iou   = computeIOU( rect, crect );
+      if ( iou > maxIou ) {
+        maxIou  = iou;
+        bestIdx = int( i );
+      }
+    }
+    return bestIdx;
+  }
+
+ private:
+  struct Bucket {
+    std::vector<uint32_t> patches_;
+    size_t                unmatchedCount_ = 0;
+    size_t                gridWidth_      = 0;
+    size_t                gridHeight_     = 0;
+    std::vector<uint32_t> cellStarts_;
+    std::vector<uint32_t> cellPatches_;
+  };
+
+  // Cells of 64x64 samples, a few of them per patch of the usual sizes.
+  static inline size_t getCell( size_t coordinate ) { return coordinate >> 6; }
+
+  std::map<Key, size_t> bucketIndices_;
+  std::vector<Bucket>   buckets_;
+  size_t                bucketCount_ = 0;
+  std::vector<uint32_t> cellEnds_;
+  std::vector<uint32_t> stamps_;
+  uint32_t              stamp_ = 0;
+  std::vector<uint32_t> candidates_;
+  std::vector<uint32_t> emptyList_;
+};
+
+}  // namespace pcc
+
+#endif /* PCCPatchMatchIndex_h */
@@ -41,6 +41,7 @@ namespace pcc {
 
 class PCCNormalsGenerator3;
 class PCCKdTree;
+class PCCKdTreeCache;
 class PCCPatch;
 
 struct PCCPatchSegmenter3Parameters {
@@ -95,11 +96,12 @@ struct PCCPatchSegmenter3Parameters {
 
 class PCCPatchSegmenter3 {
  public:
-  PCCPatchSegmenter3( void ) : nbThread_( 0 ) {}
+  PCCPatchSegmenter3( void ) : nbThread_( 0 ), kdTreeCache_( nullptr ) {}
   PCCPatchSegmenter3( const PCCPatchSegmenter3& ) = delete;
   PCCPatchSegmenter3& operator=( const PCCPatchSegmenter3& ) = delete;
   ~PCCPatchSegmenter3()                                      = default;
   void setNbThread( size_t nbThread );
+  void setKdTreeCache( PCCKdTreeCache* kdTreeCache ) { kdTreeCache_ = kdTreeCache; }
 
   void compute( const PCCPointSet3&                 geometry,
                 const size_t                        frameIndex,
@@ -213,6 +215,7 @@ class PCCPatchSegmenter3 {
 
  private:
   size_t                nbThread_;
+  PCCKdTreeCache*       kdTreeCache_;
   std::vector<PCCPatch> boxMinDepths_;  // box depth list
   std::vector<PCCPatch> boxMaxDepths_;  // box depth list
 
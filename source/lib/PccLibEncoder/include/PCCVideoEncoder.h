@@ -349,7 +349,7 @@ class PCCVideoEncoder {
         }
         // saving the video
         video444.convertYUV444ToYUV420();
-        video = video444;
+        video.swap( video444 );
       } else {
         converter->convert( configColorSpace, video, colorSpaceConversionPath, fileName + "_rec" );
       }
@@ -390,7 +390,7 @@ class PCCVideoEncoder {
         videoRec.convertYUV420ToYUV444();
         videoRec.setDeprecatedColorFormat( 1 );
       }
-      video = videoRec;
+      video.swap( videoRec );
     } else {
       if ( keepIntermediateFiles ) { videoRec.write( recYuvFileName, nbyte ); }
       converter->convert( configInverseColorSpace, videoRec, video, colorSpaceConversionPath, fileName + "_rec" );
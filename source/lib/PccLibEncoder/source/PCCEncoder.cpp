@@ -42,7 +42,11 @@
 #include "PCCPointSet.h"
 #include "PCCEncoderParameters.h"
 #include "PCCKdTree.h"
+#include "PCCMipPyramid.h"
+#include "PCCPatchCostEstimator.h"
+#include "PCCPatchMatchIndex.h"
 #include <tbb/tbb.h>
+#include <atomic>
 #include "PCCChrono.h"
 #include "PCCEncoder.h"
 
@@ -60,7 +64,7 @@ std::string getEncoderConfig1L( const std::string& string ) {
   return result;
 }
 
-PCCEncoder::PCCEncoder() {
+PCCEncoder::PCCEncoder() : kdTreeCache_( nullptr ) {
 #ifdef ENABLE_PAPI_PROFILING
   initPapiProfiler();
 #endif
@@ -284,6 +288,7 @@ int PCCEncoder::encode( const PCCGroupOfFrames& sources, PCCContext& context, PC
                            params_.keepIntermediateFiles_ );
 
     if ( params_.lossyRawPointsPatch_ ) {
+      context.getVideoRawPointsGeometry().resize( context.size() );
       for ( size_t fi = 0; fi < context.size(); fi++ ) generateRawPointsGeometryfromVideo( context, fi );
     }
   }
@@ -505,6 +510,7 @@ int PCCEncoder::encode( const PCCGroupOfFrames& sources, PCCContext& context, PC
                              params_.colorSpaceConversionPath_ );         // colorSpaceConversionPath
       if ( params_.lossyRawPointsPatch_ ) {
         printf( "generateRawPointsTexturefromVideo \n" );
+        context.getVideoRawPointsTexture().resize( context.size() );
         for ( size_t fi = 0; fi < context.size(); fi++ ) generateRawPointsTexturefromVideo( context, fi );
       }
     }
@@ -557,7 +563,8 @@ int PCCEncoder::encode( const PCCGroupOfFrames& sources, PCCContext& context, PC
   }
 
   std::cout << "Post Processing Point Clouds" << std::endl;
-  bool isAttributes444 = static_cast<int>( params_.losslessGeo_ ) == 1;
+  bool            isAttributes444 = static_cast<int>( params_.losslessGeo_ ) == 1;
+  tbb::task_arena limited( static_cast<int>( params_.nbThread_ ) );
   for ( size_t frameIdx = 0; frameIdx < sources.getFrameCount(); frameIdx++ ) {
     auto&                        frame = context.getFrame( frameIdx );
     GeneratePointCloudParameters ppSEIParams;
@@ -579,9 +586,11 @@ int PCCEncoder::encode( const PCCGroupOfFrames& sources, PCCContext& context, PC
           // tempFrameBuffer[i].transferColors16bit( reconstructs[i], int32_t( 0
           // ), params_.losslessGeo_ == 1, 8, 1, 1,
           // 1, 1, 0, 4, 4, 1000, 1000, 1000 * 256, 1000 * 256 );
-          tempFrameBuffer.transferColors16bitBP( reconstruct, params_.postprocessSmoothingFilter_, int32_t( 0 ),
-                                                 (bool)( params_.losslessGeo_ ), 8, 1, true, true, true, false, 4, 4,
-                                                 1000, 1000, 1000 * 256, 1000 * 256 );
+          limited.execute( [&] {
+            tempFrameBuffer.transferColors16bitBP( reconstruct, params_.postprocessSmoothingFilter_, int32_t( 0 ),
+                                                   (bool)( params_.losslessGeo_ ), 8, 1, true, true, true, false, 4, 4,
+                                                   1000, 1000, 1000 * 256, 1000 * 256 );
+          } );
         } else if ( params_.postprocessSmoothingFilter_ == 2 ) {
           TRACE_PATCH( " transferColorWeight \n" );
           tempFrameBuffer.transferColorWeight( reconstruct, 0.1 );
@@ -590,9 +599,11 @@ int PCCEncoder::encode( const PCCGroupOfFrames& sources, PCCContext& context, PC
           tempFrameBuffer.transferColorsFilter3( reconstruct, int32_t( 0 ), isAttributes444 );
         } else if ( params_.postprocessSmoothingFilter_ == 7 || params_.postprocessSmoothingFilter_ == 9 ) {
           TRACE_PATCH( " transferColorsFilter3 \n" );
-          tempFrameBuffer.transferColorsBackward16bitBP( reconstruct, params_.postprocessSmoothingFilter_, int32_t( 0 ),
-                                                         isAttributes444, 8, 1, true, true, true, false, 4, 4, 1000,
-                                                         1000, 1000 * 256, 1000 * 256 );
+          limited.execute( [&] {
+            tempFrameBuffer.transferColorsBackward16bitBP( reconstruct, params_.postprocessSmoothingFilter_,
+                                                           int32_t( 0 ), isAttributes444, 8, 1, true, true, true,
+                                                           false, 4, 4, 1000, 1000, 1000 * 256, 1000 * 256 );
+          } );
         }
       }
     }
@@ -630,7 +641,8 @@ int PCCEncoder::encode( const PCCGroupOfFrames& sources, PCCContext& context, PC
   return 0;
 }
 
-void PCCEncoder::printMap( std::vector<bool> img, const size_t sizeU, const size_t sizeV ) {
+template <typename T>
+void PCCEncoder::printMap( const T& img, const size_t sizeU, const size_t sizeV ) {
   std::cout << std::endl;
   std::cout << "PrintMap size = " << sizeU << " x " << sizeV << std::endl;
   for ( size_t v = 0; v < sizeV; ++v ) {
@@ -640,10 +652,11 @@ void PCCEncoder::printMap( std::vector<bool> img, const size_t sizeU, const size
   std::cout << std::endl;
 }
 
-void PCCEncoder::printMapTetris( std::vector<bool> img,
-                                 const size_t      sizeU,
-                                 const size_t      sizeV,
-                                 std::vector<int>  horizon ) {
+template <typename T>
+void PCCEncoder::printMapTetris( const T&         img,
+                                 const size_t     sizeU,
+                                 const size_t     sizeV,
+                                 std::vector<int> horizon ) {
   std::cout << std::endl;
   std::cout << "PrintMap size = " << sizeU << " x " << sizeV << std::endl;
   for ( int v = 0; v < sizeV; ++v ) {
@@ -947,13 +960,13 @@ void PCCEncoder::adjustReferenceAtlasFrames( PCCContext& context, size_t tileInd
       if ( dTempListDist > dMinListDist ) {
         dMinListDist  = dTempListDist;
         bestListIdx   = listIdx;
-        bestPatchList = tempPatchList;
+        std::swap( bestPatchList, tempPatchList );
       }
     }
     tile.setNumRefIdxActive( std::min( frameIdx, context.getSizeOfRefAtlasFrameList( bestListIdx ) ) );
     tile.setBestRefListIndexInAsps( bestListIdx );
     tile.setRefAfocList( context, bestListIdx );
-    tile.getPatches() = bestPatchList;
+    tile.getPatches().swap( bestPatchList );
   }  // frame
 }
 
@@ -961,11 +974,10 @@ double PCCEncoder::adjustReferenceAtlasFrame( PCCContext&            context,
                                               PCCFrameContext&       tile,
                                               size_t                 tileIndex,
                                               size_t                 listIndex,
-                                              std::vector<PCCPatch>& tempPatchList ) {
+                                              std::vector<PCCPatch>& curPatches ) {
   tile.setRefAfocList( context, listIndex );
-  PCCBitstream tempBitStream;
-  auto         curPatches    = tile.getPatches();
-  size_t       curPatchCount = curPatches.size();
+  curPatches           = tile.getPatches();
+  size_t curPatchCount = curPatches.size();
   if ( curPatches.empty() ) { return -1; }
   vector<double> maxIOUList;
   maxIOUList.resize( curPatchCount, -1.0F );
@@ -985,84 +997,32 @@ double PCCEncoder::adjustReferenceAtlasFrame( PCCContext&            context,
     maxD1 = ( std::max )( maxU0, curPatches[patchIdx].getD1() );
     maxDD = ( std::max )( maxU0, curPatches[patchIdx].getSizeD() );
   }
-  auto bitMaxU0 = uint8_t( ceilLog2( uint32_t( maxU0 ) ) );
-  auto bitMaxV0 = uint8_t( ceilLog2( uint32_t( maxV0 ) ) );
-  auto bitMaxU1 = uint8_t( ceilLog2( uint32_t( maxU1 ) ) );
-  auto bitMaxV1 = uint8_t( ceilLog2( uint32_t( maxV1 ) ) );
-  auto bitMaxD1 = uint8_t( ceilLog2( uint32_t( maxD1 ) ) );
-  auto bitMaxDD = uint8_t( ceilLog2( uint32_t( maxDD ) ) );
-
   const size_t max3DCoordinate =
       size_t( 1 ) << ( params_.geometry3dCoordinatesBitdepth_ + ( params_.additionalProjectionPlaneMode_ > 0 ) );
+  PCCPatchCostEstimator costEstimator( params_.useEightOrientations_, params_.minLevel_, params_.absoluteD1_,
+                                       max3DCoordinate );
+  costEstimator.setBitCounts( uint8_t( ceilLog2( uint32_t( maxU0 ) ) ), uint8_t( ceilLog2( uint32_t( maxV0 ) ) ),
+                              uint8_t( ceilLog2( uint32_t( maxU1 ) ) ), uint8_t( ceilLog2( uint32_t( maxV1 ) ) ),
+                              uint8_t( ceilLog2( uint32_t( maxD1 ) ) ), uint8_t( ceilLog2( uint32_t( maxDD ) ) ) );
   for ( size_t curId = 0; curId < curPatchCount; curId++ ) {
-    auto& curPatch = curPatches[curId];
-    // intra
-    float initSize = tempBitStream.size();
-    tempBitStream.write( uint32_t( curPatch.getU0() ), bitMaxU0 );
-    tempBitStream.write( uint32_t( curPatch.getV0() ), bitMaxV0 );
-    tempBitStream.writeSvlc(
-        int32_t( curId == 0 ? curPatch.getSizeU0() : curPatch.getSizeU0() - curPatches[curId - 1].getSizeU0() ) );
-    tempBitStream.writeSvlc(
-        int32_t( curId == 0 ? curPatch.getSizeV0() : curPatch.getSizeV0() - curPatches[curId - 1].getSizeV0() ) );
-    tempBitStream.write( uint32_t( curPatch.getU1() ), bitMaxU1 );
-    tempBitStream.write( uint32_t( curPatch.getV1() ), bitMaxV1 );
-    tempBitStream.write( uint32_t( curPatch.getD1() ), bitMaxD1 );
-    tempBitStream.write( uint32_t( curPatch.getSizeD() ), bitMaxDD );
-    tempBitStream.write( uint32_t( curPatch.getViewId() ), 3 );
-    if ( params_.useEightOrientations_ ) {
-      tempBitStream.write( curPatch.getPatchOrientation(), 3 );
-    } else {
-      tempBitStream.write( curPatch.getPatchOrientation(), 1 );
-    }
-    if ( curPatch.getAxisOfAdditionalPlane() != 0u ) {
-      tempBitStream.write( uint32_t( curPatch.getAxisOfAdditionalPlane() ), 1 );
-    }
-    float bitCostIntraA = tempBitStream.size();
+    auto& curPatch     = curPatches[curId];
+    float bitCostIntra = costEstimator.getIntraCost( curPatch, curId == 0 ? nullptr : &curPatches[curId - 1] );
 
-    // inter
+    // inter: the unit of the previous match is only costed for the position of the following ones
     if ( curPatch.getBestMatchIdx() != -1 ) {
       int32_t refPOC = tile.getRefAfoc( 0 );
       if ( refPOC < 0 ) break;
       auto& refPatch = context[refPOC].getTile( tileIndex ).getPatch( curPatch.getBestMatchIdx() );
-      tempBitStream.writeSvlc( int32_t( static_cast<int64_t>( curPatch.getBestMatchIdx() ) - curId ) );  // approx
-      tempBitStream.writeUvlc( int32_t( 0 ) );
-      tempBitStream.writeSvlc( int32_t( curPatch.getU0() - refPatch.getU0() ) );
-      tempBitStream.writeSvlc( int32_t( curPatch.getV0() - refPatch.getV0() ) );
-      tempBitStream.writeSvlc( int32_t( curPatch.getSizeU0() - refPatch.getSizeU0() ) );
-      tempBitStream.writeSvlc( int32_t( curPatch.getSizeV0() - refPatch.getSizeV0() ) );
-      tempBitStream.writeSvlc( int32_t( curPatch.getU1() - refPatch.getU1() ) );
-      tempBitStream.writeSvlc( int32_t( curPatch.getV1() - refPatch.getV1() ) );
-
-      size_t        quantDD  = curPatch.getSizeD() == 0 ? 0 : ( ( curPatch.getSizeD() - 1 ) / params_.minLevel_ + 1 );
-      size_t        prevQDD  = refPatch.getSizeD() == 0 ? 0 : ( ( refPatch.getSizeD() - 1 ) / params_.minLevel_ + 1 );
-      const int64_t delta_dd = ( static_cast<int64_t>( quantDD ) ) - ( static_cast<int64_t>( prevQDD ) );
-      tempBitStream.writeSvlc( int32_t( delta_dd ) );  // se(v)
-
-      int32_t delta_d1 = 0;
-      if ( curPatch.getProjectionMode() == 0 || !params_.absoluteD1_ ) {
-        delta_d1 = ( ( curPatch.getD1() / params_.minLevel_ ) - ( refPatch.getD1() / params_.minLevel_ ) );
-      } else {
-        if ( curPatch.getAxisOfAdditionalPlane() == 0 ) {
-          delta_d1 = ( max3DCoordinate - curPatch.getD1() ) / params_.minLevel_ -
-                     ( max3DCoordinate - refPatch.getD1() ) / params_.minLevel_;
-        } else {
-          delta_d1 = ( ( max3DCoordinate << 1 ) - curPatch.getD1() ) / params_.minLevel_ -
-                     ( ( max3DCoordinate << 1 ) - refPatch.getD1() ) / params_.minLevel_;
-        }
-      }
-      tempBitStream.writeSvlc( delta_d1 );
+      costEstimator.getInterCost( curPatch, refPatch, static_cast<int64_t>( curPatch.getBestMatchIdx() ) - curId,
+                                  0 );  // approx
     }
-#ifdef CODEC_TRACE
-    float bitCostInterA = ( curPatch.getBestMatchIdx() != -1 ) ? tempBitStream.size() : 0;
-    float bitCostInter  = bitCostInterA - initSize;
-#endif
-    float bitCostIntra = bitCostIntraA - initSize;
-
     maxIOUList[curId] = 1 / bitCostIntra;
     curPatch.setBestMatchIdx( -1 );
   }
 
   // loop over refPicture in the list
+  PCCPatchMatchIndex matchIndex;
+  matchIndex.build( curPatches, PCCPatchMatchIndex::getReferenceKey );
   size_t sizeOfList = tile.getRefAfocListSize();
   for ( size_t refIdx = 0; refIdx < sizeOfList; refIdx++ ) {
     int32_t refPOC = tile.getRefAfoc( refIdx );
@@ -1073,51 +1033,15 @@ double PCCEncoder::adjustReferenceAtlasFrame( PCCContext&            context,
       auto& refPatch   = refPatches[refPatchId];
       float maxIou     = 0.0F;
       int   bestCurIdx = -1;
-      for ( size_t curId = 0; curId < curPatchCount; curId++ ) {
+      for ( size_t curId : matchIndex.getPatches( PCCPatchMatchIndex::getReferenceKey( refPatch ) ) ) {
         auto& curPatch     = curPatches[curId];
-        bool  bMatchingRef = refPatch.getViewId() == curPatch.getViewId() &&
-                            refPatch.getPatchOrientation() == curPatch.getPatchOrientation();
-        if ( bMatchingRef ) {
-          float initSize = tempBitStream.size();
-          tempBitStream.writeSvlc( int32_t( static_cast<int64_t>( refPatchId ) - curId ) );  // approx
-          tempBitStream.writeUvlc( int32_t( refIdx ) );
-          tempBitStream.writeSvlc( int32_t( curPatch.getU0() - refPatch.getU0() ) );
-          tempBitStream.writeSvlc( int32_t( curPatch.getV0() - refPatch.getV0() ) );
-          tempBitStream.writeSvlc( int32_t( curPatch.getSizeU0() - refPatch.getSizeU0() ) );
-          tempBitStream.writeSvlc( int32_t( curPatch.getSizeV0() - refPatch.getSizeV0() ) );
-          tempBitStream.writeSvlc( int32_t( curPatch.getU1() - refPatch.getU1() ) );
-          tempBitStream.writeSvlc( int32_t( curPatch.getV1() - refPatch.getV1() ) );
-          size_t quantDD = curPatch.getSizeD() == 0 ? 0 : ( ( curPatch.getSizeD() - 1 ) / params_.minLevel_ + 1 );
-          size_t prevQDD = refPatch.getSizeD() == 0 ? 0 : ( ( refPatch.getSizeD() - 1 ) / params_.minLevel_ + 1 );
-          const int64_t delta_dd = ( static_cast<int64_t>( quantDD ) ) - ( static_cast<int64_t>( prevQDD ) );
-          tempBitStream.writeSvlc( int32_t( delta_dd ) );  // se(v)
-
-          int32_t delta_d1 = 0;
-          if ( curPatch.getProjectionMode() == 0 || !params_.absoluteD1_ ) {
-            delta_d1 = ( ( curPatch.getD1() / params_.minLevel_ ) - ( refPatch.getD1() / params_.minLevel_ ) );
-          } else {
-            if ( curPatch.getAxisOfAdditionalPlane() == 0 ) {
-              delta_d1 = ( max3DCoordinate - curPatch.getD1() ) / params_.minLevel_ -
-                         ( max3DCoordinate - refPatch.getD1() ) / params_.minLevel_;
-            } else {
-              delta_d1 = ( ( max3DCoordinate << 1 ) - curPatch.getD1() ) / params_.minLevel_ -
-                         ( ( max3DCoordinate << 1 ) - refPatch.getD1() ) / params_.minLevel_;
-            }
-          }
-          tempBitStream.writeSvlc( delta_d1 );
-
-          //      float bitCostInterA=tempBitStream.size();
-          float bitCostInter = tempBitStream.size() - initSize;
-          // float bitCostIntra=bitCostIntraA-bitCostInterA;
-          // float areaOverlap=computeIOU( refRect, curRect );
-          float iou = 1 / bitCostInter;
-
-          if ( iou > maxIou ) {
-            maxIou     = iou;
-            bestCurIdx = curId;
-          }
-
-        }  // end of if (patch.viewId == cpatch.viewId).
+        float bitCostInter = costEstimator.getInterCost( curPatch, refPatch, static_cast<int64_t>( refPatchId ) - curId,
+                                                         refIdx );  // approx
+        float iou          = 1 / bitCostInter;
+        if ( iou > maxIou ) {
+          maxIou     = iou;
+          bestCurIdx = curId;
+        }
       }
       if ( bestCurIdx >= 0 && maxIou > maxIOUList[bestCurIdx] ) {
         curPatches[bestCurIdx].setBestMatchIdx( refPatchId );    // the matched patch id in preivious frame.
@@ -1139,14 +1063,22 @@ double PCCEncoder::adjustReferenceAtlasFrame( PCCContext&            context,
     } else {
       curPatches[patchIdx].setPatchType( static_cast<uint8_t>( P_INTRA ) );
     }
-
-    tempPatchList.push_back( curPatches[patchIdx] );
   }
 
   tile.setNumMatchedPatches( numInterPredictedPatches );
   return sumMaxIOU;
 }
 
+// Copy of the fields of a patch read by the placement tests of the packing, for the concurrent candidate searches.
+static PCCPatch getPlacementCopy( const PCCPatch& patch ) {
+  PCCPatch copy;
+  copy.getSizeU0()           = patch.getSizeU0();
+  copy.getSizeV0()           = patch.getSizeV0();
+  copy.getPatchOrientation() = patch.getPatchOrientation();
+  copy.getOccupancy()        = patch.getOccupancy();
+  return copy;
+}
+
 void PCCEncoder::spatialConsistencyPackFlexible( PCCFrameContext& tile,
                                                  PCCFrameContext& prevFrame,
                                                  int              packingStrategy,
@@ -1162,7 +1094,7 @@ void PCCEncoder::spatialConsistencyPackFlexible( PCCFrameContext& tile,
   if ( patches.empty() ) {
     if ( tile.getNumberOfRawPointsPatches() == 0 ) { return; }
     if ( tile.getUseRawPointsSeparateVideo() ) { return; }
-    std::vector<bool> occupancyMap;
+    PCCBitboardCanvas occupancyMap;
     size_t            occupancySizeU = presetWidth / params_.occupancyResolution_;
     size_t            occupancySizeV = presetHeight / params_.occupancyResolution_;
     if ( presetWidth == 0 || presetHeight == 0 ) {
@@ -1173,7 +1105,7 @@ void PCCEncoder::spatialConsistencyPackFlexible( PCCFrameContext& tile,
       if ( presetHeight == 0 )
         occupancySizeV = static_cast<size_t>( ceil( double( rawPointsPatchBlocks ) / occupancySizeU ) );
     }
-    occupancyMap.resize( occupancySizeU * occupancySizeV );
+    occupancyMap.resize( occupancySizeU, occupancySizeV );
     if ( tile.getNumberOfRawPointsPatches() > 0 && !tile.getUseRawPointsSeparateVideo() ) {
       packRawPointsPatch( tile, occupancyMap, width, height, occupancySizeU, occupancySizeV, 0 );
     } else {
@@ -1210,30 +1142,22 @@ void PCCEncoder::spatialConsistencyPackFlexible( PCCFrameContext& tile,
   matchedPatches.clear();
   float  thresholdIOU    = 0.2F;
   size_t bestRefFrameIdx = 0;
+
+  PCCPatchMatchIndex matchIndex;
+  matchIndex.build( patches,
+                    []( const PCCPatch& patch ) { return PCCPatchMatchIndex::getMatchingKey( patch, false ); } );
   // main loop.
   for ( auto& patch : prevPatches ) {
     id++;
+    auto key = PCCPatchMatchIndex::getMatchingKey( patch, false );
+    if ( matchIndex.hasUnmatchedPatches( key ) ) { patch.setPatchType( static_cast<uint8_t>( P_INTRA ) ); }
     float maxIou  = 0.0F;
-    int   bestIdx = -1;
-    int   cId     = 0;
-    for ( auto& cpatch : patches ) {
-      if ( ( patch.getViewId() == cpatch.getViewId() ) && ( cpatch.getBestMatchIdx() == InvalidPatchIndex ) &&
-           ( patch.getLodScaleX() == cpatch.getLodScaleX() && patch.getLodScaleY() == cpatch.getLodScaleY() ) ) {
-        patch.setPatchType( static_cast<uint8_t>( P_INTRA ) );
-        Rect  rect  = Rect( patch.getU1(), patch.getV1(), patch.getSizeU(), patch.getSizeV() );
-        Rect  crect = Rect( cpatch.getU1(), cpatch.getV1(), cpatch.getSizeU(), cpatch.getSizeV() );
-        float iou   = computeIOU( rect, crect );
-        if ( iou > maxIou ) {
-          maxIou  = iou;
-          bestIdx = cId;
-        }
-      }  // end of if (patch.viewId == cpatch.viewId).
-      cId++;
-    }
+    int   bestIdx = matchIndex.findBestMatch( patches, patch, key, maxIou );
 
     if ( maxIou > thresholdIOU ) {
       // store the best match index
       patches[bestIdx].setBestMatchIdx( id - 1 );  // the matched patch id in preivious frame.
+      matchIndex.setMatched( key );
       patches[bestIdx].setPatchType( static_cast<uint8_t>( P_INTER ) );
       patches[bestIdx].setRefAtlasFrameIndex( bestRefFrameIdx );
       matchedPatches.push_back( patches[bestIdx] );
@@ -1282,8 +1206,8 @@ void PCCEncoder::spatialConsistencyPackFlexible( PCCFrameContext& tile,
   size_t maxOccupancyRow{0};
 
   int               numOrientations = packingStrategy == 0 ? 1 : ( params_.useEightOrientations_ ? 8 : 2 );
-  std::vector<bool> occupancyMap;
-  occupancyMap.resize( occupancySizeU * occupancySizeV, false );
+  PCCBitboardCanvas occupancyMap;
+  occupancyMap.resize( occupancySizeU, occupancySizeV );
   for ( auto& patch : patches ) {
     assert( patch.getSizeU0() <= occupancySizeU );
     assert( patch.getSizeV0() <= occupancySizeV );
@@ -1349,16 +1273,16 @@ void PCCEncoder::spatialConsistencyPackFlexible( PCCFrameContext& tile,
       }
       if ( !locationFound ) {
         occupancySizeV *= 2;
-        occupancyMap.resize( occupancySizeU * occupancySizeV );
+        occupancyMap.resize( occupancySizeU, occupancySizeV );
       }
     }
     for ( size_t v0 = 0; v0 < patch.getSizeV0(); ++v0 ) {
       for ( size_t u0 = 0; u0 < patch.getSizeU0(); ++u0 ) {
         int coord = patch.patchBlock2CanvasBlock( u0, v0, occupancySizeU, occupancySizeV );
         if ( params_.lowDelayEncoding_ ) {
-          occupancyMap[coord] = true;
+          occupancyMap.set( coord );
         } else {
-          occupancyMap[coord] = occupancyMap[coord] || occupancy[v0 * patch.getSizeU0() + u0];
+          if ( occupancy[v0 * patch.getSizeU0() + u0] ) { occupancyMap.set( coord ); }
         }
       }
     }
@@ -1406,31 +1330,22 @@ void PCCEncoder::spatialConsistencyPackTetris( PCCFrameContext& frame,
   matchedPatches.clear();
   float thresholdIOU = 0.2F;
 
+  PCCPatchMatchIndex matchIndex;
+  matchIndex.build( patches,
+                    []( const PCCPatch& patch ) { return PCCPatchMatchIndex::getMatchingKey( patch, false ); } );
   // main loop.
   for ( auto& patch : prevPatches ) {
     assert( patch.getSizeU0() <= occupancySizeU );
     assert( patch.getSizeV0() <= occupancySizeV );
     id++;
+    auto  key     = PCCPatchMatchIndex::getMatchingKey( patch, false );
     float maxIou  = 0.0;
-    int   bestIdx = -1;
-    int   cId     = 0;
-    for ( auto& cpatch : patches ) {
-      if ( ( patch.getViewId() == cpatch.getViewId() ) && ( cpatch.getBestMatchIdx() == -1 ) &&
-           ( patch.getLodScaleX() == cpatch.getLodScaleX() && patch.getLodScaleY() == cpatch.getLodScaleY() ) ) {
-        Rect  rect  = Rect( patch.getU1(), patch.getV1(), patch.getSizeU(), patch.getSizeV() );
-        Rect  crect = Rect( cpatch.getU1(), cpatch.getV1(), cpatch.getSizeU(), cpatch.getSizeV() );
-        float iou   = computeIOU( rect, crect );
-        if ( iou > maxIou ) {
-          maxIou  = iou;
-          bestIdx = cId;
-        }
-      }  // end of if (patch.viewId == cpatch.viewId).
-      cId++;
-    }
+    int   bestIdx = matchIndex.findBestMatch( patches, patch, key, maxIou );
 
     if ( maxIou > thresholdIOU ) {
       // store the best match index
       patches[bestIdx].setBestMatchIdx( id - 1 );  // the matched patch id in preivious frame.
+      matchIndex.setMatched( key );
       patches[bestIdx].setPatchType( static_cast<uint8_t>( P_INTER ) );
       matchedPatches.push_back( patches[bestIdx] );
     }
@@ -1466,8 +1381,8 @@ void PCCEncoder::spatialConsistencyPackTetris( PCCFrameContext& frame,
   height = occupancySizeV * params_.occupancyResolution_;
   size_t maxOccupancyRow{0};
 
-  std::vector<bool> occupancyMap;
-  occupancyMap.resize( occupancySizeU * occupancySizeV, false );
+  PCCBitboardCanvas occupancyMap;
+  occupancyMap.resize( occupancySizeU, occupancySizeV );
   std::vector<int> horizon;
   horizon.resize( occupancySizeU, 0 );
 
@@ -1560,7 +1475,7 @@ void PCCEncoder::spatialConsistencyPackTetris( PCCFrameContext& frame,
       }
       if ( !locationFound ) {
         occupancySizeV *= 2;
-        occupancyMap.resize( occupancySizeU * occupancySizeV );
+        occupancyMap.resize( occupancySizeU, occupancySizeV );
       } else {
         // select the best position and orientation
         patch.getU0()               = best_u;
@@ -1584,9 +1499,9 @@ void PCCEncoder::spatialConsistencyPackTetris( PCCFrameContext& frame,
       for ( size_t u0 = 0; u0 < patch.getSizeU0(); ++u0 ) {
         int coord = patch.patchBlock2CanvasBlock( u0, v0, occupancySizeU, occupancySizeV );
         if ( params_.lowDelayEncoding_ ) {
-          occupancyMap[coord] = true;
+          occupancyMap.set( coord );
         } else {
-          occupancyMap[coord] = occupancyMap[coord] || occupancy[v0 * patch.getSizeU0() + u0];
+          if ( occupancy[v0 * patch.getSizeU0() + u0] ) { occupancyMap.set( coord ); }
         }
       }
     }
@@ -1641,25 +1556,16 @@ void PCCEncoder::findMatchesForGlobalTetrisPacking( PCCFrameContext& tile, PCCFr
   int              id = 0;
   matchedPatches.clear();
   float thresholdIOU = 0.2F;
+
+  PCCPatchMatchIndex matchIndex;
+  matchIndex.build( patches,
+                    []( const PCCPatch& patch ) { return PCCPatchMatchIndex::getMatchingKey( patch, false ); } );
   // main loop.
   for ( auto& patch : prevPatches ) {
     id++;
+    auto  key     = PCCPatchMatchIndex::getMatchingKey( patch, false );
     float maxIou  = 0.0F;
-    int   bestIdx = -1;
-    int   cId     = 0;
-    for ( auto& cpatch : patches ) {
-      if ( ( patch.getViewId() == cpatch.getViewId() ) && ( cpatch.getBestMatchIdx() == InvalidPatchIndex ) &&
-           ( patch.getLodScaleX() == cpatch.getLodScaleX() && patch.getLodScaleY() == cpatch.getLodScaleY() ) ) {
-        Rect  rect  = Rect( patch.getU1(), patch.getV1(), patch.getSizeU(), patch.getSizeV() );
-        Rect  crect = Rect( cpatch.getU1(), cpatch.getV1(), cpatch.getSizeU(), cpatch.getSizeV() );
-        float iou   = computeIOU( rect, crect );
-        if ( iou > maxIou ) {
-          maxIou  = iou;
-          bestIdx = cId;
-        }
-      }  // end of if (patch.viewId == cpatch.viewId).
-      cId++;
-    }
+    int   bestIdx = matchIndex.findBestMatch( patches, patch, key, maxIou );
     if ( maxIou > thresholdIOU ) {
       // checking the size of the matched patches
       auto&  curPatch = patches[bestIdx];
@@ -1682,6 +1588,7 @@ void PCCEncoder::findMatchesForGlobalTetrisPacking( PCCFrameContext& tile, PCCFr
       } else {
         // store the best match index
         patches[bestIdx].setBestMatchIdx( id - 1 );  // the matched patch id in previous frame.
+        matchIndex.setMatched( key );
         matchedPatches.push_back( patches[bestIdx] );
       }
     }
@@ -1983,8 +1890,8 @@ void PCCEncoder::doGlobalTetrisPacking( PCCContext& context,
       }
       numOrientations = params_.packingStrategy_ == 0 ? 1 : ( params_.useEightOrientations_ ? 8 : 2 );
 
-      std::vector<bool> occupancyMap;
-      occupancyMap.resize( occupancySizeU * occupancySizeV, false );
+      PCCBitboardCanvas occupancyMap;
+      occupancyMap.resize( occupancySizeU, occupancySizeV );
       int indNextMatchedPatch = 0;
       // patch loop
       for ( int patchIdx = 0; patchIdx < patchMatrixSortedIndexes[frameIdx].size(); patchIdx++ ) {
@@ -2206,7 +2113,7 @@ void PCCEncoder::doGlobalTetrisPacking( PCCContext& context,
           }
           if ( !locationFound ) {
             occupancySizeV *= 2;
-            occupancyMap.resize( occupancySizeU * occupancySizeV );
+            occupancyMap.resize( occupancySizeU, occupancySizeV );
             if ( printDetailedInfo ) {
               std::cout << "Increasing the canvas size (" << occupancySizeU << "," << occupancySizeV << ")"
                         << std::endl;
@@ -2271,9 +2178,9 @@ void PCCEncoder::doGlobalTetrisPacking( PCCContext& context,
           for ( size_t u0 = 0; u0 < curGlobalElem.getSizeU0(); ++u0 ) {
             int coord = curGlobalElem.patchBlock2CanvasBlock( u0, v0, occupancySizeU, occupancySizeV );
             if ( params_.lowDelayEncoding_ ) {
-              occupancyMap[coord] = true;
+              occupancyMap.set( coord );
             } else {
-              occupancyMap[coord] = occupancyMap[coord] || occupancy[v0 * curGlobalElem.getSizeU0() + u0];
+              if ( occupancy[v0 * curGlobalElem.getSizeU0() + u0] ) { occupancyMap.set( coord ); }
             }
           }
         }
@@ -2333,7 +2240,7 @@ void PCCEncoder::packFlexible( PCCFrameContext& tile,
   if ( patches.empty() ) {
     if ( tile.getNumberOfRawPointsPatches() == 0 ) { return; }
     if ( tile.getUseRawPointsSeparateVideo() ) { return; }
-    std::vector<bool> occupancyMap;
+    PCCBitboardCanvas occupancyMap;
     size_t            occupancySizeU = presetWidth / params_.occupancyResolution_;
     size_t            occupancySizeV = presetHeight / params_.occupancyResolution_;
     if ( presetWidth == 0 || presetHeight == 0 ) {
@@ -2344,7 +2251,7 @@ void PCCEncoder::packFlexible( PCCFrameContext& tile,
       if ( presetHeight == 0 )
         occupancySizeV = static_cast<size_t>( ceil( double( rawPointsPatchBlocks ) / occupancySizeU ) );
     }
-    occupancyMap.resize( occupancySizeU * occupancySizeV );
+    occupancyMap.resize( occupancySizeU, occupancySizeV );
     if ( tile.getNumberOfRawPointsPatches() > 0 && !tile.getUseRawPointsSeparateVideo() ) {
       packRawPointsPatch( tile, occupancyMap, width, height, occupancySizeU, occupancySizeV, 0 );
     } else {
@@ -2396,52 +2303,73 @@ void PCCEncoder::packFlexible( PCCFrameContext& tile,
   height = occupancySizeV * params_.occupancyResolution_;
   size_t maxOccupancyRow{0};
 
-  std::vector<bool> occupancyMap;
+  PCCBitboardCanvas occupancyMap;
   int               numOrientations = ( packingStrategy == 0 ) ? 1 : ( params_.useEightOrientations_ ? 8 : 2 );
-  occupancyMap.resize( occupancySizeU * occupancySizeV, false );
+  occupancyMap.resize( occupancySizeU, occupancySizeV );
   for ( auto& patch : patches ) {
     assert( patch.getSizeU0() <= occupancySizeU );
     assert( patch.getSizeV0() <= occupancySizeV );
     bool  locationFound = false;
     auto& occupancy     = patch.getOccupancy();
     while ( !locationFound ) {
-      for ( size_t v = 0; v < occupancySizeV && !locationFound; ++v ) {
-        for ( size_t u = 0; u < occupancySizeU && !locationFound; ++u ) {
-          patch.getU0() = u;
-          patch.getV0() = v;
-          for ( size_t orientationIdx = 0; orientationIdx < numOrientations && !locationFound; orientationIdx++ ) {
-            if ( packingStrategy == 0 )
-              patch.getPatchOrientation() = PATCH_ORIENTATION_DEFAULT;
-            else {
-              if ( patch.getSizeU0() > patch.getSizeV0() ) {
-                patch.getPatchOrientation() = orientation_horizontal[orientationIdx];
-              } else {
-                patch.getPatchOrientation() = orientation_vertical[orientationIdx];
+      // the rows are searched concurrently for their first fitting position, the rows below a row where the patch
+      // fits are skipped and the first of these rows gives the position found by a sequential search
+      std::atomic<size_t> firstRow( occupancySizeV );
+      std::vector<size_t> rowU( occupancySizeV, 0 );
+      std::vector<size_t> rowOrientation( occupancySizeV, 0 );
+      tbb::task_arena     limited( static_cast<int>( params_.nbThread_ ) );
+      limited.execute( [&] {
+        tbb::parallel_for( tbb::blocked_range<size_t>( 0, occupancySizeV ), [&]( const tbb::blocked_range<size_t>& r ) {
+          PCCPatch candidate = getPlacementCopy( patch );
+          for ( size_t v = r.begin(); v < r.end() && v < firstRow; ++v ) {
+            bool fit = false;
+            for ( size_t u = 0; u < occupancySizeU && !fit; ++u ) {
+              candidate.getU0() = u;
+              candidate.getV0() = v;
+              for ( size_t orientationIdx = 0; orientationIdx < numOrientations && !fit; orientationIdx++ ) {
+                if ( packingStrategy == 0 )
+                  candidate.getPatchOrientation() = PATCH_ORIENTATION_DEFAULT;
+                else {
+                  if ( candidate.getSizeU0() > candidate.getSizeV0() ) {
+                    candidate.getPatchOrientation() = orientation_horizontal[orientationIdx];
+                  } else {
+                    candidate.getPatchOrientation() = orientation_vertical[orientationIdx];
+                  }
+                }
+                fit = candidate.checkFitPatchCanvas( occupancyMap, occupancySizeU, occupancySizeV,
+                                                     params_.lowDelayEncoding_, safeguard );
               }
             }
-            if ( patch.checkFitPatchCanvas( occupancyMap, occupancySizeU, occupancySizeV, params_.lowDelayEncoding_,
-                                            safeguard ) ) {
-              locationFound = true;
-              if ( printDetailedInfo ) {
-                std::cout << "Orientation " << patch.getPatchOrientation() << " selected for patch " << patch.getIndex()
-                          << " (" << u << "," << v << ")" << std::endl;
-              }
+            if ( fit ) {
+              rowU[v]           = candidate.getU0();
+              rowOrientation[v] = candidate.getPatchOrientation();
+              size_t row        = firstRow;
+              while ( v < row && !firstRow.compare_exchange_weak( row, v ) ) {}
             }
           }
+        } );
+      } );
+      if ( firstRow < occupancySizeV ) {
+        locationFound               = true;
+        patch.getU0()               = rowU[firstRow];
+        patch.getV0()               = firstRow;
+        patch.getPatchOrientation() = rowOrientation[firstRow];
+        if ( printDetailedInfo ) {
+          std::cout << "Orientation " << patch.getPatchOrientation() << " selected for patch " << patch.getIndex()
+                    << " (" << patch.getU0() << "," << patch.getV0() << ")" << std::endl;
         }
-      }
-      if ( !locationFound ) {
+      } else {
         occupancySizeV *= 2;
-        occupancyMap.resize( occupancySizeU * occupancySizeV );
+        occupancyMap.resize( occupancySizeU, occupancySizeV );
       }
     }
     for ( size_t v0 = 0; v0 < patch.getSizeV0(); ++v0 ) {
       for ( size_t u0 = 0; u0 < patch.getSizeU0(); ++u0 ) {
         int coord = patch.patchBlock2CanvasBlock( u0, v0, occupancySizeU, occupancySizeV );
         if ( params_.lowDelayEncoding_ ) {
-          occupancyMap[coord] = true;
+          occupancyMap.set( coord );
         } else {
-          occupancyMap[coord] = occupancyMap[coord] || occupancy[v0 * patch.getSizeU0() + u0];
+          if ( occupancy[v0 * patch.getSizeU0() + u0] ) { occupancyMap.set( coord ); }
         }
       }
     }
@@ -2496,8 +2424,8 @@ void PCCEncoder::packMultipleTiles( PCCAtlasFrameContext& atlasFrame, int safegu
   height = occupancySizeV * params_.occupancyResolution_;
   size_t maxOccupancyRow{0};
 
-  std::vector<bool> occupancyMap;
-  occupancyMap.resize( occupancySizeU * occupancySizeV, false );
+  PCCBitboardCanvas occupancyMap;
+  occupancyMap.resize( occupancySizeU, occupancySizeV );
 
   std::vector<Tile> tilesNotAvailable;  // set of all tiles occupied by prev
                                         // ROIs of current ROI
@@ -2565,15 +2493,14 @@ void PCCEncoder::packMultipleTiles( PCCAtlasFrameContext& atlasFrame, int safegu
         }
         if ( !locationFound ) {
           occupancySizeV *= 2;
-          occupancyMap.resize( occupancySizeU * occupancySizeV );
+          occupancyMap.resize( occupancySizeU, occupancySizeV );
         }
       }
       for ( size_t v0 = 0; v0 < patch.getSizeV0(); ++v0 ) {
         const size_t v = patch.getV0() + v0;
         for ( size_t u0 = 0; u0 < patch.getSizeU0(); ++u0 ) {
           const size_t u = patch.getU0() + u0;
-          occupancyMap[v * occupancySizeU + u] =
-              occupancyMap[v * occupancySizeU + u] || occupancy[v0 * patch.getSizeU0() + u0];
+          if ( occupancy[v0 * patch.getSizeU0() + u0] ) { occupancyMap.set( u, v ); }
         }
       }
       height          = ( std::max )( height, ( patch.getV0() + patch.getSizeV0() ) * patch.getOccupancyResolution() );
@@ -2624,7 +2551,7 @@ void PCCEncoder::packFlexibleMultipleTiles( PCCAtlasFrameContext& atlasFrame, in
   height = occupancySizeV * params_.occupancyResolution_;
   size_t maxOccupancyRow{0};
 
-  std::vector<bool> occupancyMap;
+  PCCBitboardCanvas occupancyMap;
   vector<int>       orientation_vertical = {
       PATCH_ORIENTATION_DEFAULT, PATCH_ORIENTATION_SWAP,    PATCH_ORIENTATION_ROT180,
       PATCH_ORIENTATION_MIRROR,  PATCH_ORIENTATION_MROT180, PATCH_ORIENTATION_ROT270,
@@ -2635,7 +2562,7 @@ void PCCEncoder::packFlexibleMultipleTiles( PCCAtlasFrameContext& atlasFrame, in
       PATCH_ORIENTATION_MIRROR, PATCH_ORIENTATION_MROT180};  // favoring horizontal orientations (that should be
                                                              // rotated)
   int numOrientations = params_.useEightOrientations_ ? 8 : 2;
-  occupancyMap.resize( occupancySizeU * occupancySizeV, false );
+  occupancyMap.resize( occupancySizeU, occupancySizeV );
   std::vector<Tile> tilesNotAvailable;  // set of all tiles occupied by prev
                                         // ROIs of current ROI
   int lastOccupiedTileIndex          = -1;
@@ -2675,7 +2602,7 @@ void PCCEncoder::packFlexibleMultipleTiles( PCCAtlasFrameContext& atlasFrame, in
       if ( !foundLimits ) {
         // the map might not have any available tiles, let's increase the size of the canvas
         occupancySizeV *= 2;
-        occupancyMap.resize( occupancySizeU * occupancySizeV );
+        occupancyMap.resize( occupancySizeU, occupancySizeV );
         // resizing the partitionToTile as well
         int numTilesVerNew = occupancySizeV / tileHeight;
         partitionToTileMap.resize( numTilesHor * numTilesVerNew );
@@ -2737,7 +2664,7 @@ void PCCEncoder::packFlexibleMultipleTiles( PCCAtlasFrameContext& atlasFrame, in
         }
         if ( !locationFound ) {
           occupancySizeV *= 2;
-          occupancyMap.resize( occupancySizeU * occupancySizeV );
+          occupancyMap.resize( occupancySizeU, occupancySizeV );
           // resizing the partitionToTile as well
           int numTilesVerNew = occupancySizeV / tileHeight;
           partitionToTileMap.resize( numTilesHor * numTilesVerNew );
@@ -2749,9 +2676,9 @@ void PCCEncoder::packFlexibleMultipleTiles( PCCAtlasFrameContext& atlasFrame, in
         for ( size_t u0 = 0; u0 < patch.getSizeU0(); ++u0 ) {
           int coord = patch.patchBlock2CanvasBlock( u0, v0, occupancySizeU, occupancySizeV );
           if ( params_.lowDelayEncoding_ )
-            occupancyMap[coord] = true;
+            occupancyMap.set( coord );
           else
-            occupancyMap[coord] = occupancyMap[coord] || occupancy[v0 * patch.getSizeU0() + u0];
+            if ( occupancy[v0 * patch.getSizeU0() + u0] ) { occupancyMap.set( coord ); }
           // also claim the tile for the ROI
           size_t x, y;
           patch.patch2Canvas( u0, v0, occupancySizeU * patch.getOccupancyResolution(),
@@ -2800,30 +2727,21 @@ void PCCEncoder::spatialConsistencyPackMultipleTiles( PCCAtlasFrameContext& atla
   newOrderPatches.clear();
   float thresholdIOU = 0.2f;
 
+  PCCPatchMatchIndex matchIndex;
+  matchIndex.build( patches,
+                    []( const PCCPatch& patch ) { return PCCPatchMatchIndex::getMatchingKey( patch, true ); } );
   // main loop. (NOTICE: enforcing the match to be from the same ROI)
   for ( auto& patch : prevPatches ) {
     assert( patch.getSizeU0() <= occupancySizeU );
     assert( patch.getSizeV0() <= occupancySizeV );
     id++;
+    auto  key     = PCCPatchMatchIndex::getMatchingKey( patch, true );
     float maxIou  = 0.0f;
-    int   bestIdx = -1, cId = 0;
-    for ( auto& cpatch : patches ) {
-      if ( ( patch.getViewId() == cpatch.getViewId() ) && ( cpatch.getBestMatchIdx() == InvalidPatchIndex ) &&
-           ( patch.getLodScaleX() == cpatch.getLodScaleX() && patch.getLodScaleY() == cpatch.getLodScaleY() ) &&
-           ( patch.getRoiIndex() == cpatch.getRoiIndex() ) ) {
-        Rect  rect  = Rect( patch.getU1(), patch.getV1(), patch.getSizeU(), patch.getSizeV() );
-        Rect  crect = Rect( cpatch.getU1(), cpatch.getV1(), cpatch.getSizeU(), cpatch.getSizeV() );
-        float iou   = computeIOU( rect, crect );
-        if ( iou > maxIou ) {
-          maxIou  = iou;
-          bestIdx = cId;
-        }
-      }  // end of if (patch.viewId == cpatch.viewId).
-      cId++;
-    }
+    int   bestIdx = matchIndex.findBestMatch( patches, patch, key, maxIou );
     if ( maxIou > thresholdIOU ) {
       // store the best match index
       patches[bestIdx].setBestMatchIdx( id - 1 );  // the matched patch id in previous frame.
+      matchIndex.setMatched( key );
       patches[bestIdx].setPatchType( (uint8_t)P_INTER );
       matchedPatches.push_back( patches[bestIdx] );
     }
@@ -2856,8 +2774,8 @@ void PCCEncoder::spatialConsistencyPackMultipleTiles( PCCAtlasFrameContext& atla
   height = occupancySizeV * params_.occupancyResolution_;
   size_t maxOccupancyRow{0};
 
-  std::vector<bool> occupancyMap;
-  occupancyMap.resize( occupancySizeU * occupancySizeV, false );
+  PCCBitboardCanvas occupancyMap;
+  occupancyMap.resize( occupancySizeU, occupancySizeV );
   std::vector<Tile> tilesNotAvailable;
   int               numROIs                        = params_.numROIs_;
   int               lastOccupiedTileIndex          = -1;
@@ -2921,15 +2839,14 @@ void PCCEncoder::spatialConsistencyPackMultipleTiles( PCCAtlasFrameContext& atla
             }
             if ( !locationFound ) {
               occupancySizeV *= 2;
-              occupancyMap.resize( occupancySizeU * occupancySizeV );
+              occupancyMap.resize( occupancySizeU, occupancySizeV );
             }
           }
           for ( size_t v0 = 0; v0 < patch.getSizeV0(); ++v0 ) {
             const size_t v = patch.getV0() + v0;
             for ( size_t u0 = 0; u0 < patch.getSizeU0(); ++u0 ) {
               const size_t u = patch.getU0() + u0;
-              occupancyMap[v * occupancySizeU + u] =
-                  occupancyMap[v * occupancySizeU + u] || occupancy[v0 * patch.getSizeU0() + u0];
+              if ( occupancy[v0 * patch.getSizeU0() + u0] ) { occupancyMap.set( u, v ); }
             }
           }
 
@@ -2964,29 +2881,21 @@ void PCCEncoder::spatialConsistencyPackFlexibleMultipleTiles( PCCAtlasFrameConte
   matchedPatches.clear();
   float  thresholdIOU    = 0.2f;
   size_t bestRefFrameIdx = 0;
+
+  PCCPatchMatchIndex matchIndex;
+  matchIndex.build( patches,
+                    []( const PCCPatch& patch ) { return PCCPatchMatchIndex::getMatchingKey( patch, true ); } );
   // main loop. (NOTE: enforcing the matches to be from the same ROI)
   for ( auto& patch : prevPatches ) {
     id++;
+    auto key = PCCPatchMatchIndex::getMatchingKey( patch, true );
+    if ( matchIndex.hasUnmatchedPatches( key ) ) { patch.setPatchType( (uint8_t)P_INTRA ); }
     float maxIou  = 0.0f;
-    int   bestIdx = -1, cId = 0;
-    for ( auto& cpatch : patches ) {
-      if ( ( patch.getViewId() == cpatch.getViewId() ) && ( cpatch.getBestMatchIdx() == InvalidPatchIndex ) &&
-           ( patch.getLodScaleX() == cpatch.getLodScaleX() && patch.getLodScaleY() == cpatch.getLodScaleY() &&
-             ( patch.getRoiIndex() == cpatch.getRoiIndex() ) ) ) {
-        patch.setPatchType( (uint8_t)P_INTRA );
-        Rect  rect  = Rect( patch.getU1(), patch.getV1(), patch.getSizeU(), patch.getSizeV() );
-        Rect  crect = Rect( cpatch.getU1(), cpatch.getV1(), cpatch.getSizeU(), cpatch.getSizeV() );
-        float iou   = computeIOU( rect, crect );
-        if ( iou > maxIou ) {
-          maxIou  = iou;
-          bestIdx = cId;
-        }
-      }  // end of if (patch.viewId == cpatch.viewId).
-      cId++;
-    }
+    int   bestIdx = matchIndex.findBestMatch( patches, patch, key, maxIou );
     if ( maxIou > thresholdIOU ) {
       // store the best match index
       patches[bestIdx].setBestMatchIdx( id - 1 );  // the matched patch id in preivious frame.
+      matchIndex.setMatched( key );
       patches[bestIdx].setPatchType( (uint8_t)P_INTER );
       patches[bestIdx].setRefAtlasFrameIndex( bestRefFrameIdx );
       matchedPatches.push_back( patches[bestIdx] );
@@ -3044,8 +2953,8 @@ void PCCEncoder::spatialConsistencyPackFlexibleMultipleTiles( PCCAtlasFrameConte
       PATCH_ORIENTATION_MIRROR, PATCH_ORIENTATION_MROT180};  // favoring horizontal orientations (that should be
                                                              // rotated)
   int               numOrientations = params_.useEightOrientations_ ? 8 : 2;
-  std::vector<bool> occupancyMap;
-  occupancyMap.resize( occupancySizeU * occupancySizeV, false );
+  PCCBitboardCanvas occupancyMap;
+  occupancyMap.resize( occupancySizeU, occupancySizeV );
   // loop over ROIs
   for ( size_t roiIndex = 0; roiIndex < numROIs; ++roiIndex ) {
     // calculate the position which the tile group will start: top left available tile
@@ -3081,7 +2990,7 @@ void PCCEncoder::spatialConsistencyPackFlexibleMultipleTiles( PCCAtlasFrameConte
       if ( !foundLimits ) {
         // the map might not have any available tiles, let's increase the size of the canvas
         occupancySizeV *= 2;
-        occupancyMap.resize( occupancySizeU * occupancySizeV );
+        occupancyMap.resize( occupancySizeU, occupancySizeV );
         // resizing the partitionToTile as well
         int numTilesVerNew = occupancySizeV / tileHeight;
         partitionToTileMap.resize( numTilesHor * numTilesVerNew );
@@ -3217,7 +3126,7 @@ void PCCEncoder::spatialConsistencyPackFlexibleMultipleTiles( PCCAtlasFrameConte
         }
         if ( !locationFound ) {
           occupancySizeV *= 2;
-          occupancyMap.resize( occupancySizeU * occupancySizeV );
+          occupancyMap.resize( occupancySizeU, occupancySizeV );
           // resizing the partitionToTile as well
           int numTilesVerNew = occupancySizeV / tileHeight;
           partitionToTileMap.resize( numTilesHor * numTilesVerNew );
@@ -3229,9 +3138,9 @@ void PCCEncoder::spatialConsistencyPackFlexibleMultipleTiles( PCCAtlasFrameConte
         for ( size_t u0 = 0; u0 < patch.getSizeU0(); ++u0 ) {
           int coord = patch.patchBlock2CanvasBlock( u0, v0, occupancySizeU, occupancySizeV );
           if ( params_.lowDelayEncoding_ )
-            occupancyMap[coord] = true;
+            occupancyMap.set( coord );
           else
-            occupancyMap[coord] = occupancyMap[coord] || occupancy[v0 * patch.getSizeU0() + u0];
+            if ( occupancy[v0 * patch.getSizeU0() + u0] ) { occupancyMap.set( coord ); }
           // also claim the tile for the ROI
           size_t x, y;
           patch.patch2Canvas( u0, v0, occupancySizeU * patch.getOccupancyResolution(),
@@ -3288,8 +3197,8 @@ void PCCEncoder::packTetris( PCCFrameContext& frame, size_t presetWidth, size_t
   height = occupancySizeV * params_.occupancyResolution_;
   size_t maxOccupancyRow{0};
 
-  std::vector<bool> occupancyMap;
-  occupancyMap.resize( occupancySizeU * occupancySizeV, false );
+  PCCBitboardCanvas occupancyMap;
+  occupancyMap.resize( occupancySizeU, occupancySizeV );
   std::vector<int> horizon;
   horizon.resize( occupancySizeU, 0 );
   if ( printDetailedInfo ) {
@@ -3323,43 +3232,53 @@ void PCCEncoder::packTetris( PCCFrameContext& frame, size_t presetWidth, size_t
       size_t best_u;
       size_t best_v;
       int    best_orientation;
-      for ( size_t u = 0; u < occupancySizeU; ++u ) {
-        for ( size_t v = 0; v < occupancySizeV; ++v ) {
-          patch.getU0() = u;
-          patch.getV0() = v;
-          for ( size_t orientationIdx = 0; orientationIdx < numOrientations; orientationIdx++ ) {
-            patch.getPatchOrientation() = orientation_values[orientationIdx];
-            if ( !patch.isPatchLocationAboveHorizon( horizon, top_horizon, bottom_horizon, right_horizon,
-                                                     left_horizon ) ) {
-              if ( printDetailedInfo ) {
-                std::cout << "(" << u << "," << v << "|" << patch.getPatchOrientation() << ") above horizon"
-                          << std::endl;
-              }
-              continue;
-            }
-            if ( printDetailedInfo ) {
-              std::cout << "(" << u << "," << v << "|" << patch.getPatchOrientation() << ")" << std::endl;
-            }
-            if ( patch.checkFitPatchCanvas( occupancyMap, occupancySizeU, occupancySizeV, params_.lowDelayEncoding_,
-                                            safeguard ) ) {
-              // now calculate the wasted space
-              int wasted_space =
-                  patch.calculate_wasted_space( horizon, top_horizon, bottom_horizon, right_horizon, left_horizon );
-              if ( printDetailedInfo ) { std::cout << "(wasted space) = " << wasted_space << std::endl; }
-              if ( wasted_space < best_wasted_space ) {
-                best_wasted_space = wasted_space;
-                best_u            = u;
-                best_v            = v;
-                best_orientation  = patch.getPatchOrientation();
-                locationFound     = true;
+      // the columns are searched concurrently, then the best columns are compared in the serial scan order so that
+      // the ties are broken as by a sequential search
+      std::vector<int>    columnWastedSpace( occupancySizeU, best_wasted_space );
+      std::vector<size_t> columnV( occupancySizeU, 0 );
+      std::vector<int>    columnOrientation( occupancySizeU, 0 );
+      tbb::task_arena     limited( static_cast<int>( params_.nbThread_ ) );
+      limited.execute( [&] {
+        tbb::parallel_for( tbb::blocked_range<size_t>( 0, occupancySizeU ), [&]( const tbb::blocked_range<size_t>& r ) {
+          PCCPatch candidate = getPlacementCopy( patch );
+          for ( size_t u = r.begin(); u < r.end(); ++u ) {
+            for ( size_t v = 0; v < occupancySizeV; ++v ) {
+              candidate.getU0() = u;
+              candidate.getV0() = v;
+              for ( size_t orientationIdx = 0; orientationIdx < numOrientations; orientationIdx++ ) {
+                candidate.getPatchOrientation() = orientation_values[orientationIdx];
+                if ( !candidate.isPatchLocationAboveHorizon( horizon, top_horizon, bottom_horizon, right_horizon,
+                                                             left_horizon ) ) {
+                  continue;
+                }
+                if ( candidate.checkFitPatchCanvas( occupancyMap, occupancySizeU, occupancySizeV,
+                                                    params_.lowDelayEncoding_, safeguard ) ) {
+                  // now calculate the wasted space
+                  int wasted_space = candidate.calculate_wasted_space( horizon, top_horizon, bottom_horizon,
+                                                                       right_horizon, left_horizon );
+                  if ( wasted_space < columnWastedSpace[u] ) {
+                    columnWastedSpace[u] = wasted_space;
+                    columnV[u]           = v;
+                    columnOrientation[u] = candidate.getPatchOrientation();
+                  }
+                }
               }
             }
           }
+        } );
+      } );
+      for ( size_t u = 0; u < occupancySizeU; ++u ) {
+        if ( columnWastedSpace[u] < best_wasted_space ) {
+          best_wasted_space = columnWastedSpace[u];
+          best_u            = u;
+          best_v            = columnV[u];
+          best_orientation  = columnOrientation[u];
+          locationFound     = true;
         }
       }
       if ( !locationFound ) {
         occupancySizeV *= 2;
-        occupancyMap.resize( occupancySizeU * occupancySizeV );
+        occupancyMap.resize( occupancySizeU, occupancySizeV );
         if ( printDetailedInfo ) {
           std::cout << "Increasing frame size (" << occupancySizeU << "," << occupancySizeV << ")" << std::endl;
         }
@@ -3386,9 +3305,9 @@ void PCCEncoder::packTetris( PCCFrameContext& frame, size_t presetWidth, size_t
       for ( size_t u0 = 0; u0 < patch.getSizeU0(); ++u0 ) {
         int coord = patch.patchBlock2CanvasBlock( u0, v0, occupancySizeU, occupancySizeV );
         if ( params_.lowDelayEncoding_ ) {
-          occupancyMap[coord] = true;
+          occupancyMap.set( coord );
         } else {
-          occupancyMap[coord] = occupancyMap[coord] || occupancy[v0 * patch.getSizeU0() + u0];
+          if ( occupancy[v0 * patch.getSizeU0() + u0] ) { occupancyMap.set( coord ); }
         }
       }
     }
@@ -3418,7 +3337,7 @@ void PCCEncoder::packTetris( PCCFrameContext& frame, size_t presetWidth, size_t
 }
 
 void PCCEncoder::packEOMTexturePointsPatch( PCCFrameContext&   frame,
-                                            std::vector<bool>& occupancyMap,
+                                            PCCBitboardCanvas& occupancyMap,
                                             size_t             width,
                                             size_t&            height,
                                             size_t             occupancySizeU,
@@ -3444,7 +3363,7 @@ void PCCEncoder::packEOMTexturePointsPatch( PCCFrameContext&   frame,
         eomPatches[i].sizeU_, eomPatches[i].sizeV_, eomPointsPatchBlocks, eomPatches[i].eomCount_ );
     lastHeight += eomPatches[i].sizeV_ * params_.occupancyResolution_;
   }
-  occupancyMap.resize( occupancySizeU * occupancySizeV );
+  occupancyMap.resize( occupancySizeU, occupancySizeV );
   height = lastHeight;
 }
 
@@ -3493,7 +3412,7 @@ size_t PCCEncoder::packRawPointsPatchSimple( PCCFrameContext& tile,
 }
 
 size_t PCCEncoder::packRawPointsPatch( PCCFrameContext&   tile,
-                                       std::vector<bool>& occupancyMap,
+                                       PCCBitboardCanvas& occupancyMap,
                                        size_t             width,
                                        size_t&            height,
                                        size_t             occupancySizeU,
@@ -3558,7 +3477,7 @@ size_t PCCEncoder::packRawPointsPatch( PCCFrameContext&   tile,
       }
       if ( !locationFound ) {
         occupancySizeV *= 2;
-        occupancyMap.resize( occupancySizeU * occupancySizeV );
+        occupancyMap.resize( occupancySizeU, occupancySizeV );
       }
     }
     rawPointsPatch.u0_ = patch.getU0();
@@ -3568,10 +3487,9 @@ size_t PCCEncoder::packRawPointsPatch( PCCFrameContext&   tile,
       for ( size_t u0 = 0; u0 < rawPointsPatch.sizeU0_; ++u0 ) {
         const size_t u = rawPointsPatch.u0_ + u0;
         if ( params_.lowDelayEncoding_ ) {
-          occupancyMap[v * occupancySizeU + u] = true;
+          occupancyMap.set( u, v );
         } else {
-          occupancyMap[v * occupancySizeU + u] =
-              occupancyMap[v * occupancySizeU + u] || rawPointsPatchOccupancy[v0 * rawPointsPatch.sizeU0_ + u0];
+          if ( rawPointsPatchOccupancy[v0 * rawPointsPatch.sizeU0_ + u0] ) { occupancyMap.set( u, v ); }
         }
       }
       height = ( std::max )( height, ( patch.getV0() + patch.getSizeV0() ) * params_.occupancyResolution_ );
@@ -3747,6 +3665,7 @@ bool PCCEncoder::generateSegments( const PCCPointSet3&                 source,
     patches.reserve( 256 );
     PCCPatchSegmenter3 segmenter;
     segmenter.setNbThread( params_.nbThread_ );
+    segmenter.setKdTreeCache( kdTreeCache_ );
     segmenter.compute( source, frame.getFrameIndex(), segmenterParams, patches, frame.getSrcPointCloudByPatch(),
                        distanceSrcRec );
   } else if ( segmenterParams.additionalProjectionPlaneMode_ == 5 ) {
@@ -3773,7 +3692,7 @@ bool PCCEncoder::generateSegments( const PCCPointSet3&                 source,
 void PCCEncoder::dilateGroupGeometryVideo( PCCContext& context, PCCFrameContext& frame, size_t frameIdx ) {
   auto& videoGeometry         = context.getVideoGeometryMultiple()[0];
   auto& videoGeometryMultiple = context.getVideoGeometryMultiple();
-  auto  videoOccupancyMap     = context.getVideoOccupancyMap();
+  auto& videoOccupancyMap     = context.getVideoOccupancyMap();
   auto  width                 = frame.getWidth();
   auto  height                = frame.getHeight();
   auto& occupancyMap          = videoOccupancyMap.getFrame( frameIdx );
@@ -4577,12 +4496,12 @@ void PCCEncoder::placeAuxiliaryPointsTiles( PCCContext& context ) {
     for ( size_t tileIdx = 0; tileIdx < numTilesInSeg; tileIdx++ ) {
       for ( size_t frameIdx = firstFrame; frameIdx < lastFrame; frameIdx++ ) {
         auto&             tile = context[frameIdx].getTile( tileIdx );
-        std::vector<bool> auxPointsOccupancyMap;
+        PCCBitboardCanvas auxPointsOccupancyMap;
         size_t            auxPointsOccupancySizeU = maxWidth / params_.occupancyResolution_;
         size_t            auxPointsOccupancySizeV = 1;
         size_t            auxPointsTileHeight     = 0;
         size_t            auxPointsTileWidth      = maxWidth;
-        auxPointsOccupancyMap.resize( auxPointsOccupancySizeU * auxPointsOccupancySizeV, false );
+        auxPointsOccupancyMap.resize( auxPointsOccupancySizeU, auxPointsOccupancySizeV );
         if ( tile.getRawPointsPatches().size() == 0 )
           printf( "packRawPointsPatch[0/0]: none\n" );
         else
@@ -4884,14 +4803,22 @@ bool PCCEncoder::generateSegments( const PCCGroupOfFrames& sources, PCCContext&
   if ( params_.additionalProjectionPlaneMode_ == 0 || params_.additionalProjectionPlaneMode_ == 5 ) {
     params.weightNormal_ = calculateWeightNormal( params.geometryBitDepth3D_, sources[0] );
   }
+  // the frames are segmented concurrently, the distances are summed afterwards in frame order
+  std::vector<float>   distancesSrcRec( frames.size(), 0.F );
+  std::vector<uint8_t> segmented( frames.size(), 0 );
+  tbb::task_arena      limited( static_cast<int>( params_.nbThread_ ) );
+  limited.execute( [&] {
+    tbb::parallel_for( size_t( 0 ), frames.size(), [&]( const size_t i ) {
+      segmented[i] = static_cast<uint8_t>( generateSegments( sources[i], frames[i], params, i, distancesSrcRec[i] ) );
+    } );
+  } );
   float sumDistanceSrcRec = 0;
   for ( size_t i = 0; i < frames.size(); i++ ) {
-    float distanceSrcRec = 0;
-    if ( !generateSegments( sources[i], frames[i], params, i, distanceSrcRec ) ) {
+    if ( segmented[i] == 0 ) {
       res = false;
       break;
     }
-    sumDistanceSrcRec += distanceSrcRec;
+    sumDistanceSrcRec += distancesSrcRec[i];
   }
   if ( params_.pointLocalReconstruction_ || params_.singleMapPixelInterleaving_ ) {
     const float distanceSrcRec = sumDistanceSrcRec / static_cast<float>( frames.size() );
@@ -5936,7 +5863,7 @@ bool PCCEncoder::placeEomPatchInTile( PCCContext& context, std::vector<std::pair
       auto& atlasFrame = context[frameIdx].getTitleFrameContext();
       for ( size_t tileIdx = 0; tileIdx < numTilesInSeg; tileIdx++ ) {
         auto&             tile = context[frameIdx].getTile( tileIdx );
-        std::vector<bool> occupancyMap;
+        PCCBitboardCanvas occupancyMap;
         size_t occupancySizeU = context[frameIdx].getTile( tileIdx ).getWidth() / params_.occupancyResolution_;
         size_t occupancySizeV = 0;
         size_t tileWidth      = context[frameIdx].getTile( tileIdx ).getWidth();
@@ -6065,57 +5992,67 @@ void PCCEncoder::markRawPatchLocation( PCCFrameContext& frame, PCCImageOccupancy
 }
 
 bool PCCEncoder::generateGeometryVideo( const PCCGroupOfFrames& sources, PCCContext& context ) {
-  auto& videoGeometry         = context.getVideoGeometryMultiple()[0];
-  auto& videoGeometryMultiple = context.getVideoGeometryMultiple();
-  auto& videoOccupancyMap     = context.getVideoOccupancyMap();
-  auto& frameInfos            = context.getFrames();
-
-  for ( size_t i = 0; i < frameInfos.size(); i++ ) {
-    auto& frame = frameInfos[i].getTitleFrameContext();
-    if ( !params_.useRawPointsSeparateVideo_ && ( params_.losslessGeo_ || params_.lossyRawPointsPatch_ ) ) {
-      markRawPatchLocation( frame, videoOccupancyMap.getFrame( i ) );
-    }
-    if ( params_.multipleStreams_ ) {
-      const size_t geometryVideoSize = videoGeometryMultiple[0].getFrameCount();
-      videoGeometryMultiple[0].resize( geometryVideoSize + 1 );
-      videoGeometryMultiple[1].resize( geometryVideoSize + 1 );
-      auto& frame0 = videoGeometryMultiple[0].getFrame( geometryVideoSize );
-      generateIntraImage( frameInfos[i], 0, frame0 );
-      auto& frame1 = videoGeometryMultiple[1].getFrame( geometryVideoSize );
-      generateIntraImage( frameInfos[i], 1, frame1 );
-      dilate3DPadding( sources[i], frameInfos[i], frame, frame0, videoOccupancyMap.getFrame( i ) );
-      if ( params_.absoluteD1_ ) {
-        dilate3DPadding( sources[i], frameInfos[i], frame, frame1, videoOccupancyMap.getFrame( i ) );
-      }
-    } else {
-      const size_t geometryVideoSize = videoGeometry.getFrameCount();
-      const size_t mapCount          = params_.mapCountMinus1_ + 1;
-      videoGeometry.resize( geometryVideoSize + mapCount );
-      if ( params_.singleMapPixelInterleaving_ ) {
-        auto& frame1 = videoGeometry.getFrame( geometryVideoSize );
-        generateIntraImage( frameInfos[i], 0, frame1 );
-        dilate( frame, frame1 );
-        PCCImageGeometry frame2;
-        generateIntraImage( frameInfos[i], 1, frame2 );
-        dilate3DPadding( sources[i], frameInfos[i], frame, frame2, videoOccupancyMap.getFrame( i ) );
-        for ( size_t x = 0; x < frame1.getWidth(); x++ ) {
-          for ( size_t y = 0; y < frame1.getHeight(); y++ ) {
-            if ( ( x + y ) % 2 == 1 ) { frame1.setValue( 0, x, y, frame2.getValue( 0, x, y ) ); }
-          }
+  auto&        videoGeometry         = context.getVideoGeometryMultiple()[0];
+  auto&        videoGeometryMultiple = context.getVideoGeometryMultiple();
+  auto&        videoOccupancyMap     = context.getVideoOccupancyMap();
+  auto&        frameInfos            = context.getFrames();
+  const size_t frameCount            = frameInfos.size();
+  const size_t mapCount              = params_.mapCountMinus1_ + 1;
+
+  // The video is sized once up front: every frame then only touches its own images, occupancy map and
+  // frame context, which lets the frames be generated and padded concurrently.
+  const size_t geometryVideoSize =
+      params_.multipleStreams_ ? videoGeometryMultiple[0].getFrameCount() : videoGeometry.getFrameCount();
+  if ( params_.multipleStreams_ ) {
+    videoGeometryMultiple[0].resize( geometryVideoSize + frameCount );
+    videoGeometryMultiple[1].resize( geometryVideoSize + frameCount );
+  } else {
+    videoGeometry.resize( geometryVideoSize + frameCount * mapCount );
+  }
+  tbb::task_arena limited( static_cast<int>( params_.nbThread_ ) );
+  limited.execute( [&] {
+    tbb::parallel_for( size_t( 0 ), frameCount, [&]( const size_t i ) {
+      auto& frame = frameInfos[i].getTitleFrameContext();
+      if ( !params_.useRawPointsSeparateVideo_ && ( params_.losslessGeo_ || params_.lossyRawPointsPatch_ ) ) {
+        markRawPatchLocation( frame, videoOccupancyMap.getFrame( i ) );
+      }
+      if ( params_.multipleStreams_ ) {
+        auto& frame0 = videoGeometryMultiple[0].getFrame( geometryVideoSize + i );
+        generateIntraImage( frameInfos[i], 0, frame0 );
+        auto& frame1 = videoGeometryMultiple[1].getFrame( geometryVideoSize + i );
+        generateIntraImage( frameInfos[i], 1, frame1 );
+        dilate3DPadding( sources[i], frameInfos[i], frame, frame0, videoOccupancyMap.getFrame( i ) );
+        if ( params_.absoluteD1_ ) {
+          dilate3DPadding( sources[i], frameInfos[i], frame, frame1, videoOccupancyMap.getFrame( i ) );
         }
       } else {
-        for ( size_t f = 0; f < mapCount; ++f ) {
-          auto& geoImage = videoGeometry.getFrame( geometryVideoSize + f );
-          generateIntraImage( frameInfos[i], f, geoImage );
-          dilate3DPadding( sources[i], frameInfos[i], frame, geoImage, videoOccupancyMap.getFrame( i ) );
+        const size_t videoFrameIdx = geometryVideoSize + i * mapCount;
+        if ( params_.singleMapPixelInterleaving_ ) {
+          auto& frame1 = videoGeometry.getFrame( videoFrameIdx );
+          generateIntraImage( frameInfos[i], 0, frame1 );
+          dilate( frame, frame1 );
+          PCCImageGeometry frame2;
+          generateIntraImage( frameInfos[i], 1, frame2 );
+          dilate3DPadding( sources[i], frameInfos[i], frame, frame2, videoOccupancyMap.getFrame( i ) );
+          for ( size_t x = 0; x < frame1.getWidth(); x++ ) {
+            for ( size_t y = 0; y < frame1.getHeight(); y++ ) {
+              if ( ( x + y ) % 2 == 1 ) { frame1.setValue( 0, x, y, frame2.getValue( 0, x, y ) ); }
+            }
+          }
+        } else {
+          for ( size_t f = 0; f < mapCount; ++f ) {
+            auto& geoImage = videoGeometry.getFrame( videoFrameIdx + f );
+            generateIntraImage( frameInfos[i], f, geoImage );
+            dilate3DPadding( sources[i], frameInfos[i], frame, geoImage, videoOccupancyMap.getFrame( i ) );
+          }
         }
       }
-    }
-    // Group dilation in Geometry
-    if ( params_.groupDilation_ && params_.absoluteD1_ && params_.mapCountMinus1_ > 0 ) {
-      dilateGroupGeometryVideo( context, frame, i );
-    }
-  }  // frame
+      // Group dilation in Geometry
+      if ( params_.groupDilation_ && params_.absoluteD1_ && params_.mapCountMinus1_ > 0 ) {
+        dilateGroupGeometryVideo( context, frame, i );
+      }
+    } );  // frame
+  } );
   return true;
 }
 
@@ -6246,7 +6183,7 @@ size_t PCCEncoder::adjustDepth3DPadding( size_t            x,
                                          size_t            y,
                                          uint16_t          mean_val,
                                          PCCImageGeometry& image,
-                                         PCCKdTree&        kdtree,
+                                         const PCCKdTree&  kdtree,
                                          PCCFrameContext&  frame ) {
   auto&  blockToPatch = frame.getBlockToPatch();
   auto&  patches      = frame.getPatches();
@@ -6319,7 +6256,8 @@ void PCCEncoder::dilate3DPadding( const PCCPointSet3&     source,
   std::vector<uint32_t> occupancyMapTemp;
   auto&                 occupancyMapOriginal = frame.getOccupancyMap();
   occupancyMapTemp.resize( image.getWidth() * image.getHeight(), 0 );
-  PCCKdTree kdtree( source );
+  auto             kdtreePtr = getKdTree( kdTreeCache_, source );
+  const PCCKdTree& kdtree    = *kdtreePtr;
   // fill in positions that are added to the sequence, because of occupancyMap
   // video coding
 
@@ -6496,320 +6434,221 @@ void PCCEncoder::dilate3DPadding( const PCCPointSet3&     source,
 // interpolate using 5-point laplacian inpainting
 template <typename T>
 void PCCEncoder::dilateHarmonicBackgroundFill( PCCFrameContext& frame, PCCImage<T, 3>& image ) {
-  auto                               occupancyMapTemp = frame.getOccupancyMap();
-  int                                i                = 0;
-  std::vector<PCCImage<T, 3>>        mipVec;
-  std::vector<std::vector<uint32_t>> mipOccupancyMapVec;
-  int                                miplev = 0;
+  // the pyramid of each thread is reused from one frame to the next, its fill buffers only within the frame
+  static thread_local PCCMipPyramid<T> pyramid;
+  const auto&                          occupancyMap = frame.getOccupancyMap();
+  const size_t                         levelCount   = pyramid.resize( image.getWidth(), image.getHeight(), true );
 
   // create coarse image by dyadic sampling
-  while ( true ) {
-    mipVec.resize( mipVec.size() + 1 );
-    mipOccupancyMapVec.resize( mipOccupancyMapVec.size() + 1 );
-    if ( miplev > 0 ) {
-      CreateCoarseLayer( mipVec[miplev - 1], mipVec[miplev], mipOccupancyMapVec[miplev - 1],
-                         mipOccupancyMapVec[miplev] );
-    } else {
-      CreateCoarseLayer( image, mipVec[miplev], occupancyMapTemp, mipOccupancyMapVec[miplev] );
-    }
-
-    if ( mipVec[miplev].getWidth() <= 4 || mipVec[miplev].getHeight() <= 4 ) { break; }
-    ++miplev;
+  CreateCoarseLayer( image, pyramid.getImage( 0 ), occupancyMap, pyramid.getOccupancyMap( 0 ) );
+  for ( size_t i = 1; i < levelCount; i++ ) {
+    CreateCoarseLayer( pyramid.getImage( i - 1 ), pyramid.getImage( i ), pyramid.getOccupancyMap( i - 1 ),
+                       pyramid.getOccupancyMap( i ) );
   }
-  miplev++;
   // push phase: inpaint laplacian
-  regionFill( mipVec[miplev - 1], mipOccupancyMapVec[miplev - 1], mipVec[miplev - 1] );
-  for ( i = miplev - 1; i >= 0; --i ) {
-    if ( i > 0 ) {
-      regionFill( mipVec[i - 1], mipOccupancyMapVec[i - 1], mipVec[i] );
-    } else {
-      regionFill( image, occupancyMapTemp, mipVec[i] );
-    }
+  regionFill<T>( pyramid.getImage( levelCount - 1 ), pyramid.getOccupancyMap( levelCount - 1 ), nullptr, pyramid );
+  for ( size_t i = levelCount - 1; i > 0; i-- ) {
+    regionFill( pyramid.getImage( i - 1 ), pyramid.getOccupancyMap( i - 1 ), &pyramid.getImage( i ), pyramid );
   }
+  regionFill( image, occupancyMap, &pyramid.getImage( 0 ), pyramid );
+  pyramid.releaseFillBuffers();
 }
 
 template <typename T>
-void PCCEncoder::CreateCoarseLayer( PCCImage<T, 3>&        image,
-                                    PCCImage<T, 3>&        mip,
-                                    std::vector<uint32_t>& occupancyMap,
-                                    std::vector<uint32_t>& mipOccupancyMap ) {
-  int dyadicWidth = 1;
-  while ( dyadicWidth < image.getWidth() ) { dyadicWidth *= 2; }
-  int dyadicHeight = 1;
-  while ( dyadicHeight < image.getHeight() ) { dyadicHeight *= 2; }
-  // allocate the mipmap with half the resolution
-  mip.resize( ( dyadicWidth / 2 ), ( dyadicHeight / 2 ), PCCCOLORFORMAT::YUV444 );
-  mipOccupancyMap.resize( ( dyadicWidth / 2 ) * ( dyadicHeight / 2 ), 0 );
-  int    stride    = image.getWidth();
-  int    newStride = ( dyadicWidth / 2 );
-  int    x;
-  int    y;
-  int    i;
-  int    j;
-  double num[3];
-  double den;
-  for ( y = 0; y < mip.getHeight(); y++ ) {
-    for ( x = 0; x < mip.getWidth(); x++ ) {
-      num[0] = 0;
-      num[1] = 0;
-      num[2] = 0;
-      den    = 0;
-      for ( i = 0; i < 2; i++ ) {
-        for ( j = 0; j < 2; j++ ) {
-          int row = ( 2 * y + i ) < 0 ? 0 : ( 2 * y + i ) >= image.getHeight() ? image.getHeight() - 1 : ( 2 * y + i );
-          int column = ( 2 * x + j ) < 0 ? 0 : ( 2 * x + j ) >= image.getWidth() ? image.getWidth() - 1 : ( 2 * x + j );
-          if ( occupancyMap[column + stride * row] == 1 ) {
-            den++;
-            for ( int cc = 0; cc < 3; cc++ ) { num[cc] += image.getValue( cc, column, row ); }
-          }
-        }
-      }
-      if ( den > 0 ) {
-        mipOccupancyMap[x + newStride * y] = 1;
-        for ( int cc = 0; cc < 3; cc++ ) { mip.setValue( cc, x, y, std::round( num[cc] / den ) ); }
+void PCCEncoder::CreateCoarseLayer( const PCCImage<T, 3>&        image,
+                                    PCCImage<T, 3>&              mip,
+                                    const std::vector<uint32_t>& occupancyMap,
+                                    std::vector<uint32_t>&       mipOccupancyMap ) {
+  // the dyadic mip may extend past the image, whose border samples are then used again
+  const size_t width     = image.getWidth();
+  const size_t height    = image.getHeight();
+  const size_t mipWidth  = mip.getWidth();
+  const size_t mipHeight = mip.getHeight();
+  const T*     src[3]    = {image.getChannel( 0 ).data(), image.getChannel( 1 ).data(), image.getChannel( 2 ).data()};
+  T*           dst[3]    = {mip.getChannel( 0 ).data(), mip.getChannel( 1 ).data(), mip.getChannel( 2 ).data()};
+  for ( size_t y = 0; y < mipHeight; y++ ) {
+    const size_t row0 = ( std::min )( 2 * y, height - 1 ) * width;
+    const size_t row1 = ( std::min )( 2 * y + 1, height - 1 ) * width;
+    for ( size_t x = 0; x < mipWidth; x++ ) {
+      const size_t column0   = ( std::min )( 2 * x, width - 1 );
+      const size_t column1   = ( std::min )( 2 * x + 1, width - 1 );
+      const size_t blocks[4] = {row0 + column0, row0 + column1, row1 + column0, row1 + column1};
+      const size_t location  = y * mipWidth + x;
+      int          num[3]    = {0, 0, 0};
+      int          den       = 0;
+      for ( auto block : blocks ) {
+        if ( occupancyMap[block] == 1 ) {
+          den++;
+          for ( size_t cc = 0; cc < 3; cc++ ) { num[cc] += src[cc][block]; }
+        }
+      }
+      mipOccupancyMap[location] = den > 0 ? 1 : 0;
+      for ( size_t cc = 0; cc < 3; cc++ ) {
+        dst[cc][location] = den > 0 ? T( std::round( double( num[cc] ) / den ) ) : T( 0 );
       }
     }
   }
 }
 
 template <typename T>
-void PCCEncoder::regionFill( PCCImage<T, 3>& image, std::vector<uint32_t>& occupancyMap, PCCImage<T, 3>& imageLowRes ) {
-  int                   stride        = image.getWidth();
-  int                   numElem       = 0;
-  int                   numSparseElem = 0;
-  std::vector<uint32_t> indexing;
-  indexing.resize( occupancyMap.size() );
-  for ( int i = 0; i < occupancyMap.size(); i++ ) {
-    if ( occupancyMap[i] == 0 ) {
-      indexing[i] = numElem;
-      numElem++;
-    }
-  }
-  // create a sparse matrix with the coefficients
-  std::vector<uint32_t> iSparse;
-  std::vector<uint32_t> jSparse;
-  std::vector<double>   valSparse;
-  iSparse.resize( numElem * 5 );
-  jSparse.resize( numElem * 5 );
-  valSparse.resize( numElem * 5 );
-  // create an initial solution using the low-resolution
-  std::vector<double> b[3];
-  b[0].resize( numElem );
-  b[1].resize( numElem );
-  b[2].resize( numElem );
-  // fill in the system
-  int idx       = 0;
-  int idxSparse = 0;
-  for ( int row = 0; row < image.getHeight(); row++ ) {
-    for ( int column = 0; column < image.getWidth(); column++ ) {
-      if ( occupancyMap[column + stride * row] == 0 ) {
-        int count = 0;
-        b[0][idx] = 0;
-        b[1][idx] = 0;
-        b[2][idx] = 0;
-        for ( int i = -1; i < 2; i++ ) {
-          for ( int j = -1; j < 2; j++ ) {
-            if ( ( i == j ) || ( i == -j ) ) { continue; }
-            if ( ( column + j < 0 ) || ( column + j > image.getWidth() - 1 ) ) { continue; }
-            if ( ( row + i < 0 ) || ( row + i > image.getHeight() - 1 ) ) { continue; }
-            count++;
-            if ( occupancyMap[column + j + stride * ( row + i )] == 1 ) {
-              b[0][idx] += image.getValue( 0, column + j, row + i );
-              b[1][idx] += image.getValue( 1, column + j, row + i );
-              b[2][idx] += image.getValue( 2, column + j, row + i );
-            } else {
-              iSparse[idxSparse]   = idx;
-              jSparse[idxSparse]   = indexing[column + j + stride * ( row + i )];
-              valSparse[idxSparse] = -1;
-              idxSparse++;
-            }
-          }
+void PCCEncoder::regionFill( PCCImage<T, 3>&              image,
+                             const std::vector<uint32_t>& occupancyMap,
+                             const PCCImage<T, 3>*        imageLowRes,
+                             PCCMipPyramid<T>&            pyramid ) {
+  const size_t width       = image.getWidth();
+  const size_t height      = image.getHeight();
+  const size_t pixelCount  = width * height;
+  auto&        indexing    = pyramid.getUnknownIndices();
+  auto&        neighbors   = pyramid.getUnknownNeighbors();
+  auto&        counts      = pyramid.getUnknownCounts();
+  auto&        b           = pyramid.getKnownSums();
+  auto&        x           = pyramid.getUnknownValues();
+  T*           channels[3] = {image.getChannel( 0 ).data(), image.getChannel( 1 ).data(), image.getChannel( 2 ).data()};
+
+  // the empty pixels are the unknowns of the system
+  size_t numElem = 0;
+  indexing.resize( pixelCount );
+  for ( size_t i = 0; i < pixelCount; i++ ) {
+    indexing[i] = occupancyMap[i] == 0 ? static_cast<uint32_t>( numElem++ ) : 0;
+  }
+  if ( numElem == 0 ) { return; }
+
+  // each unknown is the mean of its 4 neighbours: the occupied ones go to b and the empty ones index the
+  // solution x, whose last entry is a zero used for the neighbours that are occupied or outside of the image
+  const int64_t offsets[4][2] = {{0, -1}, {-1, 0}, {1, 0}, {0, 1}};
+  neighbors.resize( 4 * numElem );
+  counts.resize( numElem );
+  b.resize( 3 * numElem );
+  x.resize( 3 * ( numElem + 1 ) );
+  size_t idx = 0;
+  for ( size_t row = 0; row < height; row++ ) {
+    for ( size_t column = 0; column < width; column++ ) {
+      if ( occupancyMap[column + width * row] != 0 ) { continue; }
+      size_t count = 0;
+      for ( size_t cc = 0; cc < 3; cc++ ) { b[3 * idx + cc] = 0; }
+      for ( size_t k = 0; k < 4; k++ ) {
+        const int64_t column1  = int64_t( column ) + offsets[k][0];
+        const int64_t row1     = int64_t( row ) + offsets[k][1];
+        neighbors[4 * idx + k] = static_cast<uint32_t>( numElem );
+        if ( column1 < 0 || column1 >= int64_t( width ) || row1 < 0 || row1 >= int64_t( height ) ) { continue; }
+        const size_t location = column1 + width * row1;
+        count++;
+        if ( occupancyMap[location] == 1 ) {
+          for ( size_t cc = 0; cc < 3; cc++ ) { b[3 * idx + cc] += channels[cc][location]; }
+        } else {
+          neighbors[4 * idx + k] = indexing[location];
         }
-        // now insert the weight of the center pixel
-        iSparse[idxSparse]   = idx;
-        jSparse[idxSparse]   = idx;
-        valSparse[idxSparse] = count;
-        idx++;
-        idxSparse++;
       }
+      counts[idx] = count;
+      idx++;
     }
   }
-  numSparseElem = idxSparse;
-  // now solve the linear system Ax=b using Gauss-Siedel relaxation, with
-  // initial guess coming from the lower
-  // resolution
-  std::vector<double> x[3];
-  x[0].resize( numElem );
-  x[1].resize( numElem );
-  x[2].resize( numElem );
-  if ( imageLowRes.getWidth() == image.getWidth() ) {
+  // create an initial solution using the low-resolution image
+  if ( imageLowRes == nullptr ) {
     // low resolution image not provided, let's use for the initialization the
     // mean value of the active pixels
-    double mean[3] = {0.0, 0.0, 0.0};
-    idx            = 0;
-    for ( int row = 0; row < image.getHeight(); row++ ) {
-      for ( int column = 0; column < image.getWidth(); column++ ) {
-        if ( occupancyMap[column + stride * row] == 1 ) {
-          mean[0] += double( image.getValue( 0, column, row ) );
-          mean[1] += double( image.getValue( 1, column, row ) );
-          mean[2] += double( image.getValue( 2, column, row ) );
-          idx++;
-        }
+    double mean[3]       = {0.0, 0.0, 0.0};
+    size_t occupiedCount = 0;
+    for ( size_t i = 0; i < pixelCount; i++ ) {
+      if ( occupancyMap[i] == 1 ) {
+        for ( size_t cc = 0; cc < 3; cc++ ) { mean[cc] += double( channels[cc][i] ); }
+        occupiedCount++;
       }
     }
-    mean[0] /= idx;
-    mean[1] /= idx;
-    mean[2] /= idx;
-    idx = 0;
-    for ( int row = 0; row < image.getHeight(); row++ ) {
-      for ( int column = 0; column < image.getWidth(); column++ ) {
-        if ( occupancyMap[column + stride * row] == 0 ) {
-          x[0][idx] = mean[0];
-          x[1][idx] = mean[1];
-          x[2][idx] = mean[2];
-          idx++;
-        }
-      }
+    for ( size_t cc = 0; cc < 3; cc++ ) { mean[cc] /= occupiedCount; }
+    for ( size_t i = 0; i < numElem; i++ ) {
+      for ( size_t cc = 0; cc < 3; cc++ ) { x[3 * i + cc] = mean[cc]; }
     }
   } else {
     idx = 0;
-    for ( int row = 0; row < image.getHeight(); row++ ) {
-      for ( int column = 0; column < image.getWidth(); column++ ) {
-        if ( occupancyMap[column + stride * row] == 0 ) {
-          x[0][idx] = imageLowRes.getValue( 0, column / 2, row / 2 );
-          x[1][idx] = imageLowRes.getValue( 1, column / 2, row / 2 );
-          x[2][idx] = imageLowRes.getValue( 2, column / 2, row / 2 );
+    for ( size_t row = 0; row < height; row++ ) {
+      for ( size_t column = 0; column < width; column++ ) {
+        if ( occupancyMap[column + width * row] == 0 ) {
+          for ( size_t cc = 0; cc < 3; cc++ ) { x[3 * idx + cc] = imageLowRes->getValue( cc, column / 2, row / 2 ); }
           idx++;
         }
       }
     }
   }
-  int    maxIteration = 1024;
-  double maxError     = 0.00001;
-  for ( int cc = 0; cc < 3; cc++ ) {
-    int it = 0;
-    for ( ; it < maxIteration; it++ ) {
-      int    idxSparse = 0;
-      double error     = 0;
-      double val       = 0;
-      for ( int centerIdx = 0; centerIdx < numElem; centerIdx++ ) {
-        // add the b result
-        val = b[cc][centerIdx];
-        while ( ( idxSparse < numSparseElem ) && ( iSparse[idxSparse] == centerIdx ) ) {
-          if ( valSparse[idxSparse] < 0 ) {
-            val += x[cc][jSparse[idxSparse]];
-            idxSparse++;
-          } else {
-            // final value
-            val /= valSparse[idxSparse];
-            // accumulate the error
-            error += ( val - x[cc][centerIdx] ) * ( val - x[cc][centerIdx] );
-            // update the value
-            x[cc][centerIdx] = val;
-            idxSparse++;
-          }
-        }
+  for ( size_t cc = 0; cc < 3; cc++ ) { x[3 * numElem + cc] = 0; }
+
+  // now solve the linear system Ax=b using Gauss-Siedel relaxation. The channels are relaxed in the same sweeps,
+  // each one until it has converged.
+  const int    maxIteration = 1024;
+  const double maxError     = 0.00001;
+  bool         converged[3] = {false, false, false};
+  for ( int it = 0; it < maxIteration && !( converged[0] && converged[1] && converged[2] ); it++ ) {
+    double error[3] = {0.0, 0.0, 0.0};
+    for ( size_t i = 0; i < numElem; i++ ) {
+      const uint32_t* neighbor = neighbors.data() + 4 * i;
+      for ( size_t cc = 0; cc < 3; cc++ ) {
+        if ( converged[cc] ) { continue; }
+        double val = b[3 * i + cc] + x[3 * neighbor[0] + cc] + x[3 * neighbor[1] + cc] + x[3 * neighbor[2] + cc] +
+                     x[3 * neighbor[3] + cc];
+        val /= counts[i];
+        error[cc] += ( val - x[3 * i + cc] ) * ( val - x[3 * i + cc] );
+        x[3 * i + cc] = val;
       }
-      error = error / numElem;
-      if ( error < maxError ) { break; }
+    }
+    for ( size_t cc = 0; cc < 3; cc++ ) {
+      if ( !converged[cc] ) { converged[cc] = error[cc] / numElem < maxError; }
     }
   }
   // put the value back in the image
   idx = 0;
-  for ( int row = 0; row < image.getHeight(); row++ ) {
-    for ( int column = 0; column < image.getWidth(); column++ ) {
-      if ( occupancyMap[column + stride * row] == 0 ) {
-        image.setValue( 0, column, row, x[0][idx] );
-        image.setValue( 1, column, row, x[1][idx] );
-        image.setValue( 2, column, row, x[2][idx] );
-        idx++;
-      }
+  for ( size_t i = 0; i < pixelCount; i++ ) {
+    if ( occupancyMap[i] == 0 ) {
+      for ( size_t cc = 0; cc < 3; cc++ ) { channels[cc][i] = T( x[3 * idx + cc] ); }
+      idx++;
     }
   }
 }
 
 /* pull push filling algorithm */
-template <typename T>
-int PCCEncoder::mean4w( T             p1,
-                        unsigned char w1,
-                        T             p2,
-                        unsigned char w2,
-                        T             p3,
-                        unsigned char w3,
-                        T             p4,
-                        unsigned char w4 ) {
-  int result = ( p1 * int( w1 ) + p2 * int( w2 ) + p3 * int( w3 ) + p4 * int( w4 ) ) /
-               ( int( w1 ) + int( w2 ) + int( w3 ) + int( w4 ) );
-  return result;
-}
-
 // Generates a weighted mipmap
 template <typename T>
 void PCCEncoder::pushPullMip( const PCCImage<T, 3>&        image,
                               PCCImage<T, 3>&              mip,
                               const std::vector<uint32_t>& occupancyMap,
                               std::vector<uint32_t>&       mipOccupancyMap ) {
-  unsigned char w1;
-  unsigned char w2;
-  unsigned char w3;
-  unsigned char w4;
-  unsigned char val1;
-  unsigned char val2;
-  unsigned char val3;
-  unsigned char val4;
-  const size_t  width     = image.getWidth();
-  const size_t  height    = image.getHeight();
-  const size_t  newWidth  = ( ( width + 1 ) >> 1 );
-  const size_t  newHeight = ( ( height + 1 ) >> 1 );
-  // allocate the mipmap with half the resolution
-  mip.resize( newWidth, newHeight, PCCCOLORFORMAT::YUV444 );
-  mipOccupancyMap.resize( newWidth * newHeight, 0 );
+  const size_t width     = image.getWidth();
+  const size_t height    = image.getHeight();
+  const size_t newWidth  = mip.getWidth();
+  const size_t newHeight = mip.getHeight();
+  assert( ( ( width + 1 ) >> 1 ) == newWidth );
+  assert( ( ( height + 1 ) >> 1 ) == newHeight );
+  // a mip sample is the mean of the occupied samples of its 2x2 block, read on 8 bits
   for ( size_t y = 0; y < newHeight; ++y ) {
-    const size_t yUp = y << 1;
+    const size_t    yUp     = y << 1;
+    const bool      hasDown = yUp + 1 < height;
+    const uint32_t* occ0    = occupancyMap.data() + yUp * width;
+    const uint32_t* occ1    = occ0 + width;
+    const T*        src0[3];
+    const T*        src1[3];
+    T*              dst[3];
+    for ( size_t cc = 0; cc < 3; cc++ ) {
+      src0[cc] = image.getChannel( cc ).data() + yUp * width;
+      src1[cc] = src0[cc] + width;
+      dst[cc]  = mip.getChannel( cc ).data() + y * newWidth;
+    }
+    uint32_t* mipOcc = mipOccupancyMap.data() + y * newWidth;
     for ( size_t x = 0; x < newWidth; ++x ) {
-      const size_t xUp = x << 1;
-      if ( occupancyMap[xUp + width * yUp] == 0 ) {
-        w1 = 0;
-      } else {
-        w1 = 255;
-      }
-      if ( ( xUp + 1 >= width ) || ( occupancyMap[xUp + 1 + width * yUp] == 0 ) ) {
-        w2 = 0;
-      } else {
-        w2 = 255;
-      }
-      if ( ( yUp + 1 >= height ) || ( occupancyMap[xUp + width * ( yUp + 1 )] == 0 ) ) {
-        w3 = 0;
-      } else {
-        w3 = 255;
-      }
-      if ( ( xUp + 1 >= width ) || ( yUp + 1 >= height ) || ( occupancyMap[xUp + 1 + width * ( yUp + 1 )] == 0 ) ) {
-        w4 = 0;
-      } else {
-        w4 = 255;
-      }
-      if ( w1 + w2 + w3 + w4 > 0 ) {
-        for ( int cc = 0; cc < 3; cc++ ) {
-          val1 = image.getValue( cc, xUp, yUp );
-          if ( xUp + 1 >= width ) {
-            val2 = 0;
-          } else {
-            val2 = image.getValue( cc, xUp + 1, yUp );
-          }
-          if ( yUp + 1 >= height ) {
-            val3 = 0;
-          } else {
-            val3 = image.getValue( cc, xUp, yUp + 1 );
-          }
-          if ( ( xUp + 1 >= width ) || ( yUp + 1 >= height ) ) {
-            val4 = 0;
-          } else {
-            val4 = image.getValue( cc, xUp + 1, yUp + 1 );
-          }
-          T newVal = mean4w( val1, w1, val2, w2, val3, w3, val4, w4 );
-          mip.setValue( cc, x, y, newVal );
+      const size_t xUp      = x << 1;
+      const bool   hasRight = xUp + 1 < width;
+      const bool   w1       = occ0[xUp] != 0;
+      const bool   w2       = hasRight && occ0[xUp + 1] != 0;
+      const bool   w3       = hasDown && occ1[xUp] != 0;
+      const bool   w4       = hasRight && hasDown && occ1[xUp + 1] != 0;
+      const int    count    = int( w1 ) + int( w2 ) + int( w3 ) + int( w4 );
+      mipOcc[x]             = count > 0 ? 1 : 0;
+      for ( size_t cc = 0; cc < 3; cc++ ) {
+        if ( count == 0 ) {
+          dst[cc][x] = 0;
+          continue;
         }
-        mipOccupancyMap[x + newWidth * y] = 1;
+        const int sum = ( w1 ? uint8_t( src0[cc][xUp] ) : 0 ) + ( w2 ? uint8_t( src0[cc][xUp + 1] ) : 0 ) +
+                        ( w3 ? uint8_t( src1[cc][xUp] ) : 0 ) + ( w4 ? uint8_t( src1[cc][xUp + 1] ) : 0 );
+        dst[cc][x] = T( sum / count );
       }
     }
   }
@@ -6820,158 +6659,133 @@ template <typename T>
 void PCCEncoder::pushPullFill( PCCImage<T, 3>&              image,
                                const PCCImage<T, 3>&        mip,
                                const std::vector<uint32_t>& occupancyMap,
-                               int                          numIters ) {
+                               int                          numIters,
+                               PCCImage<T, 3>&              tmpImage ) {
   const size_t width    = mip.getWidth();
   const size_t height   = mip.getHeight();
   const size_t widthUp  = image.getWidth();
   const size_t heightUp = image.getHeight();
   assert( ( ( widthUp + 1 ) >> 1 ) == width );
   assert( ( ( heightUp + 1 ) >> 1 ) == height );
-  int           x;
-  int           y;
-  int           xUp;
-  int           yUp;
-  unsigned char w1;
-  unsigned char w2;
-  unsigned char w3;
-  unsigned char w4;
-  for ( yUp = 0; yUp < heightUp; ++yUp ) {
-    y = yUp >> 1;
-    for ( xUp = 0; xUp < widthUp; ++xUp ) {
-      x = xUp >> 1;
-      if ( occupancyMap[xUp + widthUp * yUp] == 0 ) {
-        if ( ( xUp % 2 == 0 ) && ( yUp % 2 == 0 ) ) {
-          w1 = 144;
-          w2 = ( x > 0 ? static_cast<unsigned char>( 48 ) : 0 );
-          w3 = ( y > 0 ? static_cast<unsigned char>( 48 ) : 0 );
-          w4 = ( ( ( x > 0 ) && ( y > 0 ) ) ? static_cast<unsigned char>( 16 ) : 0 );
-          for ( int cc = 0; cc < 3; cc++ ) {
-            T val       = mip.getValue( cc, x, y );
-            T valLeft   = ( x > 0 ? mip.getValue( cc, x - 1, y ) : 0 );
-            T valUp     = ( y > 0 ? mip.getValue( cc, x, y - 1 ) : 0 );
-            T valUpLeft = ( ( x > 0 && y > 0 ) ? mip.getValue( cc, x - 1, y - 1 ) : 0 );
-            T newVal    = mean4w( val, w1, valLeft, w2, valUp, w3, valUpLeft, w4 );
-            image.setValue( cc, xUp, yUp, newVal );
-          }
-        } else if ( ( xUp % 2 == 1 ) && ( yUp % 2 == 0 ) ) {
-          w1 = 144;
-          w2 = ( x < width - 1 ? static_cast<unsigned char>( 48 ) : 0 );
-          w3 = ( y > 0 ? static_cast<unsigned char>( 48 ) : 0 );
-          w4 = ( ( ( x < width - 1 ) && ( y > 0 ) ) ? static_cast<unsigned char>( 16 ) : 0 );
-          for ( int cc = 0; cc < 3; cc++ ) {
-            T val        = mip.getValue( cc, x, y );
-            T valRight   = ( x < width - 1 ? mip.getValue( cc, x + 1, y ) : 0 );
-            T valUp      = ( y > 0 ? mip.getValue( cc, x, y - 1 ) : 0 );
-            T valUpRight = ( ( ( x < width - 1 ) && ( y > 0 ) ) ? mip.getValue( cc, x + 1, y - 1 ) : 0 );
-            T newVal     = mean4w( val, w1, valRight, w2, valUp, w3, valUpRight, w4 );
-            image.setValue( cc, xUp, yUp, newVal );
-          }
-        } else if ( ( xUp % 2 == 0 ) && ( yUp % 2 == 1 ) ) {
-          w1 = 144;
-          w2 = ( x > 0 ? static_cast<unsigned char>( 48 ) : 0 );
-          w3 = ( y < height - 1 ? static_cast<unsigned char>( 48 ) : 0 );
-          w4 = ( ( ( x > 0 ) && ( y < height - 1 ) ) ? static_cast<unsigned char>( 16 ) : 0 );
-          for ( int cc = 0; cc < 3; cc++ ) {
-            T val         = mip.getValue( cc, x, y );
-            T valLeft     = ( x > 0 ? mip.getValue( cc, x - 1, y ) : 0 );
-            T valDown     = ( ( y < height - 1 ) ? mip.getValue( cc, x, y + 1 ) : 0 );
-            T valDownLeft = ( ( x > 0 && ( y < height - 1 ) ) ? mip.getValue( cc, x - 1, y + 1 ) : 0 );
-            T newVal      = mean4w( val, w1, valLeft, w2, valDown, w3, valDownLeft, w4 );
-            image.setValue( cc, xUp, yUp, newVal );
-          }
-        } else {
-          w1 = 144;
-          w2 = ( x < width - 1 ? static_cast<unsigned char>( 48 ) : 0 );
-          w3 = ( y < height - 1 ? static_cast<unsigned char>( 48 ) : 0 );
-          w4 = ( ( ( x < width - 1 ) && ( y < height - 1 ) ) ? static_cast<unsigned char>( 16 ) : 0 );
-          for ( int cc = 0; cc < 3; cc++ ) {
-            T val          = mip.getValue( cc, x, y );
-            T valRight     = ( x < width - 1 ? mip.getValue( cc, x + 1, y ) : 0 );
-            T valDown      = ( ( y < height - 1 ) ? mip.getValue( cc, x, y + 1 ) : 0 );
-            T valDownRight = ( ( ( x < width - 1 ) && ( y < height - 1 ) ) ? mip.getValue( cc, x + 1, y + 1 ) : 0 );
-            T newVal       = mean4w( val, w1, valRight, w2, valDown, w3, valDownRight, w4 );
-            image.setValue( cc, xUp, yUp, newVal );
-          }
-        }
+  // an empty sample is interpolated from the 4 nearest mip samples with the weights 9/16, 3/16, 3/16 and 1/16,
+  // the mip samples outside of the mip being left out
+  for ( size_t yUp = 0; yUp < heightUp; ++yUp ) {
+    const size_t    y     = yUp >> 1;
+    const bool      hasY1 = ( yUp & 1 ) != 0 ? y + 1 < height : y > 0;
+    const size_t    y1    = hasY1 ? ( ( yUp & 1 ) != 0 ? y + 1 : y - 1 ) : y;
+    const int       wY1   = hasY1 ? 48 : 0;
+    const uint32_t* occ   = occupancyMap.data() + yUp * widthUp;
+    for ( size_t cc = 0; cc < 3; cc++ ) {
+      const T* mip0 = mip.getChannel( cc ).data() + y * width;
+      const T* mip1 = mip.getChannel( cc ).data() + y1 * width;
+      T*       dst  = image.getChannel( cc ).data() + yUp * widthUp;
+      for ( size_t xUp = 0; xUp < widthUp; ++xUp ) {
+        if ( occ[xUp] != 0 ) { continue; }
+        const size_t x     = xUp >> 1;
+        const bool   hasX1 = ( xUp & 1 ) != 0 ? x + 1 < width : x > 0;
+        const size_t x1    = hasX1 ? ( ( xUp & 1 ) != 0 ? x + 1 : x - 1 ) : x;
+        const int    wX1   = hasX1 ? 48 : 0;
+        const int    wX1Y1 = hasX1 && hasY1 ? 16 : 0;
+        const int    num   = 144 * mip0[x] + wX1 * mip0[x1] + wY1 * mip1[x] + wX1Y1 * mip1[x1];
+        const int    den   = 144 + wX1 + wY1 + wX1Y1;
+        dst[xUp]           = T( den == 256 ? num >> 8 : num / den );
+      }
+    }
+  }
+  // smoothing: an empty sample is set to the mean of its 8 neighbours, clamped to the image. The iterations are
+  // pipelined row by row, each one keeping its last 3 rows in tmpImage, so that the image is read and written
+  // once whatever the number of iterations.
+  if ( numIters <= 0 ) { return; }
+  const size_t iterCount = numIters;
+  tmpImage.resize( widthUp, 3 * iterCount, PCCCOLORFORMAT::YUV444 );
+  auto ringRow = [&]( const size_t cc, const size_t iter, const size_t y ) {
+    return tmpImage.getChannel( cc ).data() + ( 3 * iter + y % 3 ) * widthUp;
+  };
+  auto smoothRow = [widthUp]( const T* row0, const T* row1, const T* row2, const uint32_t* occ, T* out ) {
+    const size_t borders[2]  = {0, widthUp - 1};
+    const size_t borderCount = widthUp > 1 ? 2 : 1;
+    for ( size_t i = 0; i < borderCount; i++ ) {
+      const size_t x   = borders[i];
+      const size_t x1  = x > 0 ? x - 1 : x;
+      const size_t x2  = x + 1 < widthUp ? x + 1 : x;
+      const int    val = row0[x1] + row0[x2] + row2[x1] + row2[x2] + row1[x1] + row1[x2] + row0[x] + row2[x];
+      out[x]           = occ[x] == 0 ? T( ( val + 4 ) >> 3 ) : row1[x];
+    }
+    // the occupied samples are kept with a mask rather than a branch, so that the loop vectorizes
+    for ( size_t x = 1; x + 1 < widthUp; x++ ) {
+      const int val =
+          row0[x - 1] + row0[x + 1] + row2[x - 1] + row2[x + 1] + row1[x - 1] + row1[x + 1] + row0[x] + row2[x];
+      const int mask = -int( occ[x] == 0 );
+      out[x]         = T( ( ( ( val + 4 ) >> 3 ) & mask ) | ( row1[x] & ~mask ) );
+    }
+  };
+  for ( size_t yIn = 0; yIn < heightUp + iterCount; yIn++ ) {
+    if ( yIn < heightUp ) {
+      for ( size_t cc = 0; cc < 3; cc++ ) {
+        const T* row = image.getChannel( cc ).data() + yIn * widthUp;
+        std::copy( row, row + widthUp, ringRow( cc, 0, yIn ) );
       }
     }
-  }
-  auto tmpImage( image );
-  for ( size_t n = 0; n < numIters; n++ ) {
-    for ( int y = 0; y < heightUp; y++ ) {
-      for ( int x = 0; x < widthUp; x++ ) {
-        if ( occupancyMap[x + widthUp * y] == 0 ) {
-          int x1 = ( x > 0 ) ? x - 1 : x;
-          int y1 = ( y > 0 ) ? y - 1 : y;
-          int x2 = ( x < widthUp - 1 ) ? x + 1 : x;
-          int y2 = ( y < heightUp - 1 ) ? y + 1 : y;
-          for ( size_t c = 0; c < 3; c++ ) {
-            int val = image.getValue( c, x1, y1 ) + image.getValue( c, x2, y1 ) + image.getValue( c, x1, y2 ) +
-                      image.getValue( c, x2, y2 ) + image.getValue( c, x1, y ) + image.getValue( c, x2, y ) +
-                      image.getValue( c, x, y1 ) + image.getValue( c, x, y2 );
-            tmpImage.setValue( c, x, y, ( val + 4 ) >> 3 );
-          }
-        }
+    // iteration n computes the row n rows above the last one read
+    for ( size_t n = 1; n <= ( std::min )( iterCount, yIn ); n++ ) {
+      const size_t y = yIn - n;
+      if ( y >= heightUp ) { continue; }
+      const size_t    y0  = y > 0 ? y - 1 : y;
+      const size_t    y2  = y + 1 < heightUp ? y + 1 : y;
+      const uint32_t* occ = occupancyMap.data() + y * widthUp;
+      for ( size_t cc = 0; cc < 3; cc++ ) {
+        T* out = n == iterCount ? image.getChannel( cc ).data() + y * widthUp : ringRow( cc, n, y );
+        smoothRow( ringRow( cc, n - 1, y0 ), ringRow( cc, n - 1, y ), ringRow( cc, n - 1, y2 ), occ, out );
       }
     }
-    swap( image, tmpImage );
   }
 }
 
 template <typename T>
 void PCCEncoder::dilateSmoothedPushPull( PCCFrameContext& frame, PCCImage<T, 3>& image, int mapIdx ) {
-  auto                               occupancyMapTemp = frame.getOccupancyMap();
-  int                                i                = 0;
-  std::vector<PCCImage<T, 3>>        mipVec;
-  std::vector<std::vector<uint32_t>> mipOccupancyMapVec;
-  int                                div    = 2;
-  int                                miplev = 0;
+  // the pyramid of each thread is reused from one frame to the next
+  static thread_local PCCMipPyramid<T> pyramid;
+  const auto&                          occupancyMap = frame.getOccupancyMap();
+  const size_t                         levelCount   = pyramid.resize( image.getWidth(), image.getHeight(), false );
 
   // pull phase create the mipmap
-  while ( true ) {
-    mipVec.resize( mipVec.size() + 1 );
-    mipOccupancyMapVec.resize( mipOccupancyMapVec.size() + 1 );
-    div *= 2;
-    if ( miplev > 0 ) {
-      pushPullMip( mipVec[miplev - 1], mipVec[miplev], mipOccupancyMapVec[miplev - 1], mipOccupancyMapVec[miplev] );
-    } else {
-      pushPullMip( image, mipVec[miplev], occupancyMapTemp, mipOccupancyMapVec[miplev] );
-    }
-    if ( mipVec[miplev].getWidth() <= 4 || mipVec[miplev].getHeight() <= 4 ) { break; }
-    ++miplev;
+  pushPullMip( image, pyramid.getImage( 0 ), occupancyMap, pyramid.getOccupancyMap( 0 ) );
+  for ( size_t i = 1; i < levelCount; i++ ) {
+    pushPullMip( pyramid.getImage( i - 1 ), pyramid.getImage( i ), pyramid.getOccupancyMap( i - 1 ),
+                 pyramid.getOccupancyMap( i ) );
   }
-  miplev++;
 #if DEBUG_PATCH
-  for ( int k = 0; k < miplev; k++ ) {
+  for ( size_t k = 0; k < levelCount; k++ ) {
     char buf[100];
-    sprintf( buf, "mip%02i", k );
-    std::string filename = addVideoFormat( buf, mipVec[k].getWidth(), mipVec[k].getHeight(), false, false );
-    mipVec[k].write( filename, 1 );
+    sprintf( buf, "mip%02zu", k );
+    auto&       mip      = pyramid.getImage( k );
+    std::string filename = addVideoFormat( buf, mip.getWidth(), mip.getHeight(), false, false );
+    mip.write( filename, 1 );
   }
 #endif
   // push phase: refill
   int numIters = 4;
-  for ( i = miplev - 1; i >= 0; --i ) {
-    if ( i > 0 ) {
-      pushPullFill( mipVec[i - 1], mipVec[i], mipOccupancyMapVec[i - 1], numIters );
-    } else {
-      pushPullFill( image, mipVec[i], occupancyMapTemp, numIters );
-    }
+  for ( size_t i = levelCount - 1; i > 0; i-- ) {
+    pushPullFill( pyramid.getImage( i - 1 ), pyramid.getImage( i ), pyramid.getOccupancyMap( i - 1 ), numIters,
+                  pyramid.getScratchImage() );
     numIters = ( std::min )( numIters + 1, 16 );
   }
+  pushPullFill( image, pyramid.getImage( 0 ), occupancyMap, numIters, pyramid.getScratchImage() );
 #if DEBUG_PATCH
-  for ( int k = 0; k < miplev; k++ ) {
+  for ( size_t k = 0; k < levelCount; k++ ) {
     char buf[100];
-    sprintf( buf, "mipfill%02i", k );
-    std::string filename = addVideoFormat( buf, mipVec[k].getWidth(), mipVec[k].getHeight(), false, false );
-    mipVec[k].write( filename, 1 );
+    sprintf( buf, "mipfill%02zu", k );
+    auto&       mip      = pyramid.getImage( k );
+    std::string filename = addVideoFormat( buf, mip.getWidth(), mip.getHeight(), false, false );
+    mip.write( filename, 1 );
   }
 #endif
 }
 
 void PCCEncoder::presmoothPointCloudColor( PCCPointSet3& reconstruct, const PCCEncoderParameters params ) {
   const size_t            pointCount = reconstruct.getPointCount();
-  PCCKdTree               kdtree( reconstruct );
+  auto                    kdtreePtr  = getKdTree( kdTreeCache_, reconstruct );
+  const PCCKdTree&        kdtree     = *kdtreePtr;
   PCCNNResult             result;
   std::vector<PCCColor3B> temp;
   temp.resize( pointCount );
@@ -7043,22 +6857,28 @@ bool PCCEncoder::generateTextureVideo( const PCCGroupOfFrames&     sources,
   } else {
     video.resize( context.size() * ( params.mapCountMinus1_ + 1 ) );
   }
-  bool ret = true;
+  bool            ret = true;
+  tbb::task_arena limited( static_cast<int>( params_.nbThread_ ) );
   for ( size_t i = 0; i < context.size(); i++ ) {
     auto&  frame    = context[i].getTitleFrameContext();
     size_t mapCount = params_.mapCountMinus1_ + 1;
-    sources[i].transferColors( reconstructs[i], int32_t( params_.bestColorSearchRange_ ),
-                               static_cast<int>( params_.losslessGeo_ ) == 1, params_.numNeighborsColorTransferFwd_,
-                               params_.numNeighborsColorTransferBwd_, params_.useDistWeightedAverageFwd_,
-                               params_.useDistWeightedAverageBwd_, params_.skipAvgIfIdenticalSourcePointPresentFwd_,
-                               params_.skipAvgIfIdenticalSourcePointPresentBwd_, params_.distOffsetFwd_,
-                               params_.distOffsetBwd_, params_.maxGeometryDist2Fwd_, params_.maxGeometryDist2Bwd_,
-                               params_.maxColorDist2Fwd_, params_.maxColorDist2Bwd_, params_.excludeColorOutlier_,
-                               params_.thresholdColorOutlierDist_ );
+    // the two passes of the color transfer search the points concurrently
+    limited.execute( [&] {
+      sources[i].transferColors( reconstructs[i], int32_t( params_.bestColorSearchRange_ ),
+                                 static_cast<int>( params_.losslessGeo_ ) == 1, params_.numNeighborsColorTransferFwd_,
+                                 params_.numNeighborsColorTransferBwd_, params_.useDistWeightedAverageFwd_,
+                                 params_.useDistWeightedAverageBwd_, params_.skipAvgIfIdenticalSourcePointPresentFwd_,
+                                 params_.skipAvgIfIdenticalSourcePointPresentBwd_, params_.distOffsetFwd_,
+                                 params_.distOffsetBwd_, params_.maxGeometryDist2Fwd_, params_.maxGeometryDist2Bwd_,
+                                 params_.maxColorDist2Fwd_, params_.maxColorDist2Bwd_, params_.excludeColorOutlier_,
+                                 params_.thresholdColorOutlierDist_, kdTreeCache_ );
+    } );
     // color pre-smoothing
     if ( !params_.losslessGeo_ && params_.flagColorPreSmoothing_ ) {
       presmoothPointCloudColor( reconstructs[i], params );
     }
+    // the reconstructed point cloud is smoothed and may be regenerated by the next stages
+    if ( kdTreeCache_ != nullptr ) { kdTreeCache_->release( reconstructs[i] ); }
     size_t imageWidth  = frame.getWidth();
     size_t imageHeight = frame.getHeight();
     if ( params_.multipleStreams_ ) {
@@ -7495,9 +7315,9 @@ size_t PCCEncoder::unionPatchGenerationAndPacking( const GlobalPatches& globalPa
   size_t height = occupancySizeV * params_.occupancyResolution_;
   size_t maxOccupancyRow{0};
 
-  std::vector<bool> occupancyMap;
+  PCCBitboardCanvas occupancyMap;
   int               numOrientations = params_.packingStrategy_ == 0 ? 1 : ( params_.useEightOrientations_ ? 8 : 2 );
-  occupancyMap.resize( occupancySizeU * occupancySizeV, false );
+  occupancyMap.resize( occupancySizeU, occupancySizeV );
   for ( auto& iter : unionPatchTemp ) {
     auto& curPatchUnion = iter.second;  // [u0, v0] may be modified;
     assert( curPatchUnion.getSizeU0() < occupancySizeU );
@@ -7552,16 +7372,16 @@ size_t PCCEncoder::unionPatchGenerationAndPacking( const GlobalPatches& globalPa
       }
       if ( !locationFound ) {
         occupancySizeV *= 2;
-        occupancyMap.resize( occupancySizeU * occupancySizeV );
+        occupancyMap.resize( occupancySizeU, occupancySizeV );
       }
     }
     for ( size_t v0 = 0; v0 < curPatchUnion.getSizeV0(); ++v0 ) {
       for ( size_t u0 = 0; u0 < curPatchUnion.getSizeU0(); ++u0 ) {
         int coord = curPatchUnion.patchBlock2CanvasBlock( u0, v0, occupancySizeU, occupancySizeV );
         if ( params_.lowDelayEncoding_ ) {
-          occupancyMap[coord] = true;
+          occupancyMap.set( coord );
         } else {
-          occupancyMap[coord] = occupancyMap[coord] || occupancy[v0 * curPatchUnion.getSizeU0() + u0];
+          if ( occupancy[v0 * curPatchUnion.getSizeU0() + u0] ) { occupancyMap.set( coord ); }
         }
       }
     }
@@ -7607,8 +7427,8 @@ void PCCEncoder::packingFirstFrame( PCCContext& context,
   {
     int numOrientations = ( params_.packingStrategy_ == 0 ) ? 1 : ( params_.useEightOrientations_ ? 8 : 2 );
 
-    std::vector<bool> occupancyMap;
-    occupancyMap.resize( occupancySizeU * occupancySizeV, false );
+    PCCBitboardCanvas occupancyMap;
+    occupancyMap.resize( occupancySizeU, occupancySizeV );
 
     for ( auto& patch : patches ) {
       assert( patch.getSizeU0() <= occupancySizeU );
@@ -7683,16 +7503,16 @@ void PCCEncoder::packingFirstFrame( PCCContext& context,
         }
         if ( !locationFound ) {
           occupancySizeV *= 2;
-          occupancyMap.resize( occupancySizeU * occupancySizeV );
+          occupancyMap.resize( occupancySizeU, occupancySizeV );
         }
       }
       for ( size_t v0 = 0; v0 < curGPAPatchData.sizeV0; ++v0 ) {
         for ( size_t u0 = 0; u0 < curGPAPatchData.sizeU0; ++u0 ) {
           int coord = patch.patchBlock2CanvasBlockForGPA( u0, v0, occupancySizeU, occupancySizeV );
           if ( params_.lowDelayEncoding_ ) {
-            occupancyMap[coord] = true;
+            occupancyMap.set( coord );
           } else {
-            occupancyMap[coord] = occupancyMap[coord] || occupancy[v0 * patch.getSizeU0() + u0];
+            if ( occupancy[v0 * patch.getSizeU0() + u0] ) { occupancyMap.set( coord ); }
           }
         }
       }
@@ -7932,8 +7752,8 @@ void PCCEncoder::performGPAPacking( const SubContext& subContext,
     widthGPA  = occupancySizeU * params_.occupancyResolution_;
     heightGPA = occupancySizeV * params_.occupancyResolution_;
     size_t            maxOccupancyRow{0};
-    std::vector<bool> occupancyMap;
-    occupancyMap.resize( occupancySizeU * occupancySizeV, false );
+    PCCBitboardCanvas occupancyMap;
+    occupancyMap.resize( occupancySizeU, occupancySizeV );
     // !!!packing global matched patch;
     for ( auto& patch : patches ) {
       GPAPatchData& curGPAPatchData = patch.getCurGPAPatchData();
@@ -7955,9 +7775,9 @@ void PCCEncoder::performGPAPacking( const SubContext& subContext,
           for ( size_t u0 = 0; u0 < curGPAPatchData.sizeU0; ++u0 ) {
             int coord = patch.patchBlock2CanvasBlockForGPA( u0, v0, occupancySizeU, occupancySizeV );
             if ( params_.lowDelayEncoding_ ) {
-              occupancyMap[coord] = true;
+              occupancyMap.set( coord );
             } else {
-              occupancyMap[coord] = occupancyMap[coord] || curGPAPatchData.occupancy[v0 * curGPAPatchData.sizeU0 + u0];
+              if ( curGPAPatchData.occupancy[v0 * curGPAPatchData.sizeU0 + u0] ) { occupancyMap.set( coord ); }
             }
           }
         }
@@ -8031,7 +7851,7 @@ void PCCEncoder::packingWithoutRefForFirstFrameNoglobalPatch(
     size_t&            occupancySizeU,
     size_t&            occupancySizeV,
     const size_t       safeguard,
-    std::vector<bool>& occupancyMap,
+    PCCBitboardCanvas& occupancyMap,
     size_t&            heightGPA,
     size_t&            widthGPA,
     size_t&            maxOccupancyRow ) {  // GPA_HAMONIZATION, the whole function has been
@@ -8087,7 +7907,7 @@ void PCCEncoder::packingWithoutRefForFirstFrameNoglobalPatch(
     }
     if ( !locationFound ) {
       occupancySizeV *= 2;
-      occupancyMap.resize( occupancySizeU * occupancySizeV );
+      occupancyMap.resize( occupancySizeU, occupancySizeV );
       if ( printDetailedInfo ) { std::cout << "Increase occupancySizeV " << occupancySizeV << std::endl; }
     }
   }
@@ -8096,9 +7916,9 @@ void PCCEncoder::packingWithoutRefForFirstFrameNoglobalPatch(
     for ( size_t u0 = 0; u0 < curGPAPatchData.sizeU0; ++u0 ) {
       int coord = patch.patchBlock2CanvasBlockForGPA( u0, v0, occupancySizeU, occupancySizeV );
       if ( params_.lowDelayEncoding_ ) {
-        occupancyMap[coord] = true;
+        occupancyMap.set( coord );
       } else {
-        occupancyMap[coord] = occupancyMap[coord] || occupancy[v0 * patch.getSizeU0() + u0];
+        if ( occupancy[v0 * patch.getSizeU0() + u0] ) { occupancyMap.set( coord ); }
       }
     }
   }
@@ -8124,7 +7944,7 @@ void PCCEncoder::packingWithRefForFirstFrameNoglobalPatch( PCCPatch&
                                                            size_t&                      occupancySizeU,
                                                            size_t&                      occupancySizeV,
                                                            const size_t                 safeguard,
-                                                           std::vector<bool>&           occupancyMap,
+                                                           PCCBitboardCanvas&           occupancyMap,
                                                            size_t&                      heightGPA,
                                                            size_t&                      widthGPA,
                                                            size_t&                      maxOccupancyRow ) {
@@ -8209,7 +8029,7 @@ void PCCEncoder::packingWithRefForFirstFrameNoglobalPatch( PCCPatch&
     }
     if ( !locationFound ) {
       occupancySizeV *= 2;
-      occupancyMap.resize( occupancySizeU * occupancySizeV );
+      occupancyMap.resize( occupancySizeU, occupancySizeV );
       if ( printDetailedInfo ) { std::cout << "Increase occupancySizeV " << occupancySizeV << std::endl; }
     }
   }
@@ -8217,9 +8037,9 @@ void PCCEncoder::packingWithRefForFirstFrameNoglobalPatch( PCCPatch&
     for ( size_t u0 = 0; u0 < curGPAPatchData.sizeU0; ++u0 ) {
       int coord = patch.patchBlock2CanvasBlockForGPA( u0, v0, occupancySizeU, occupancySizeV );
       if ( params_.lowDelayEncoding_ ) {
-        occupancyMap[coord] = true;
+        occupancyMap.set( coord );
       } else {
-        occupancyMap[coord] = occupancyMap[coord] || occupancy[v0 * curGPAPatchData.sizeU0 + u0];
+        if ( occupancy[v0 * curGPAPatchData.sizeU0 + u0] ) { occupancyMap.set( coord ); }
       }
     }
   }
@@ -8920,15 +8740,39 @@ void PCCEncoder::createHashInformation( PCCContext& context, int frameIndex, siz
   // for tiles
   if ( ( sei.getDecodedAtlasTilesHashPresentFlag() || sei.getDecodedAtlasTilesB2pHashPresentFlag() ) &&
        !seiHashCancelFlag ) {
-    sei.allocateAtlasTilesHash( context[frameIndex].getNumTilesInAtlasFrame() );
-    sei.setNumTilesMinus1( context[frameIndex].getNumTilesInAtlasFrame() - 1 );
-    for ( size_t tileIdx = 0; tileIdx < context[frameIndex].getNumTilesInAtlasFrame(); tileIdx++ ) {
-      auto&  tile         = context[frameIndex].getTile( tileIdx );
-      size_t atlIdx       = tile.getAtlIndex();
-      auto&  tileHeader   = context.getAtlasTileLayerList()[atlIdx].getHeader();
-      auto&  tileDataUnit = context.getAtlasTileLayerList()[atlIdx].getDataUnit();
-      size_t patchCount   = tileDataUnit.getPatchCount() - 1;  // not the last I_END or P_END
-      size_t tileId       = tileHeader.getId();
+    size_t numTilesInPatchFrame = context[frameIndex].getNumTilesInAtlasFrame();
+    sei.allocateAtlasTilesHash( numTilesInPatchFrame );
+    sei.setNumTilesMinus1( numTilesInPatchFrame - 1 );
+    // the byte strings of the tiles are built and hashed concurrently, then reported in the order of the tiles
+    std::vector<PCCSeiHashDigest> tileHashes( numTilesInPatchFrame );
+    std::vector<PCCSeiHashDigest> tileB2PHashes( numTilesInPatchFrame );
+    tbb::task_arena               limited( static_cast<int>( params_.nbThread_ ) );
+    limited.execute( [&] {
+      tbb::parallel_for( size_t( 0 ), numTilesInPatchFrame, [&]( const size_t tileIdx ) {
+        size_t atlIdx     = context[frameIndex].getTile( tileIdx ).getAtlIndex();
+        auto&  atlu       = context.getAtlasTileLayerList()[atlIdx];
+        size_t patchCount = atlu.getDataUnit().getPatchCount() - 1;  // not the last I_END or P_END
+        size_t tileId     = atlu.getHeader().getId();
+        if ( sei.getDecodedAtlasTilesHashPresentFlag() ) {
+          std::vector<uint8_t> atlasTileData;
+          for ( size_t patchIdx = 0; patchIdx < patchCount; patchIdx++ ) {
+            tilePatchCommonByteString( atlasTileData, tileId, patchIdx, tilePatchParams );
+            tilePatchApplicationByteString( atlasTileData, tileId, patchIdx, tilePatchParams );
+          }
+          context.computeHash( atlasTileData, sei.getHashType(), tileHashes[tileIdx] );
+        }
+        if ( sei.getDecodedAtlasTilesB2pHashPresentFlag() ) {
+          std::vector<uint8_t> tileB2PData;
+          tileBlockToPatchByteString( tileB2PData, tileId, tileB2PPatchParams );
+          context.computeHash( tileB2PData, sei.getHashType(), tileB2PHashes[tileIdx] );
+        }
+      } );
+    } );
+    for ( size_t tileIdx = 0; tileIdx < numTilesInPatchFrame; tileIdx++ ) {
+      auto&  tile       = context[frameIndex].getTile( tileIdx );
+      size_t atlIdx     = tile.getAtlIndex();
+      auto&  tileHeader = context.getAtlasTileLayerList()[atlIdx].getHeader();
+      size_t tileId     = tileHeader.getId();
       sei.setTileId( tileIdx, tileId );
       if ( tileIdx == 0 ) {
         auto& tileInfo = context.getAtlasFrameParameterSet( tileHeader.getAtlasFrameParameterSetId() )
@@ -8946,51 +8790,36 @@ void PCCEncoder::createHashInformation( PCCContext& context, int frameIndex, siz
         sei.setTileIdLenMinus1( tileInfo.getNumTilesInAtlasFrameMinus1() == 0 ? 0 : ( bitCount - 1 ) );
       }
       if ( sei.getDecodedAtlasTilesHashPresentFlag() ) {
-        std::vector<uint8_t> atlasTileData;
-        for ( size_t patchIdx = 0; patchIdx < patchCount; patchIdx++ ) {
-          tilePatchCommonByteString( atlasTileData, tileId, patchIdx, tilePatchParams );
-          tilePatchApplicationByteString( atlasTileData, tileId, patchIdx, tilePatchParams );
-        }
         printf( "**sei** TilesPatchHash: frame(%d), tile(%zu, tileId %zu)\n", frameIndex, tileIdx, tileId );
+        auto& digest = tileHashes[tileIdx];
         if ( sei.getHashType() == 0 ) {
-          std::vector<uint8_t> md5Digest( 16 );
-          md5Digest = context.computeMD5( atlasTileData.data(), atlasTileData.size() );
           printf( "\t**sei** (MD5): " );
-          for ( auto& e : md5Digest ) printf( "%02x", e );
+          for ( auto& e : digest.md5_ ) printf( "%02x", e );
           printf( "\n" );
-          for ( int j = 0; j < 16; j++ ) sei.setAtlasTilesMd5( tileId, j, md5Digest[j] );
+          for ( int j = 0; j < 16; j++ ) sei.setAtlasTilesMd5( tileId, j, digest.md5_[j] );
         } else if ( sei.getHashType() == 1 ) {
-          uint16_t crc = context.computeCRC( atlasTileData.data(), atlasTileData.size() );
-          printf( "\t**sei** (crc): % 02x ", crc );
-          sei.setAtlasTilesCrc( tileId, crc );
+          printf( "\t**sei** (crc): % 02x ", digest.crc_ );
+          sei.setAtlasTilesCrc( tileId, digest.crc_ );
         } else if ( sei.getHashType() == 2 ) {
-          uint32_t checkSum = context.computeCheckSum( atlasTileData.data(), atlasTileData.size() );
-          printf( "\t**sei** (checkSum): % 08x ", checkSum );
-          sei.setAtlasTilesCheckSum( tileId, checkSum );
+          printf( "\t**sei** (checkSum): % 08x ", digest.checkSum_ );
+          sei.setAtlasTilesCheckSum( tileId, digest.checkSum_ );
         }
-        atlasTileData.clear();
       }
       if ( sei.getDecodedAtlasTilesB2pHashPresentFlag() ) {
-        std::vector<uint8_t> tileB2PData;
-        tileBlockToPatchByteString( tileB2PData, tileId, tileB2PPatchParams );
         printf( "**sei** TilesB2pPatchHash: frame(%d), tileIdx(%zu)\n", frameIndex, tileIdx );
+        auto& digest = tileB2PHashes[tileIdx];
         if ( sei.getHashType() == 0 ) {
-          std::vector<uint8_t> md5Digest( 16 );
-          md5Digest = context.computeMD5( tileB2PData.data(), tileB2PData.size() );
           printf( "\t**sei** (MD5): " );
-          for ( auto& e : md5Digest ) printf( "%02x", e );
+          for ( auto& e : digest.md5_ ) printf( "%02x", e );
           printf( "\n" );
-          for ( int j = 0; j < 16; j++ ) sei.setAtlasTilesB2pMd5( tileId, j, md5Digest[j] );
+          for ( int j = 0; j < 16; j++ ) sei.setAtlasTilesB2pMd5( tileId, j, digest.md5_[j] );
         } else if ( sei.getHashType() == 1 ) {
-          uint16_t crc = context.computeCRC( tileB2PData.data(), tileB2PData.size() );
-          printf( "\t**sei** (CRC): % 04x ", crc );
-          sei.setAtlasTilesB2pCrc( tileId, crc );
+          printf( "\t**sei** (CRC): % 04x ", digest.crc_ );
+          sei.setAtlasTilesB2pCrc( tileId, digest.crc_ );
         } else if ( sei.getHashType() == 2 ) {
-          uint32_t checkSum = context.computeCheckSum( tileB2PData.data(), tileB2PData.size() );
-          printf( "\t**sei** (checkSum): % 08x ", checkSum );
-          sei.setAtlasTilesB2pCheckSum( tileId, checkSum );
+          printf( "\t**sei** (checkSum): % 08x ", digest.checkSum_ );
+          sei.setAtlasTilesB2pCheckSum( tileId, digest.checkSum_ );
         }
-        tileB2PData.clear();
       }
     }
   }
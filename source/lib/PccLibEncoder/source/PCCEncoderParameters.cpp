@@ -127,6 +127,8 @@ PCCEncoderParameters::PCCEncoderParameters() {
   geometryAuxVideoConfig_                  = {};
   textureAuxVideoConfig_                   = {};
   nbThread_                                = 1;
+  groupOfFramesPipelineDepth_              = 1;
+  v3cUnitSizePrecisionBytes_               = 0;
   keepIntermediateFiles_                   = false;
 
   absoluteD1_                             = true;
@@ -278,6 +280,8 @@ void PCCEncoderParameters::print() {
   std::cout << "\t mapCountMinus1                           " << mapCountMinus1_ << std::endl;
   std::cout << "\t startFrameNumber                         " << startFrameNumber_ << std::endl;
   std::cout << "\t groupOfFramesSize                        " << groupOfFramesSize_ << std::endl;
+  std::cout << "\t groupOfFramesPipelineDepth               " << groupOfFramesPipelineDepth_ << std::endl;
+  std::cout << "\t v3cUnitSizePrecisionBytes                " << v3cUnitSizePrecisionBytes_ << std::endl;
   std::cout << "\t colorTransform                           " << colorTransform_ << std::endl;
   std::cout << "\t nbThread                                 " << nbThread_ << std::endl;
   std::cout << "\t keepIntermediateFiles                    " << keepIntermediateFiles_ << std::endl;
@@ -546,6 +550,14 @@ bool PCCEncoderParameters::check() {
     ret = false;
     std::cerr << "uncompressedDataPath not set\n";
   }
+  if ( groupOfFramesPipelineDepth_ == 0 ) {
+    std::cerr << "groupOfFramesPipelineDepth must be greater than 0: force to 1\n";
+    groupOfFramesPipelineDepth_ = 1;
+  }
+  if ( v3cUnitSizePrecisionBytes_ > 8 ) {
+    ret = false;
+    std::cerr << "v3cUnitSizePrecisionBytes must be in [0;8]\n";
+  }
 
   if ( !PCCVirtualVideoEncoder<uint8_t>::checkCodecId( videoEncoderOccupancyCodecId_ ) ||
        !PCCVirtualVideoEncoder<uint8_t>::checkCodecId( videoEncoderGeometryCodecId_ ) ||
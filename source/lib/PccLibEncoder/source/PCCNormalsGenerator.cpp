@@ -40,6 +40,18 @@
 
 using namespace pcc;
 
+// Search of the neighbors the spanning tree propagates the orientation through.
+static PCCNNQuery3 getOrientationQuery( const PCCNormalsGenerator3Parameters& params ) {
+  return {PCCPoint3D( 0.0 ), static_cast<float>( params.radiusNormalOrientation_ ) * params.radiusNormalOrientation_,
+          params.numberOfNearestNeighborsInNormalOrientation_};
+}
+
+// True if the two queries return the same neighbors, the radius of a query being ignored above 32768.
+static bool isSameQuery( const PCCNNQuery3& a, const PCCNNQuery3& b ) {
+  return a.nearestNeighborCount == b.nearestNeighborCount &&
+         ( a.radius == b.radius || ( a.radius > 32768.0 && b.radius > 32768.0 ) );
+}
+
 void PCCNormalsGenerator3::init( const size_t pointCount, const PCCNormalsGenerator3Parameters& params ) {
   normals_.resize( pointCount );
   if ( params.storeNumberOfNearestNeighborsInNormalEstimation_ ) {
@@ -57,6 +69,8 @@ void PCCNormalsGenerator3::init( const size_t pointCount, const PCCNormalsGenera
   } else {
     barycenters_.resize( 0 );
   }
+  neighborCounts_.resize( 0 );
+  neighborStride_ = 0;
 }
 void PCCNormalsGenerator3::compute( const PCCPointSet3&                   pointCloud,
                                     const PCCKdTree&                      kdtree,
@@ -80,6 +94,12 @@ void PCCNormalsGenerator3::computeNormal( const size_t
   PCCMatrix3D Q;
   PCCMatrix3D D;
   kdtree.search( pointCloud[index], params.numberOfNearestNeighborsInNormalEstimation_, nNResult );
+  if ( !neighborCounts_.empty() ) {
+    neighborCounts_[index] = uint32_t( ( std::min )( nNResult.count(), neighborStride_ ) );
+    for ( size_t i = 0; i < neighborCounts_[index]; ++i ) {
+      neighbors_[index * neighborStride_ + i] = uint32_t( nNResult.indices( i ) );
+    }
+  }
   if ( nNResult.count() > 1 ) {
     bary = 0.0;
     for ( size_t i = 0; i < nNResult.count(); ++i ) { bary += pointCloud[nNResult.indices( i )]; }
@@ -160,6 +180,17 @@ void PCCNormalsGenerator3::computeNormals( const PCCPointSet3&
                                            const PCCNormalsGenerator3Parameters& params ) {
   const size_t pointCount = pointCloud.getPointCount();
   normals_.resize( pointCount );
+  // the spanning tree orientation searches the same neighbors when it does not limit their distance
+  const PCCNNQuery3 nNQuery = {PCCPoint3D( 0.0 ), ( std::numeric_limits<double>::max )(),
+                               params.numberOfNearestNeighborsInNormalEstimation_};
+  if ( ( params.orientationStrategy_ == PCC_NORMALS_GENERATOR_ORIENTATION_SPANNING_TREE ||
+         params.orientationStrategy_ == PCC_NORMALS_GENERATOR_ORIENTATION_CUBEMAP_PROJECTION ) &&
+       isSameQuery( getOrientationQuery( params ), nNQuery ) ) {
+    neighborStride_ = nNQuery.nearestNeighborCount;
+    neighborsQuery_ = nNQuery;
+    neighbors_.resize( pointCount * neighborStride_ );
+    neighborCounts_.resize( pointCount );
+  }
   std::vector<size_t> subRanges;
   const size_t        chunckCount = 64;
   PCCDivideRange( 0, pointCount, chunckCount, subRanges );
@@ -192,12 +223,11 @@ void PCCNormalsGenerator3::orientNormals( const PCCPointSet3&
     PCCNNResult  nNResult;
     visited_.resize( pointCount );
     std::fill( visited_.begin(), visited_.end(), 0 );
-    PCCNNQuery3 nNQuery             = {PCCPoint3D( 0.0 ),
-                           static_cast<float>( params.radiusNormalOrientation_ ) * params.radiusNormalOrientation_,
-                           params.numberOfNearestNeighborsInNormalOrientation_};
+    PCCNNQuery3 nNQuery             = getOrientationQuery( params );
     PCCNNQuery3 nNQuery2            = {PCCPoint3D( 0.0 ), ( std::numeric_limits<float>::max )(),
                             params.numberOfNearestNeighborsInNormalOrientation_};
     size_t      processedPointCount = 0;
+    gatherNeighbors( pointCloud, kdtree, nNQuery );
     for ( size_t ptIndex = 0; ptIndex < pointCount; ++ptIndex ) {
       if ( visited_[ptIndex] == 0u ) {
         visited_[ptIndex] = 1;
@@ -436,9 +466,8 @@ void PCCNormalsGenerator3::orientNormals( const PCCPointSet3&
     saveNormal2.write( "normal_projection_orientation.ply" );
 #endif
     // smooth reference normals
-    PCCNNQuery3 nNQuery  = {PCCPoint3D( 0.0 ),
-                           static_cast<float>( params.radiusNormalOrientation_ ) * params.radiusNormalOrientation_,
-                           params.numberOfNearestNeighborsInNormalOrientation_};
+    // most of the points are oriented by the projection: the neighbors are only reused if computeNormals() kept them
+    PCCNNQuery3 nNQuery  = getOrientationQuery( params );
     PCCNNQuery3 nNQuery2 = {PCCPoint3D( 0.0 ), ( std::numeric_limits<float>::max )(),
                             params.numberOfNearestNeighborsInNormalOrientation_};
 
@@ -508,6 +537,40 @@ void PCCNormalsGenerator3::orientNormals( const PCCPointSet3&
     saveNormal4.write( "normal_orientation_final.ply" );
 #endif
   }
+  // the neighbors are only used by the orientation
+  std::vector<uint32_t>().swap( neighbors_ );
+  std::vector<uint32_t>().swap( neighborCounts_ );
+}
+void PCCNormalsGenerator3::gatherNeighbors( const PCCPointSet3& pointCloud,
+                                            const PCCKdTree&    kdtree,
+                                            const PCCNNQuery3&  nNQuery ) {
+  const size_t pointCount = pointCloud.getPointCount();
+  if ( neighborCounts_.size() == pointCount && isSameQuery( neighborsQuery_, nNQuery ) ) { return; }
+  neighborStride_ = nNQuery.nearestNeighborCount;
+  neighborsQuery_ = nNQuery;
+  neighbors_.resize( pointCount * neighborStride_ );
+  neighborCounts_.resize( pointCount );
+  std::vector<size_t> subRanges;
+  const size_t        chunckCount = 64;
+  PCCDivideRange( 0, pointCount, chunckCount, subRanges );
+  tbb::task_arena limited( static_cast<int>( nbThread_ ) );
+  limited.execute( [&] {
+    tbb::parallel_for( size_t( 0 ), subRanges.size() - 1, [&]( const size_t i ) {
+      PCCNNResult nNResult;
+      for ( size_t ptIndex = subRanges[i]; ptIndex < subRanges[i + 1]; ++ptIndex ) {
+        if ( nNQuery.radius > 32768.0 ) {
+          kdtree.search( pointCloud[ptIndex], nNQuery.nearestNeighborCount, nNResult );
+        } else {
+          nNResult.resize( 0 );
+          kdtree.searchRadius( pointCloud[ptIndex], nNQuery.nearestNeighborCount, nNQuery.radius, nNResult );
+        }
+        neighborCounts_[ptIndex] = uint32_t( ( std::min )( nNResult.count(), neighborStride_ ) );
+        for ( size_t j = 0; j < neighborCounts_[ptIndex]; ++j ) {
+          neighbors_[ptIndex * neighborStride_ + j] = uint32_t( nNResult.indices( j ) );
+        }
+      }
+    } );
+  } );
 }
 void PCCNormalsGenerator3::addNeighbors( const uint32_t      current,
                                          const PCCPointSet3& pointCloud,
@@ -518,15 +581,24 @@ void PCCNormalsGenerator3::addNeighbors( const uint32_t      current,
                                          size_t&             numberOfNormals ) {
   accumulatedNormals = 0.0;
   numberOfNormals    = 0;
-  if ( nNQuery.radius > 32768.0 ) {
-    kdtree.search( pointCloud[current], nNQuery.nearestNeighborCount, nNResult );
+  const uint32_t* neighbors     = nullptr;
+  size_t          neighborCount = 0;
+  if ( !neighborCounts_.empty() && isSameQuery( neighborsQuery_, nNQuery ) ) {
+    neighbors     = neighbors_.data() + current * neighborStride_;
+    neighborCount = neighborCounts_[current];
   } else {
-    kdtree.searchRadius( pointCloud[current], nNQuery.nearestNeighborCount, nNQuery.radius, nNResult );
+    if ( nNQuery.radius > 32768.0 ) {
+      kdtree.search( pointCloud[current], nNQuery.nearestNeighborCount, nNResult );
+    } else {
+      nNResult.resize( 0 );
+      kdtree.searchRadius( pointCloud[current], nNQuery.nearestNeighborCount, nNQuery.radius, nNResult );
+    }
+    neighborCount = nNResult.count();
   }
   PCCWeightedEdge newEdge;
   uint32_t        index;
-  for ( size_t i = 0; i < nNResult.count(); ++i ) {
-    index = static_cast<uint32_t>( nNResult.indices( i ) );
+  for ( size_t i = 0; i < neighborCount; ++i ) {
+    index = neighbors != nullptr ? neighbors[i] : static_cast<uint32_t>( nNResult.indices( i ) );
     if ( visited_[index] == 0u ) {
       newEdge.weight_ = fabs( normals_[current] * normals_[index] );
       newEdge.end_    = index;
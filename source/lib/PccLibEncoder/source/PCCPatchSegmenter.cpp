@@ -72,7 +72,8 @@ void PCCPatchSegmenter3::compute( const PCCPointSet3&                 geometry,
   }
   std::cout << std::endl << "============= FRAME " << frameIndex << " ============= " << std::endl;
   std::cout << "  Computing normals for original point cloud... ";
-  PCCKdTree            kdtree( geometry );
+  auto                 kdtreePtr          = getKdTree( kdTreeCache_, geometry );
+  const PCCKdTree&     kdtree             = *kdtreePtr;
   PCCNNResult          result;
   PCCNormalsGenerator3 normalsGen;
   auto                 normalsOrientation = static_cast<PCCNormalsGeneratorOrientation>( params.normalOrientation_ );
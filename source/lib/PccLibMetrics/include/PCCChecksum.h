@@ -60,6 +60,10 @@ class PCCChecksum {
   bool compareRecDec();
 
  private:
+  void compute( PCCGroupOfFrames&                  groupOfFrames,
+               bool                               reorderPoints,
+               std::vector<std::vector<uint8_t>>& checksums,
+               const char*                        name );
   bool compare( std::vector<std::vector<uint8_t>>& checksumsA, std::vector<std::vector<uint8_t>>& checksumsB );
 
   PCCMetricsParameters params_;
@@ -41,6 +41,7 @@
 namespace pcc {
 
 class PCCGroupOfFrames;
+class PCCKdTreeCache;
 
 /**
  * Note: This object is a integration of the mpeg-pcc-dmetric tool (
@@ -56,7 +57,7 @@ class QualityMetrics {
 
   void setParameters( const PCCMetricsParameters& params );
 
-  void compute( const PCCPointSet3& cloudA, const PCCPointSet3& cloudB );
+  void compute( const PCCPointSet3& cloudA, const PCCPointSet3& cloudB, PCCKdTreeCache* kdTreeCache = nullptr );
 
   QualityMetrics operator+( const QualityMetrics& metric ) const;
 
@@ -93,13 +94,31 @@ class PCCMetrics {
   PCCMetrics();
   ~PCCMetrics();
   void setParameters( const PCCMetricsParameters& params );
+  void setKdTreeCache( PCCKdTreeCache* kdTreeCache ) { kdTreeCache_ = kdTreeCache; }
   void compute( const PCCGroupOfFrames& sources,
                 const PCCGroupOfFrames& reconstructs,
                 const PCCGroupOfFrames& normals );
   void compute( PCCPointSet3& source, PCCPointSet3& reconstruct, const PCCPointSet3& normalSource );
+
+  // A source frame prepared once can be evaluated against several reconstructions: its kd-trees are then taken
+  // from the kd-tree cache shared by the evaluations.
+  void prepareSource( const PCCPointSet3& sourceOrg, const PCCPointSet3& normalSource, PCCPointSet3& source );
+  void compute( const PCCPointSet3& source,
+                size_t              sourcePointCount,
+                const PCCPointSet3& reconstructOrg,
+                const PCCPointSet3& normalSource );
   void display();
 
+  size_t                             getFrameCount() const { return qualityF.size(); }
+  size_t                             getSourcePointCount( size_t i ) const { return sourcePoints_[i]; }
+  size_t                             getReconstructPointCount( size_t i ) const { return reconstructPoints_[i]; }
+  const std::vector<QualityMetrics>& getQuality1() const { return quality1; }
+  const std::vector<QualityMetrics>& getQuality2() const { return quality2; }
+  const std::vector<QualityMetrics>& getQualityF() const { return qualityF; }
+
  private:
+  void computeQuality( const PCCPointSet3& source, const PCCPointSet3& reconstruct, PCCKdTreeCache* kdTreeCache );
+
   std::vector<size_t> sourcePoints_;
   std::vector<size_t> sourceDuplicates_;
   std::vector<size_t> reconstructPoints_;
@@ -109,6 +128,7 @@ class PCCMetrics {
   std::vector<QualityMetrics> quality2;
   std::vector<QualityMetrics> qualityF;
   PCCMetricsParameters        params_;
+  PCCKdTreeCache*             kdTreeCache_;
 };
 
 };  // namespace pcc
@@ -48,6 +48,7 @@ class PCCMetricsParameters {
 
   bool computeMetrics_;
   bool computeChecksum_;
+  bool fastChecksum_;  //! non-cryptographic digest in place of MD5, only comparable with itself
 
   size_t startFrameNumber_;
   size_t frameCount_;
@@ -57,6 +58,8 @@ class PCCMetricsParameters {
   std::string uncompressedDataPath_;
   std::string reconstructedDataPath_;
   std::string normalDataPath_;
+  std::string reconstructedDataListPath_;  //! file listing the reconstructed sequences evaluated in batch mode
+  std::string resultPath_;                 //! per frame results of the batch mode (.json or .csv)
 
   size_t nbThread_;
 
@@ -35,6 +35,7 @@
 #include "PCCPointSet.h"
 
 #include "PCCChecksum.h"
+#include <tbb/tbb.h>
 
 using namespace std;
 using namespace pcc;
@@ -49,42 +50,40 @@ PCCChecksum::~PCCChecksum() {
 void PCCChecksum::setParameters( const PCCMetricsParameters& params ) { params_ = params; }
 
 void PCCChecksum::computeSource( PCCGroupOfFrames& groupOfFrames ) {
-  for ( auto& frame : groupOfFrames ) {
-    checksumsSrc_.push_back( frame.computeChecksum( true ) );
-    printf( "ChecksumSrc: " );
-    for ( auto& c : checksumsSrc_.back() ) { printf( "%02x", c ); }
-    printf( "\n" );
-    fflush( stdout );
-  }
+  compute( groupOfFrames, true, checksumsSrc_, "ChecksumSrc" );
 }
 
 void PCCChecksum::computeReordered( PCCGroupOfFrames& groupOfFrames ) {
-  for ( auto& frame : groupOfFrames ) {
-    checksumsOrd_.push_back( frame.computeChecksum( true ) );
-    printf( "ChecksumOrd: " );
-    for ( auto& c : checksumsOrd_.back() ) { printf( "%02x", c ); }
-    printf( "\n" );
-    fflush( stdout );
-  }
+  compute( groupOfFrames, true, checksumsOrd_, "ChecksumOrd" );
 }
 void PCCChecksum::computeReconstructed( PCCGroupOfFrames& groupOfFrames ) {
-  for ( auto& frame : groupOfFrames ) {
-    checksumsRec_.push_back( frame.computeChecksum() );
-    printf( "ChecksumRec: " );
-    for ( auto& c : checksumsRec_.back() ) { printf( "%02x", c ); }
-    printf( "\n" );
-    fflush( stdout );
-  }
+  compute( groupOfFrames, false, checksumsRec_, "ChecksumRec" );
 }
 
 void PCCChecksum::computeDecoded( PCCGroupOfFrames& groupOfFrames ) {
-  for ( auto& frame : groupOfFrames ) {
-    checksumsDec_.push_back( frame.computeChecksum() );
-    printf( "ChecksumDec: " );
-    for ( auto& c : checksumsDec_.back() ) { printf( "%02x", c ); }
+  compute( groupOfFrames, false, checksumsDec_, "ChecksumDec" );
+}
+
+void PCCChecksum::compute( PCCGroupOfFrames&                  groupOfFrames,
+                           bool                               reorderPoints,
+                           std::vector<std::vector<uint8_t>>& checksums,
+                           const char*                        name ) {
+  // the frames are hashed concurrently, then appended and printed in their order
+  const size_t    start = checksums.size();
+  tbb::task_arena limited( params_.nbThread_ > 0 ? static_cast<int>( params_.nbThread_ )
+                                                 : static_cast<int>( tbb::task_arena::automatic ) );
+  checksums.resize( start + groupOfFrames.getFrameCount() );
+  limited.execute( [&] {
+    tbb::parallel_for( size_t( 0 ), groupOfFrames.getFrameCount(), [&]( const size_t i ) {
+      checksums[start + i] = groupOfFrames[i].computeChecksum( reorderPoints, params_.fastChecksum_ );
+    } );
+  } );
+  for ( size_t i = start; i < checksums.size(); i++ ) {
+    printf( "%s: ", name );
+    for ( auto& c : checksums[i] ) { printf( "%02x", c ); }
     printf( "\n" );
-    fflush( stdout );
   }
+  fflush( stdout );
 }
 
 void PCCChecksum::read( const std::string& compressedStreamPath ) {
@@ -128,7 +127,7 @@ bool PCCChecksum::compare( std::vector<std::vector<uint8_t>>& checksumsA,
   bool   equal = checksumsA.size() == checksumsB.size();
   for ( size_t i = 0; equal && ( i < num ); i++ ) {
     if ( checksumsA[i] != checksumsB[i] ) { equal = false; }
-    printf( "PLY %4zu: [MD5:", params_.startFrameNumber_ + i );
+    printf( "PLY %4zu: [%s:", params_.startFrameNumber_ + i, params_.fastChecksum_ ? "FAST" : "MD5" );
     for ( auto& c : checksumsA[i] ) { printf( "%02x", c ); }
     printf( "," );
     for ( auto& c : checksumsB[i] ) { printf( "%02x", c ); }
@@ -34,6 +34,7 @@
 #include "PCCGroupOfFrames.h"
 #include "PCCPointSet.h"
 #include "PCCKdTree.h"
+#include "PCCPointSetComponents.h"
 #include <tbb/tbb.h>
 
 #include "PCCMetrics.h"
@@ -61,6 +62,29 @@ void convertRGBtoYUV_BT709( const PCCColor3B& rgb, std::vector<float>& yuv ) {
   yuv[2] = float( ( 0.5000 * rgb[0] - 0.4542 * rgb[1] - 0.0458 * rgb[2] ) / 255.0 + 0.5000 );
 }
 
+// Colors of all the points converted to YUV component by component, with the operations of the conversion above.
+static void convertRGBtoYUV_BT709( const PCCPointSet3& pointcloud, std::vector<float> yuv[3] ) {
+  const PCCPointSetComponents components( pointcloud, true );
+  const size_t                pointCount = components.getPointCount();
+  const uint8_t*              r          = components.getColors( 0 );
+  const uint8_t*              g          = components.getColors( 1 );
+  const uint8_t*              b          = components.getColors( 2 );
+  for ( size_t c = 0; c < 3; c++ ) { yuv[c].resize( pointCount ); }
+  float* y = yuv[0].data();
+  float* u = yuv[1].data();
+  float* v = yuv[2].data();
+  for ( size_t i = 0; i < pointCount; i++ ) {
+    y[i] = float( ( 0.2126 * r[i] + 0.7152 * g[i] + 0.0722 * b[i] ) / 255.0 );
+    u[i] = float( ( -0.1146 * r[i] - 0.3854 * g[i] + 0.5000 * b[i] ) / 255.0 + 0.5000 );
+    v[i] = float( ( 0.5000 * r[i] - 0.4542 * g[i] - 0.0458 * b[i] ) / 255.0 + 0.5000 );
+  }
+}
+
+static void getYUV( const std::vector<float> yuvs[3], const size_t index, std::vector<float>& yuv ) {
+  yuv.resize( 3 );
+  for ( size_t c = 0; c < 3; c++ ) { yuv[c] = yuvs[c][index]; }
+}
+
 QualityMetrics::QualityMetrics() :
     c2cMse_( 0.0F ),
     c2cHausdorff_( 0.0F ),
@@ -73,13 +97,15 @@ QualityMetrics::QualityMetrics() :
     psnr_( 0.0F ),
     reflectanceMse_( 0.0F ),
     reflectancePsnr_( 0.0F ) {
-  colorMse_[0] = colorMse_[0] = colorMse_[0] = 0.0F;
-  colorPsnr_[0] = colorPsnr_[0] = colorPsnr_[0] = 0.0F;
+  colorMse_[0] = colorMse_[1] = colorMse_[2] = 0.0F;
+  colorPsnr_[0] = colorPsnr_[1] = colorPsnr_[2] = 0.0F;
 }
 
 void QualityMetrics::setParameters( const PCCMetricsParameters& params ) { params_ = params; }
 
-void QualityMetrics::compute( const PCCPointSet3& pointcloudA, const PCCPointSet3& pointcloudB ) {
+void QualityMetrics::compute( const PCCPointSet3& pointcloudA,
+                              const PCCPointSet3& pointcloudB,
+                              PCCKdTreeCache*     kdTreeCache ) {
   double maxC2c         = ( std::numeric_limits<double>::min )();
   double maxC2p         = ( std::numeric_limits<double>::min )();
   double sseC2p         = 0;
@@ -91,122 +117,153 @@ void QualityMetrics::compute( const PCCPointSet3& pointcloudA, const PCCPointSet
 
   psnr_ = params_.resolution_;
 
-  PCCKdTree    kdtree( pointcloudB );
-  PCCNNResult  result;
-  const size_t num_results_max  = 30;
-  const size_t num_results_incr = 5;
+  auto             kdtreePtr        = getKdTree( kdTreeCache, pointcloudB );
+  const PCCKdTree& kdtree           = *kdtreePtr;
+  const size_t     num_results_max  = 30;
+  const size_t     num_results_incr = 5;
+
+  // The errors of the points are computed concurrently and summed in the order of the points, so that the metrics
+  // do not depend on the number of threads.
+  const size_t        pointCount         = pointcloudA.getPointCount();
+  const bool          computeC2p         = params_.computeC2p_ && pointcloudB.hasNormals() && pointcloudA.hasNormals();
+  const bool          computeColor       = params_.computeColor_ && pointcloudA.hasColors() && pointcloudB.hasColors();
+  const bool          computeReflectance = params_.computeReflectance_ && pointcloudA.hasReflectances() &&
+                                          pointcloudB.hasReflectances();
+  std::vector<double> distProjC2c( params_.computeC2c_ ? pointCount : 0 );
+  std::vector<double> distProjC2p( params_.computeC2p_ ? pointCount : 0, 0.0 );
+  std::vector<double> distColor( params_.computeColor_ ? 3 * pointCount : 0, 0.0 );
+  std::vector<double> distReflectance( computeReflectance ? pointCount : 0 );
+
+  // the colors of the two point clouds are converted once, instead of for each of their searches
+  std::vector<float> yuvPointsA[3];
+  std::vector<float> yuvPointsB[3];
+  if ( computeColor ) {
+    convertRGBtoYUV_BT709( pointcloudA, yuvPointsA );
+    convertRGBtoYUV_BT709( pointcloudB, yuvPointsB );
+  }
 
   auto& normalsB = pointcloudB.getNormals();
-  for ( size_t indexA = 0; indexA < pointcloudA.getPointCount(); indexA++ ) {
-    // For point 'i' in A, find its nearest neighbor in B. store it in 'j'
-    size_t num_results = 0;
-    do {
-      num_results += num_results_incr;
-      kdtree.search( pointcloudA[indexA], num_results, result );
-    } while ( result.dist( 0 ) == result.dist( num_results - 1 ) && num_results + num_results_incr <= num_results_max );
-
-    // Compute point-to-point, which should be equal to sqrt( dist[0] )
-    double distProjC2c = result.dist( 0 );
-
-    // Build the list of all the points of same distances.
+  tbb::parallel_for( tbb::blocked_range<size_t>( 0, pointCount ), [&]( const tbb::blocked_range<size_t>& range ) {
+    PCCNNResult         result;
     std::vector<size_t> sameDistList;
-    if ( params_.computeColor_ || params_.computeC2p_ ) {
-      for ( size_t j = 0; j < num_results && ( fabs( result.dist( 0 ) - result.dist( j ) ) < 1e-8 ); j++ ) {
-        sameDistList.push_back( result.indices( j ) );
+    std::vector<float>  yuvA;
+    std::vector<float>  yuvB;
+    size_t              num_results_search = num_results_incr;
+    for ( size_t indexA = range.begin(); indexA < range.end(); indexA++ ) {
+      // For point 'i' in A, find its nearest neighbor in B. store it in 'j'. The number of results is the first
+      // multiple of num_results_incr whose last result is farther than the first one: the search is made with the
+      // count of the previous point and is only repeated with more results when it does not cover this count.
+      size_t num_results = 0;
+      kdtree.search( pointcloudA[indexA], num_results_search, result );
+      do {
+        num_results += num_results_incr;
+        if ( num_results > num_results_search ) {
+          num_results_search = num_results;
+          kdtree.search( pointcloudA[indexA], num_results_search, result );
+        }
+      } while ( result.dist( 0 ) == result.dist( num_results - 1 ) &&
+                num_results + num_results_incr <= num_results_max );
+      num_results_search = num_results;
+
+      // Compute point-to-point, which should be equal to sqrt( dist[0] )
+      if ( params_.computeC2c_ ) { distProjC2c[indexA] = result.dist( 0 ); }
+
+      // Build the list of all the points of same distances.
+      sameDistList.clear();
+      if ( params_.computeColor_ || params_.computeC2p_ ) {
+        for ( size_t j = 0; j < num_results && ( fabs( result.dist( 0 ) - result.dist( j ) ) < 1e-8 ); j++ ) {
+          sameDistList.push_back( result.indices( j ) );
+        }
       }
-    }
-    std::sort( sameDistList.begin(), sameDistList.end() );
-
-    // Compute point-to-plane, normals in B will be used for point-to-plane
-    double distProjC2p = 0.0;
-    if ( params_.computeC2p_ && pointcloudB.hasNormals() && pointcloudA.hasNormals() ) {
-      for ( auto& indexB : sameDistList ) {
-        std::vector<double> errVector( 3 );
-        for ( size_t j = 0; j < 3; j++ ) { errVector[j] = pointcloudA[indexA][j] - pointcloudB[indexB][j]; }
-        double dist = pow( errVector[0] * normalsB[indexB][0] + errVector[1] * normalsB[indexB][1] +
-                               errVector[2] * normalsB[indexB][2],
-                           2.F );
-        distProjC2p += dist;
+      std::sort( sameDistList.begin(), sameDistList.end() );
+
+      // Compute point-to-plane, normals in B will be used for point-to-plane
+      if ( computeC2p ) {
+        double distProj = 0.0;
+        for ( auto& indexB : sameDistList ) {
+          double errVector[3];
+          for ( size_t j = 0; j < 3; j++ ) { errVector[j] = pointcloudA[indexA][j] - pointcloudB[indexB][j]; }
+          double dist = pow( errVector[0] * normalsB[indexB][0] + errVector[1] * normalsB[indexB][1] +
+                                 errVector[2] * normalsB[indexB][2],
+                             2.F );
+          distProj += dist;
+        }
+        distProjC2p[indexA] = distProj / sameDistList.size();
       }
-      distProjC2p /= sameDistList.size();
-    }
 
-    size_t indexB = result.indices( 0 );
-    double distColor[3];
-    distColor[0] = distColor[1] = distColor[2] = 0.0;
-    if ( params_.computeColor_ && pointcloudA.hasColors() && pointcloudB.hasColors() ) {
-      std::vector<float> yuvA;
-      std::vector<float> yuvB;
-      PCCColor3B         rgb;
-      convertRGBtoYUV_BT709( pointcloudA.getColor( indexA ), yuvA );
-      if ( params_.neighborsProc_ != 0 ) {
-        switch ( params_.neighborsProc_ ) {
-          case 0: break;
-          case 1:  // Average
-          case 2:  // Weighted average
-          {
-            int          nbdupcumul = 0;
-            unsigned int r          = 0;
-            unsigned int g          = 0;
-            unsigned int b          = 0;
-            for ( unsigned long long i : sameDistList ) {
-              int nbdup = 1;  // pointcloudB.xyz.nbdup[ indices_sameDst[n] ];
-              r += nbdup * pointcloudB.getColor( i )[0];
-              g += nbdup * pointcloudB.getColor( i )[1];
-              b += nbdup * pointcloudB.getColor( i )[2];
-              nbdupcumul += nbdup;
-            }
-            rgb[0] = static_cast<unsigned char>( round( static_cast<double>( r ) / nbdupcumul ) );
-            rgb[1] = static_cast<unsigned char>( round( static_cast<double>( g ) / nbdupcumul ) );
-            rgb[2] = static_cast<unsigned char>( round( static_cast<double>( b ) / nbdupcumul ) );
-            convertRGBtoYUV_BT709( rgb, yuvB );
-            for ( size_t i = 0; i < 3; i++ ) { distColor[i] = pow( yuvA[i] - yuvB[i], 2.F ); }
-          } break;
-          case 3:  // Min
-          case 4:  // Max
-          {
-            float  distBest  = 0;
-            size_t indexBest = 0;
-            for ( auto index : sameDistList ) {
-              convertRGBtoYUV_BT709( pointcloudB.getColor( index ), yuvB );
-              float dist =
-                  pow( yuvA[0] - yuvB[0], 2.F ) + pow( yuvA[1] - yuvB[1], 2.F ) + pow( yuvA[2] - yuvB[2], 2.F );
-              if ( ( ( params_.neighborsProc_ == 3 ) && ( dist < distBest ) ) ||
-                   ( ( params_.neighborsProc_ == 4 ) && ( dist > distBest ) ) ) {
-                distBest  = dist;
-                indexBest = index;
+      size_t indexB = result.indices( 0 );
+      if ( computeColor ) {
+        PCCColor3B rgb;
+        getYUV( yuvPointsA, indexA, yuvA );
+        if ( params_.neighborsProc_ != 0 ) {
+          switch ( params_.neighborsProc_ ) {
+            case 0: break;
+            case 1:  // Average
+            case 2:  // Weighted average
+            {
+              int          nbdupcumul = 0;
+              unsigned int r          = 0;
+              unsigned int g          = 0;
+              unsigned int b          = 0;
+              for ( unsigned long long i : sameDistList ) {
+                int nbdup = 1;  // pointcloudB.xyz.nbdup[ indices_sameDst[n] ];
+                r += nbdup * pointcloudB.getColor( i )[0];
+                g += nbdup * pointcloudB.getColor( i )[1];
+                b += nbdup * pointcloudB.getColor( i )[2];
+                nbdupcumul += nbdup;
               }
-            }
-            convertRGBtoYUV_BT709( pointcloudB.getColor( indexBest ), yuvB );
-          } break;
+              rgb[0] = static_cast<unsigned char>( round( static_cast<double>( r ) / nbdupcumul ) );
+              rgb[1] = static_cast<unsigned char>( round( static_cast<double>( g ) / nbdupcumul ) );
+              rgb[2] = static_cast<unsigned char>( round( static_cast<double>( b ) / nbdupcumul ) );
+              convertRGBtoYUV_BT709( rgb, yuvB );
+            } break;
+            case 3:  // Min
+            case 4:  // Max
+            {
+              float  distBest  = 0;
+              size_t indexBest = 0;
+              for ( auto index : sameDistList ) {
+                getYUV( yuvPointsB, index, yuvB );
+                float dist =
+                    pow( yuvA[0] - yuvB[0], 2.F ) + pow( yuvA[1] - yuvB[1], 2.F ) + pow( yuvA[2] - yuvB[2], 2.F );
+                if ( ( ( params_.neighborsProc_ == 3 ) && ( dist < distBest ) ) ||
+                     ( ( params_.neighborsProc_ == 4 ) && ( dist > distBest ) ) ) {
+                  distBest  = dist;
+                  indexBest = index;
+                }
+              }
+              getYUV( yuvPointsB, indexBest, yuvB );
+            } break;
+          }
+        } else {
+          getYUV( yuvPointsB, indexB, yuvB );
         }
-      } else {
-        convertRGBtoYUV_BT709( pointcloudB.getColor( indexB ), yuvB );
+        for ( size_t i = 0; i < 3; i++ ) { distColor[3 * indexA + i] = pow( yuvA[i] - yuvB[i], 2.F ); }
       }
-      for ( size_t i = 0; i < 3; i++ ) { distColor[i] = pow( yuvA[i] - yuvB[i], 2.F ); }
-    }
 
-    double distReflectance = 0.0;
-    if ( params_.computeReflectance_ && pointcloudA.hasReflectances() && pointcloudB.hasReflectances() ) {
-      distReflectance = pow( pointcloudA.getReflectance( indexA ) - pointcloudB.getReflectance( indexB ), 2.F );
+      if ( computeReflectance ) {
+        distReflectance[indexA] =
+            pow( pointcloudA.getReflectance( indexA ) - pointcloudB.getReflectance( indexB ), 2.F );
+      }
     }
+  } );
+
+  for ( size_t indexA = 0; indexA < pointCount; indexA++ ) {
     num++;
 
     // mean square distance
     if ( params_.computeC2c_ ) {
-      sseC2c += distProjC2c;
-      if ( distProjC2c > maxC2c ) { maxC2c = distProjC2c; }
+      sseC2c += distProjC2c[indexA];
+      if ( distProjC2c[indexA] > maxC2c ) { maxC2c = distProjC2c[indexA]; }
     }
     if ( params_.computeC2p_ ) {
-      sseC2p += distProjC2p;
-      if ( distProjC2p > maxC2p ) { maxC2p = distProjC2p; }
+      sseC2p += distProjC2p[indexA];
+      if ( distProjC2p[indexA] > maxC2p ) { maxC2p = distProjC2p[indexA]; }
     }
     if ( params_.computeColor_ ) {
-      for ( size_t i = 0; i < 3; i++ ) { sseColor[i] += distColor[i]; }
-    }
-    if ( params_.computeReflectance_ && pointcloudA.hasReflectances() && pointcloudB.hasReflectances() ) {
-      sseReflectance += distReflectance;
+      for ( size_t i = 0; i < 3; i++ ) { sseColor[i] += distColor[3 * indexA + i]; }
     }
+    if ( computeReflectance ) { sseReflectance += distReflectance[indexA]; }
   }
 
   if ( params_.computeC2c_ ) {
@@ -292,7 +349,8 @@ PCCMetrics::PCCMetrics() :
     sourcePoints_( 0 ),
     sourceDuplicates_( 0 ),
     reconstructPoints_( 0 ),
-    reconstructDuplicates_( 0 ) {}
+    reconstructDuplicates_( 0 ),
+    kdTreeCache_( nullptr ) {}
 PCCMetrics::~PCCMetrics() = default;
 void PCCMetrics::setParameters( const PCCMetricsParameters& params ) { params_ = params; }
 
@@ -356,12 +414,17 @@ void PCCMetrics::compute( const PCCGroupOfFrames& sources,
       sourceDuplicates_.push_back( source.getPointCount() );
       reconstructDuplicates_.push_back( reconstruct.getPointCount() );
       compute( source, reconstruct, normals.getFrameCount() == 0 ? normalEmpty : normals[i] );
+    } else if ( normals.getFrameCount() == 0 ) {
+      // the point clouds are not modified: their kd-trees can be shared with the encoder
+      sourceDuplicates_.push_back( 0 );
+      reconstructDuplicates_.push_back( 0 );
+      computeQuality( sourceOrg, reconstructOrg, kdTreeCache_ );
     } else {
       source      = sourceOrg;
       reconstruct = reconstructOrg;
       sourceDuplicates_.push_back( 0 );
       reconstructDuplicates_.push_back( 0 );
-      compute( source, reconstruct, normals.getFrameCount() == 0 ? normalEmpty : normals[i] );
+      compute( source, reconstruct, normals[i] );
     }
   }
 }
@@ -371,12 +434,61 @@ void PCCMetrics::compute( PCCPointSet3& source, PCCPointSet3& reconstruct, const
     source.copyNormals( normalSource );
     reconstruct.scaleNormals( normalSource );
   }
-  QualityMetrics q1;
-  QualityMetrics q2;
+  computeQuality( source, reconstruct, nullptr );
+}
+
+void PCCMetrics::prepareSource( const PCCPointSet3& sourceOrg,
+                                const PCCPointSet3& normalSource,
+                                PCCPointSet3&       source ) {
+  if ( params_.dropDuplicates_ != 0 ) {
+    sourceOrg.removeDuplicate( source, params_.dropDuplicates_ );
+  } else {
+    source = sourceOrg;
+  }
+  if ( normalSource.getPointCount() > 0 ) { source.copyNormals( normalSource ); }
+  // the kd-trees are built before the evaluations so that concurrent evaluations do not build them again
+  if ( kdTreeCache_ != nullptr ) {
+    kdTreeCache_->get( source );
+    if ( normalSource.getPointCount() > 0 ) { kdTreeCache_->get( normalSource ); }
+  }
+}
+
+void PCCMetrics::compute( const PCCPointSet3& source,
+                          size_t              sourcePointCount,
+                          const PCCPointSet3& reconstructOrg,
+                          const PCCPointSet3& normalSource ) {
+  PCCPointSet3 reconstruct;
+  sourcePoints_.push_back( sourcePointCount );
+  reconstructPoints_.push_back( reconstructOrg.getPointCount() );
+  if ( params_.dropDuplicates_ != 0 ) {
+    reconstructOrg.removeDuplicate( reconstruct, params_.dropDuplicates_ );
+    sourceDuplicates_.push_back( source.getPointCount() );
+    reconstructDuplicates_.push_back( reconstruct.getPointCount() );
+  } else {
+    reconstruct = reconstructOrg;
+    sourceDuplicates_.push_back( 0 );
+    reconstructDuplicates_.push_back( 0 );
+  }
+  // the kd-tree of the reconstruction is shared by the scaling of the normals and the metrics, then released
+  if ( normalSource.getPointCount() > 0 ) { reconstruct.scaleNormals( normalSource, kdTreeCache_ ); }
+  computeQuality( source, reconstruct, kdTreeCache_ );
+  if ( kdTreeCache_ != nullptr ) { kdTreeCache_->release( reconstruct ); }
+}
+
+void PCCMetrics::computeQuality( const PCCPointSet3& source,
+                                 const PCCPointSet3& reconstruct,
+                                 PCCKdTreeCache*     kdTreeCache ) {
+  QualityMetrics  q1;
+  QualityMetrics  q2;
+  tbb::task_arena limited( params_.nbThread_ > 0 ? static_cast<int>( params_.nbThread_ )
+                                                 : static_cast<int>( tbb::task_arena::automatic ) );
   q1.setParameters( params_ );
-  q1.compute( source, reconstruct );
   q2.setParameters( params_ );
-  q2.compute( reconstruct, source );
+  // the two directions are computed concurrently and share the threads of the arena
+  limited.execute( [&] {
+    tbb::parallel_invoke( [&] { q1.compute( source, reconstruct, kdTreeCache ); },
+                          [&] { q2.compute( reconstruct, source, kdTreeCache ); } );
+  } );
   quality1.push_back( q1 );
   quality2.push_back( q2 );
   qualityF.push_back( q1 + q2 );
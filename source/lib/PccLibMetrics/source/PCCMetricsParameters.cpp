@@ -38,16 +38,19 @@ using namespace pcc;
 PCCMetricsParameters::PCCMetricsParameters() {
   computeMetrics_  = true;
   computeChecksum_ = true;
+  fastChecksum_    = false;
 
   startFrameNumber_  = 0;
   frameCount_        = 0;
   groupOfFramesSize_ = 32;
 
-  uncompressedDataFolder_ = {};
-  uncompressedDataPath_   = {};
-  reconstructedDataPath_  = {};
-  normalDataPath_         = {};
-  nbThread_               = 0;
+  uncompressedDataFolder_    = {};
+  uncompressedDataPath_      = {};
+  reconstructedDataPath_     = {};
+  normalDataPath_            = {};
+  reconstructedDataListPath_ = {};
+  resultPath_                = {};
+  nbThread_                  = 0;
 
   resolution_     = 1023;
   dropDuplicates_ = 2;
@@ -72,12 +75,15 @@ void PCCMetricsParameters::completePath() {
 void PCCMetricsParameters::print() {
   std::cout << "+ Parameters" << std::endl;
   std::cout << "\t   computeChecksum                      " << computeChecksum_ << std::endl;
+  std::cout << "\t   fastChecksum                         " << fastChecksum_ << std::endl;
   std::cout << "\t   computeMetrics                       " << computeMetrics_ << std::endl;
   std::cout << "\t   startFrameNumber                     " << startFrameNumber_ << std::endl;
   std::cout << "\t   frameCount                           " << frameCount_ << std::endl;
   std::cout << "\t   uncompressedDataPath                 " << uncompressedDataPath_ << std::endl;
   std::cout << "\t   reconstructedDataPath                " << reconstructedDataPath_ << std::endl;
   std::cout << "\t   normalDataPath                       " << normalDataPath_ << std::endl;
+  std::cout << "\t   reconstructedDataListPath            " << reconstructedDataListPath_ << std::endl;
+  std::cout << "\t   resultPath                           " << resultPath_ << std::endl;
   std::cout << "\t   nbThread                             " << nbThread_ << std::endl;
   std::cout << "\t   resolution                           " << resolution_ << std::endl;
   std::cout << "\t   dropDuplicates                       " << dropDuplicates_ << std::endl;
@@ -103,7 +109,7 @@ bool PCCMetricsParameters::check( bool checkFiles ) {
                      "metric. \n";
         computeMetrics_ = false;
       }
-      if ( reconstructedDataPath_.empty() ) {
+      if ( reconstructedDataPath_.empty() && reconstructedDataListPath_.empty() ) {
         std::cout << "reconstructedDataPath_ not set\n";
         std::cout << "WARNING: Reconstructed ply not correctly set: disable "
                      "compute metric. \n";
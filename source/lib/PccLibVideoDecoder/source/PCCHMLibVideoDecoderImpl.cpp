@@ -45,6 +45,9 @@
 using namespace pcc;
 using namespace pcc_hm;
 
+// The process-wide tables of HM (TComRom) are built once by the first TDecTop::init() and are not freed by
+// TDecTop::deletePicBuffer() (see dependencies/hm-modification): the decoder instances run concurrently.
+
 template <typename T>
 PCCHMLibVideoDecoderImpl<T>::PCCHMLibVideoDecoderImpl() : m_iPOCLastDisplay( -MAX_INT ) {
   m_pTDecTop = new pcc_hm::TDecTop();
@@ -36,8 +36,94 @@
 
 #ifdef USE_HMAPP_VIDEO_CODEC
 
+#ifndef _WIN32
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 using namespace pcc;
 
+#ifndef _WIN32
+// Named pipe used in place of an intermediate file of the HM application: the data are exchanged through the kernel
+// pipe buffer and never reach the disk. The peer side of the pipe runs in a thread of the current process. The pipe
+// has its own name, next to the intermediate file, so that the files kept by keepIntermediateFiles are not touched.
+class PCCNamedPipe {
+ public:
+  PCCNamedPipe( const std::string& fileName ) : name_( fileName + ".fifo" ), done_( false ) {
+    unlink( name_.c_str() );
+    created_ = mkfifo( name_.c_str(), 0600 ) == 0;
+    if ( !created_ ) { printf( "PCCNamedPipe can't create %s \n", name_.c_str() ); }
+  }
+  ~PCCNamedPipe() {
+    if ( thread_.joinable() ) { thread_.join(); }
+    unlink( name_.c_str() );
+  }
+  bool               created() const { return created_; }
+  const std::string& getName() const { return name_; }
+
+  // Runs the function that feeds or consumes the pipe in a thread. SIGPIPE is blocked in this thread so that a write
+  // to a pipe closed by the encoder fails instead of terminating the process.
+  template <typename F>
+  void start( F function ) {
+    thread_ = std::thread( [this, function] {
+      sigset_t set;
+      sigemptyset( &set );
+      sigaddset( &set, SIGPIPE );
+      pthread_sigmask( SIG_BLOCK, &set, nullptr );
+      function( name_ );
+      std::lock_guard<std::mutex> lock( mutex_ );
+      done_ = true;
+      condition_.notify_all();
+    } );
+  }
+
+  // Waits the end of the thread. If the encoder has exited without opening or fully using the pipe, the thread is
+  // released by the other side of the pipe opened here: a writer is drained until it closes the pipe, a reader gets
+  // the end of file. The thread may not have opened the pipe yet, so the waits are bounded and the state rechecked.
+  void finish( const bool writer ) {
+    const int timeout = 10;  // ms
+    while ( !waitDone( timeout ) ) {
+      int fd = open( name_.c_str(), ( writer ? O_RDONLY : O_WRONLY ) | O_NONBLOCK );
+      if ( fd < 0 ) { continue; }  // no reader opened yet
+      if ( writer ) {
+        char   buffer[65536];
+        pollfd pfd = {fd, POLLIN, 0};
+        while ( !isDone() && poll( &pfd, 1, timeout ) >= 0 ) {
+          if ( ( pfd.revents & POLLIN ) != 0 && read( fd, buffer, sizeof( buffer ) ) > 0 ) { continue; }
+          if ( ( pfd.revents & ( POLLHUP | POLLERR ) ) != 0 ) { break; }
+        }
+      }
+      close( fd );
+    }
+    thread_.join();
+  }
+
+ private:
+  bool isDone() {
+    std::lock_guard<std::mutex> lock( mutex_ );
+    return done_;
+  }
+  bool waitDone( const int timeout ) {
+    std::unique_lock<std::mutex> lock( mutex_ );
+    return condition_.wait_for( lock, std::chrono::milliseconds( timeout ), [this] { return done_; } );
+  }
+
+  std::string             name_;
+  bool                    created_;
+  bool                    done_;
+  std::mutex              mutex_;
+  std::condition_variable condition_;
+  std::thread             thread_;
+};
+#endif
+
 template <typename T>
 PCCHMAppVideoEncoder<T>::PCCHMAppVideoEncoder() {}
 template <typename T>
@@ -48,19 +134,35 @@ void PCCHMAppVideoEncoder<T>::encode( PCCVideo<T, 3>&            videoSrc,
                                       PCCVideoEncoderParameters& params,
                                       PCCVideoBitstream&         bitstream,
                                       PCCVideo<T, 3>&            videoRec ) {
-  const size_t      width      = videoSrc.getWidth();
-  const size_t      height     = videoSrc.getHeight();
-  const size_t      frameCount = videoSrc.getFrameCount();
+  const size_t width          = videoSrc.getWidth();
+  const size_t height         = videoSrc.getHeight();
+  const size_t frameCount     = videoSrc.getFrameCount();
+  std::string  srcYuvFileName = params.srcYuvFileName_;
+  std::string  recYuvFileName = params.recYuvFileName_;
+  std::string  binFileName    = params.binFileName_;
+#ifndef _WIN32
+  // The source video, the reconstructed video and the bitstream are exchanged with the encoder through named pipes:
+  // the encoder starts while the source frames are written and no intermediate file is stored.
+  PCCNamedPipe srcPipe( params.srcYuvFileName_ );
+  PCCNamedPipe recPipe( params.recYuvFileName_ );
+  PCCNamedPipe binPipe( params.binFileName_ );
+  const bool   usePipes = srcPipe.created() && recPipe.created() && binPipe.created();
+  if ( usePipes ) {
+    srcYuvFileName = srcPipe.getName();
+    recYuvFileName = recPipe.getName();
+    binFileName    = binPipe.getName();
+  }
+#endif
   std::stringstream cmd;
-  cmd << params.encoderPath_ << " -c " << params.encoderConfig_ << " --InputFile=" << params.srcYuvFileName_
+  cmd << params.encoderPath_ << " -c " << params.encoderConfig_ << " --InputFile=" << srcYuvFileName
       << " --InputBitDepth=" << params.inputBitDepth_
       << " --InputChromaFormat=" << ( params.use444CodecIo_ ? "444" : "420" )
       << " --OutputBitDepth=" << params.outputBitDepth_ << " --OutputBitDepthC=" << params.outputBitDepth_
       << " --FrameRate=30"
       << " --FrameSkip=0"
       << " --SourceWidth=" << width << " --SourceHeight=" << height << " --ConformanceWindowMode=1 "
-      << " --FramesToBeEncoded=" << frameCount << " --BitstreamFile=" << params.binFileName_
-      << " --ReconFile=" << params.recYuvFileName_ << " --QP=" << params.qp_;
+      << " --FramesToBeEncoded=" << frameCount << " --BitstreamFile=" << binFileName
+      << " --ReconFile=" << recYuvFileName << " --QP=" << params.qp_;
   if ( params.internalBitDepth_ != 0 ) {
     cmd << " --InternalBitDepth=" << params.internalBitDepth_ << " --InternalBitDepthC=" << params.internalBitDepth_;
   }
@@ -72,13 +174,34 @@ void PCCHMAppVideoEncoder<T>::encode( PCCVideo<T, 3>&            videoSrc,
   if ( params.use444CodecIo_ ) { cmd << " --InputColourSpaceConvert=RGBtoGBR"; }
   std::cout << cmd.str() << std::endl;
 
+  PCCCOLORFORMAT format = getColorFormat( params.recYuvFileName_ );
+  videoRec.clear();
+#ifndef _WIN32
+  if ( usePipes ) {
+    srcPipe.start( [&]( const std::string& name ) { videoSrc.write( name, params.inputBitDepth_ == 8 ? 1 : 2 ); } );
+    recPipe.start( [&]( const std::string& name ) {
+      videoRec.read( name, width, height, format, frameCount, params.outputBitDepth_ == 8 ? 1 : 2 );
+    } );
+    binPipe.start( [&]( const std::string& name ) {
+      std::ifstream file( name, std::ios::binary );
+      bitstream.vector().assign( std::istreambuf_iterator<char>( file ), std::istreambuf_iterator<char>() );
+    } );
+    int ret = pcc::system( cmd.str().c_str() );
+    srcPipe.finish( true );
+    recPipe.finish( false );
+    binPipe.finish( false );
+    if ( ret ) {
+      std::cout << "Error: can't run system command!" << std::endl;
+      exit( -1 );
+    }
+    return;
+  }
+#endif
   videoSrc.write( params.srcYuvFileName_, params.inputBitDepth_ == 8 ? 1 : 2 );
   if ( pcc::system( cmd.str().c_str() ) ) {
     std::cout << "Error: can't run system command!" << std::endl;
     exit( -1 );
   }
-  PCCCOLORFORMAT format = getColorFormat( params.recYuvFileName_ );
-  videoRec.clear();
   videoRec.read( params.recYuvFileName_, width, height, format, frameCount, params.outputBitDepth_ == 8 ? 1 : 2 );
   bitstream.read( params.binFileName_ );
 }
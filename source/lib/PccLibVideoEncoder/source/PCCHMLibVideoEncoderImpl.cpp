@@ -91,6 +91,7 @@ Void PCCHMLibVideoEncoderImpl<T>::encode( PCCVideo<T, 3>&    videoSrc,
   m_cTEncTop.create();
   m_cTEncTop.init( m_isField );
   videoRec.clear();
+  videoRec.reserve( m_framesToBeEncoded );
 
 #if PCC_ME_EXT
   if ( m_usePCCExt ) {
@@ -807,7 +808,7 @@ template <typename T>
 
 template <typename T>
 Void PCCHMLibVideoEncoderImpl<T>::xWritePicture( const TComPicYuv* pic, PCCVideo<T, 3>& video ) {
-  video.resize( video.getFrameCount() + 1 );
+  video.getFrames().emplace_back();
   auto&          image           = video.getFrames().back();
   int            chromaSubsample = pic->getWidth( COMPONENT_Y ) / pic->getWidth( COMPONENT_Cb );
   int            width           = m_iSourceWidth - m_confWinLeft - m_confWinRight;